@@ -0,0 +1,213 @@
+/**
+ * Benchmarks of the RGF kernels on synthetic block-tridiagonal Hamiltonians.
+ *
+ * Usage: bench_negf [--sizes 2x10000,10x1000,...] [--ne 4] [--seed 1]
+ *                   [--out benchmarks.json]
+ *
+ * Each size is <block size>x<number of device blocks>. Every size is run
+ * with orthogonal and non-orthogonal basis. For each observable it reports
+ * the time per block per energy point and a nominal GFLOP/s. The memory
+ * high-water mark is that of the whole process, so it is reported once at
+ * the end.
+ */
+
+#include "negf/CohRgfa.h"
+
+#include <sys/resource.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace quest::negf;
+using namespace std;
+
+/*
+ * Nominal number of n x n complex block operations (multiplication or
+ * inversion, 8*n^3 flops each) per device block of each observable.
+ */
+struct Observable{
+    string name;
+    double blockOps;
+};
+
+static const Observable observables[] = {
+    {"TE", 4}, {"DOS", 9}, {"n", 11}, {"I", 4}
+};
+
+struct Size{
+    uint no;    // orbitals per block
+    uint N;     // device blocks
+};
+
+static vector<Size> parseSizes(const string &arg){
+    vector<Size> sizes;
+    stringstream ss(arg);
+    string item;
+    while (getline(ss, item, ',')){
+        size_t x = item.find('x');
+        if (x == string::npos){
+            throw invalid_argument("bench_negf: sizes must look like 10x1000.");
+        }
+        Size s = {(uint)atoi(item.substr(0, x).c_str()), (uint)atoi(item.substr(x+1).c_str())};
+        sizes.push_back(s);
+    }
+    return sizes;
+}
+
+// memory high-water mark of the process in MB
+static double maxRssMB(){
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss/1024.0;
+}
+
+/*
+ * Synthetic device: a chain of identical blocks. Inside a block the
+ * orbitals form a chain with random on-site energies and hoppings;
+ * neighboring blocks are coupled orbital by orbital.
+ */
+static void buildDevice(CohRgfa &rgf, uint no, uint nb, bool orthogonal){
+    double t = 1.0;
+
+    vec onsite = arma::randu<vec>(no) - 0.5;
+    vec hopping = -t*(1 + 0.1*arma::randu<vec>(no));
+
+    shared_ptr<cxmat> H0 = make_shared<cxmat>(no, no, fill::zeros);
+    H0->diag() = conv_to<cxvec>::from(onsite);
+    for (uint io = 0; io+1 < no; ++io){
+        (*H0)(io, io+1) = hopping(io);
+        (*H0)(io+1, io) = conj((*H0)(io, io+1));
+    }
+    shared_ptr<cxmat> Hl = make_shared<cxmat>(no, no, fill::zeros);
+    Hl->diag().fill(-t);
+
+    shared_ptr<cxmat> S0 = make_shared<cxmat>(no, no, fill::eye);
+    shared_ptr<cxmat> Sl = make_shared<cxmat>(no, no, fill::zeros);
+    if (!orthogonal){
+        for (uint io = 0; io+1 < no; ++io){
+            (*S0)(io, io+1) = 0.1;
+            (*S0)(io+1, io) = 0.1;
+        }
+        Sl->diag().fill(0.05);
+    }
+
+    field<shared_ptr<cxmat> > H0s(nb), S0s(nb), Hls(nb+1), Sls(nb+1);
+    field<shared_ptr<vec> > V(nb);
+    shared_ptr<vec> V0 = make_shared<vec>(no, fill::zeros);
+    for (uint ib = 0; ib < nb; ++ib){
+        H0s(ib) = H0;
+        S0s(ib) = S0;
+        V(ib) = V0;
+    }
+    for (uint ib = 0; ib <= nb; ++ib){
+        Hls(ib) = Hl;
+        Sls(ib) = Sl;
+    }
+
+    rgf.H(H0s, Hls);
+    rgf.S(S0s, Sls);
+    rgf.V(V);
+}
+
+int main(int argc, char** argv){
+    vector<Size> sizes = parseSizes("2x10000,10x1000,50x200,200x50,1000x10");
+    uint nE = 4;
+    int seed = 1;
+    string outFileName = "benchmarks.json";
+
+    for (int ia = 1; ia < argc; ++ia){
+        string arg = argv[ia];
+        if (arg == "--sizes" && ia+1 < argc){
+            sizes = parseSizes(argv[++ia]);
+        }else if (arg == "--ne" && ia+1 < argc){
+            nE = atoi(argv[++ia]);
+        }else if (arg == "--seed" && ia+1 < argc){
+            seed = atoi(argv[++ia]);
+        }else if (arg == "--out" && ia+1 < argc){
+            outFileName = argv[++ia];
+        }else{
+            cerr << "Usage: bench_negf [--sizes 2x10000,...] [--ne 4] [--seed 1] [--out file.json]" << endl;
+            return 1;
+        }
+    }
+
+    vec E = arma::linspace<vec>(-0.5, 0.5, nE);
+    wall_clock clock;
+
+    stringstream json;
+    json << "{" << endl;
+    json << "  \"benchmark\": \"negf\"," << endl;
+    json << "  \"energies\": " << nE << "," << endl;
+    json << "  \"seed\": " << seed << "," << endl;
+    json << "  \"flop_model\": \"8*no^3 flops per block operation\"," << endl;
+    json << "  \"results\": [";
+
+    bool first = true;
+    for (uint is = 0; is < sizes.size(); ++is){
+        for (int io = 0; io < 2; ++io){
+            bool orthogonal = (io == 0);
+            uint no = sizes[is].no;
+            uint N = sizes[is].N;
+
+            arma::arma_rng::set_seed(seed);
+            CohRgfa rgf(N+2, 0.0259, dcmplx(0, 1E-3), orthogonal);
+            buildDevice(rgf, no, N+2, orthogonal);
+
+            for (uint ir = 0; ir < sizeof(observables)/sizeof(Observable); ++ir){
+                const Observable &obs = observables[ir];
+                double time = 0;
+                for (uint iE = 0; iE < nE; ++iE){
+                    rgf.E(E(iE));
+                    clock.tic();
+                    if (obs.name == "TE"){
+                        rgf.TEop();
+                    }else if (obs.name == "DOS"){
+                        rgf.DOSop();
+                    }else if (obs.name == "n"){
+                        rgf.nOp();
+                    }else{
+                        rgf.Iop(1, 0, 1); // left contact to block 1
+                    }
+                    time += clock.toc();
+                }
+
+                double nsPerBlock = time/(nE*N)*1E9;
+                double flops = obs.blockOps*8.0*no*no*no*N*nE;
+                double gflops = flops/time/1E9;
+
+                cout << setw(6) << no << "x" << setw(6) << left << N << right
+                     << (orthogonal ? "  orth " : "  north") << setw(5) << obs.name
+                     << setw(14) << fixed << setprecision(1) << nsPerBlock << " ns/block"
+                     << setw(10) << setprecision(2) << gflops << " GFLOP/s" << endl;
+
+                json << (first ? "" : ",") << endl;
+                json << "    {\"block_size\": " << no << ", \"blocks\": " << N
+                     << ", \"orthogonal\": " << (orthogonal ? "true" : "false")
+                     << ", \"observable\": \"" << obs.name << "\""
+                     << ", \"time_s\": " << setprecision(6) << time
+                     << ", \"ns_per_block\": " << setprecision(1) << nsPerBlock
+                     << ", \"gflops\": " << setprecision(3) << gflops << "}";
+                first = false;
+            }
+        }
+    }
+    json << endl << "  ]," << endl;
+    json << "  \"max_rss_mb\": " << fixed << setprecision(1) << maxRssMB() << endl;
+    json << "}" << endl;
+    cout << "Peak memory of all the cases: " << fixed << setprecision(1) 
+         << maxRssMB() << " MB" << endl;
+
+    ofstream out(outFileName.c_str());
+    if (!out.is_open()){
+        cerr << "bench_negf: failed to open " << outFileName << "." << endl;
+        return 1;
+    }
+    out << json.str();
+
+    return 0;
+}
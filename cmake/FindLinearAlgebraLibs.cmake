@@ -63,9 +63,10 @@ if (ARPACK_FOUND)
 endif ()
 
 include (FindSuperLU5)
-if (SUPERLU_FOUND)
+if (SuperLU_FOUND)
     set (QUEST_SUPERLU_FOUND true)
-    set (QUEST_SUPERLU_LIBRARIES ${SUPERLU_LIBRARY})
+    set (QUEST_SUPERLU_LIBRARIES ${SuperLU_LIBRARY})
+    set (QUEST_SUPERLU_INCLUDE_DIRS ${SuperLU_INCLUDE_DIR})
 endif ()
 
 
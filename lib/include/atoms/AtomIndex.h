@@ -0,0 +1,57 @@
+/*
+ * File:   AtomIndex.h
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 20, 2026, 12:40 AM
+ *
+ * Description: R-tree of the atoms of a structure for region and neighbor
+ * queries.
+ *
+ */
+
+#ifndef ATOMINDEX_H
+#define	ATOMINDEX_H
+
+#include "atoms/AtomicStructView.h"
+#include "maths/geometry.hpp"
+
+namespace quest{
+namespace atoms{
+
+using maths::geometry::polygon;
+
+/**
+ * R-tree of the atom positions, bulk loaded once. Every query returns the 
+ * indices of the atoms found, in ascending order, and costs O(log N + k) 
+ * for k atoms found.
+ */
+class AtomIndex{
+public:
+    typedef boost::geometry::model::point<double, 3, 
+                boost::geometry::cs::cartesian> point3;
+    typedef boost::geometry::model::box<point3> box3;
+    typedef std::pair<point3, uint> entry;
+    
+    AtomIndex(const AtomicStructView &atoms);
+    
+    //!< Atoms inside the box [lo, hi], boundary included.
+    ucol inBox(const double lo[3], const double hi[3]) const;
+    //!< Atoms whose (x, y) is inside polygon p, at any z.
+    ucol inPolygon(const polygon &p) const;
+    //!< Atoms within distance r of c.
+    ucol inSphere(const double c[3], double r) const;
+    //!< The k atoms closest to c, ordered by index.
+    ucol nearest(const double c[3], uint k) const;
+    
+    uint size() const { return mtree.size(); };
+    
+protected:
+    boost::geometry::index::rtree<entry, 
+                boost::geometry::index::rstar<16> > mtree;
+};
+
+}
+}
+
+#endif	/* ATOMINDEX_H */
+
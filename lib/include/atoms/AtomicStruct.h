@@ -177,6 +177,8 @@ struct PeriodicTable{
 
 typedef PeriodicTable ptable;
 
+class AtomIndex;
+
 /** 
  * All atoms in the structure.
  */
@@ -195,6 +197,7 @@ protected:
     icol mia;           //!< Atomic numbers for all atoms in the collection
     mat  mXyz;          //!< Atomic coordinates
     lvec mlv;           //!< Lattice vector
+    mutable shared_ptr<AtomIndex> msindex; //!< Spatial index, built on first query.
 
 // Methods    
 public:
@@ -234,18 +237,26 @@ public:
     friend AtomicStruct operator+ (AtomicStruct atm, const lcoord& latticeCoord);     // atm2 = atm1 + lc;
     friend AtomicStruct operator+ (AtomicStruct atm, const svec& positionVect);       // atm2 = atm1 + r;
     friend AtomicStruct operator+ (AtomicStruct atmi, const AtomicStruct& atmj);             // concatanation
+    friend AtomicStruct concat(const vector<AtomicStruct> &parts);                            // concatanation of many
 
     // utilities
     //!< Import atoms from Gaussview file.
     void importGjf(const string &gjfFileName);
     //!< Export atoms to Gaussview file.
     void exportGjf(const string &gjfFileName);
+    //!< Import atoms from a binary geometry file, see GeomFile.
+    void importGeom(const string &geomFileName);
+    //!< Export atoms to a binary geometry file.
+    void exportGeom(const string &geomFileName) const;
     //!< Generate atoms in a rectangular lattice.
     void genRectLattAtoms(uint nl, uint nw, double ax, double ay, 
                     const ptable& periodicTable);
     void genSimpleCubicStruct(const Atom &atom, double a, uint nl, uint nw = 1, uint nh = 1);
     //!< Generates simple cubic structures.
     void genSimpleCubicStruct(const Atom &atom, double a, double l, double w = 0, double h = 0);
+    //!< Supercell of n1 x n2 x n3 copies of this structure shifted by the 
+    //!< lattice vectors, the copies ordered along a1, then a2, then a3.
+    AtomicStruct replicate(uint n1, uint n2 = 1, uint n3 = 1) const;
     //!< Generates Atomistic GNR 
     void genGNR(const Atom &atom, double acc, uint nl, uint nw, uint nh = 0);
     void genGNR(const Atom &atom, double acc, double l, double w, double h = 0);
@@ -255,6 +266,8 @@ public:
     // access functions
     Atom        AtomAt(uint i) const;       // Get one atom at i
     string      Symbol(uint i) const { return mpt[mia(i)].sym; } ;
+    int         AtomicNumber(uint i) const { return mia(i); };
+    int         NumOfOrbitalsAt(uint i) const { return mpt[mia(i)].no; };
     double      X(uint i) const { return mXyz(i, coord::X); };
     double      Y(uint i) const { return mXyz(i, coord::Y); };
     double      Z(uint i) const { return mXyz(i, coord::Z); };
@@ -267,6 +280,7 @@ public:
     int         NumOfElectrons() const { return mNe; };
     lvec        LatticeVector() const { return mlv; };
     void        LatticeVector(const lvec& a) { this->mlv = a; };
+    const ptable& PeriodicTable() const { return mpt; };
     void        PeriodicTable(const ptable &periodicTable);
     double      xmin() {return min(mXyz.col(coord::X)); };
     double      xmax() {return max(mXyz.col(coord::X)); };
@@ -279,7 +293,18 @@ public:
     double      zl(){ return abs(zmax() - zmin()); };
     
     AtomicStruct span(uint start, uint end) const;
+    
+    // spatial queries, the indices of the atoms found in ascending order.
+    //!< R-tree of the atoms. Built on first use and rebuilt after the 
+    //!< atoms are changed. Building it is not thread safe.
+    const AtomIndex& spatialIndex() const;
+    ucol        inBox(const svec &lo, const svec &hi) const;  //!< Atoms in the box [lo, hi].
+    ucol        inPolygon(const mat &xy) const;   //!< Atoms inside the polygon with vertices xy (n x 2).
+    ucol        inSphere(const svec &c, double r) const;  //!< Atoms within r of c.
+    ucol        nearest(const svec &c, uint k) const;     //!< The k atoms nearest to c.
 
+    friend class AtomicStructView;
+    friend class Supercell;
 
 protected:
     void        init();
@@ -299,6 +324,7 @@ protected:
         ar & mia;
         ar & mXyz;
         ar & mlv;
+        msindex.reset();
     }
     
 };
@@ -0,0 +1,139 @@
+/*
+ * File:   AtomicStructView.h
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 11:50 PM
+ *
+ * Description: Non-owning view of a subset of the atoms of an AtomicStruct.
+ *
+ */
+
+#ifndef ATOMICSTRUCTVIEW_H
+#define	ATOMICSTRUCTVIEW_H
+
+#include "atoms/AtomicStruct.h"
+
+namespace quest{
+namespace atoms{
+
+/**
+ * A contiguous range or an index list of the atoms of an AtomicStruct. The
+ * view reads the coordinate columns and the atomic numbers of the parent
+ * in place, so creating and slicing a view is O(1) and copies nothing. The
+ * parent, and the index list if any, must outlive the view and must not be
+ * modified while the view is in use.
+ */
+class AtomicStructView{
+public:
+    //!< All the atoms of s. Explicit, so that a view of a temporary is not
+    //!< created by accident.
+    explicit AtomicStructView(const AtomicStruct &s): mstart(0), mna(s.mNa), 
+            mindex(nullptr)
+    {
+        init(s);
+    }
+    //!< Atoms sp of s.
+    AtomicStructView(const AtomicStruct &s, maths::armadillo::span sp):
+            mstart(sp.whole ? 0 : sp.a),
+            mna(sp.whole ? s.mNa : sp.b - sp.a + 1), mindex(nullptr)
+    {
+        init(s);
+    }
+    //!< Atoms index of s. The view keeps a pointer to index.
+    AtomicStructView(const AtomicStruct &s, const ucol &index): mstart(0), 
+            mna(index.n_elem), mindex(index.memptr())
+    {
+        init(s);
+    }
+    //!< na atoms stored elsewhere as SoA arrays, e.g., a mapped file.
+    AtomicStructView(uint na, const double *x, const double *y, 
+            const double *z, const int *id, const ptable &pt, const lvec &lv):
+            mstart(0), mna(na), mindex(nullptr), mid(id), mpt(&pt), mlv(&lv)
+    {
+        mr[coord::X] = x;
+        mr[coord::Y] = y;
+        mr[coord::Z] = z;
+    }
+
+    //!< Atoms sp of this view, O(1).
+    AtomicStructView operator()(maths::armadillo::span sp) const {
+        AtomicStructView v(*this);
+        if (!sp.whole){
+            if (mindex){
+                v.mindex = mindex + sp.a;
+            }else{
+                v.mstart = mstart + sp.a;
+            }
+            v.mna = sp.b - sp.a + 1;
+        }
+        return v;
+    }
+    //!< Atom i of this view, O(1).
+    AtomicStructView operator()(uint i) const {
+        return (*this)(maths::armadillo::span(i, i));
+    }
+
+    //!< Index of atom i in the parent structure.
+    uint    index(uint i) const { return mindex ? mindex[i] : mstart + i; };
+    double  R(uint i, uint ic) const { return mr[ic][index(i)]; };
+    double  X(uint i) const { return mr[coord::X][index(i)]; };
+    double  Y(uint i) const { return mr[coord::Y][index(i)]; };
+    double  Z(uint i) const { return mr[coord::Z][index(i)]; };
+    int     AtomicNumber(uint i) const { return mid[index(i)]; };
+    int     NumOfOrbitalsAt(uint i) const {
+        ptable::cpiter it = mpt->elements.find(AtomicNumber(i));
+        if (it == mpt->elements.end()){
+            throw invalid_argument("In AtomicStructView::NumOfOrbitalsAt(): atom " 
+                    + utils::strings::itos(i) + " is not in the periodic table.");
+        }
+        return it->second.no;
+    };
+    int     NumOfAtoms() const { return mna; };
+    //!< O(n), the orbitals are counted atom by atom.
+    int     NumOfOrbitals() const {
+        int no = 0;
+        for (uint ia = 0; ia < mna; ++ia){
+            no += NumOfOrbitalsAt(ia);
+        }
+        return no;
+    };
+    const ptable& PeriodicTable() const { return *mpt; };
+
+    //!< Copies the atoms of the view to a new structure.
+    AtomicStruct toStruct() const {
+        icol id(mna);
+        mat xyz(mna, 3);
+        for (uint ia = 0; ia < mna; ++ia){
+            id(ia) = AtomicNumber(ia);
+            for (uint ic = 0; ic < 3; ++ic){
+                xyz(ia, ic) = R(ia, ic);
+            }
+        }
+        return AtomicStruct(id, xyz, *mlv, *mpt);
+    }
+
+protected:
+    void init(const AtomicStruct &s){
+        for (uint ic = 0; ic < 3; ++ic){
+            mr[ic] = s.mXyz.colptr(ic);
+        }
+        mid = s.mia.memptr();
+        mpt = &s.mpt;
+        mlv = &s.mlv;
+    }
+
+protected:
+    uint                mstart; //!< First atom of a contiguous view.
+    uint                mna;    //!< Number of atoms in the view.
+    const uint         *mindex; //!< Atoms of an indexed view, nullptr if contiguous.
+    const double       *mr[3];  //!< Coordinate columns of the parent.
+    const int          *mid;    //!< Atomic numbers of the parent.
+    const ptable       *mpt;    //!< Periodic table of the parent.
+    const lvec         *mlv;    //!< Lattice vector of the parent.
+};
+
+}
+}
+
+#endif	/* ATOMICSTRUCTVIEW_H */
+
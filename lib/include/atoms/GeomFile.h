@@ -0,0 +1,65 @@
+/*
+ * File:   GeomFile.h
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 20, 2026, 12:10 AM
+ *
+ * Description: Binary geometry file, memory mapped for reading.
+ *
+ */
+
+#ifndef GEOMFILE_H
+#define	GEOMFILE_H
+
+#include "atoms/AtomicStructView.h"
+
+namespace quest{
+namespace atoms{
+
+/**
+ * Read-only, memory mapped binary geometry file:
+ *   header:       "QGEOM001", number of atoms, number of species, 
+ *                 lattice vectors a1, a2 and a3;
+ *   species:      atomic number, electrons, orbitals and symbol of each 
+ *                 element of the periodic table;
+ *   atomic numbers of all the atoms (int32, padded to 8 bytes);
+ *   coordinates:  x of all the atoms, then y, then z (float64).
+ * The coordinates are used in place, so all the ranks of a node that open 
+ * the same file share one copy of it in the page cache. 
+ */
+class GeomFile{
+public:
+    GeomFile(const string &fileName);
+    
+    int             NumOfAtoms() const { return mna; };
+    const ptable&   PeriodicTable() const { return mpt; };
+    const lvec&     LatticeVector() const { return mlv; };
+    //!< View of all the atoms, valid as long as this file is.
+    AtomicStructView view() const { 
+        return AtomicStructView(mna, mr[0], mr[1], mr[2], mid, mpt, mlv); 
+    };
+    //!< Copies the atoms to a new structure.
+    AtomicStruct    toStruct() const { return view().toStruct(); };
+    
+    //!< Writes s to fileName.
+    static void     write(const string &fileName, const AtomicStruct &s);
+    
+protected:
+    shared_ptr<const char>  mfile;  //!< The mapped file.
+    uint                    mna;
+    ptable                  mpt;
+    lvec                    mlv;
+    const int              *mid;
+    const double           *mr[3];
+};
+
+//!< Converts a GaussView GJF file to a binary geometry file.
+void gjfToGeom(const string &gjfFileName, const string &geomFileName);
+//!< Converts a binary geometry file to a GaussView GJF file.
+void geomToGjf(const string &geomFileName, const string &gjfFileName);
+
+}
+}
+
+#endif	/* GEOMFILE_H */
+
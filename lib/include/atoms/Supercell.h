@@ -0,0 +1,63 @@
+/*
+ * File:   Supercell.h
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 11:55 PM
+ *
+ * Description: Lazily replicated supercell of an atomic structure.
+ *
+ */
+
+#ifndef SUPERCELL_H
+#define	SUPERCELL_H
+
+#include "atoms/AtomicStruct.h"
+
+namespace quest{
+namespace atoms{
+
+/**
+ * n1 x n2 x n3 copies of a basis structure shifted by its lattice vectors,
+ * with the atoms in the same order as AtomicStruct::replicate(). Only the
+ * basis is stored; the coordinates of an atom are calculated when asked
+ * for, so a supercell of any size is created in O(1). The accessors are
+ * the same as the ones of AtomicStructView. toStruct() creates the whole
+ * structure with a single allocation.
+ */
+class Supercell{
+public:
+    Supercell(const AtomicStruct &basis, uint n1, uint n2 = 1, uint n3 = 1);
+
+    double  R(uint i, uint ic) const {
+        uint ib = i % mnb, c = i / mnb;
+        uint i3 = c % mn3, i2 = (c / mn3) % mn2, i1 = c / (mn3*mn2);
+        return mbasis.mXyz(ib, ic) + (i1*ma[0][ic] + i2*ma[1][ic] + i3*ma[2][ic]);
+    };
+    double  X(uint i) const { return R(i, coord::X); };
+    double  Y(uint i) const { return R(i, coord::Y); };
+    double  Z(uint i) const { return R(i, coord::Z); };
+    int     AtomicNumber(uint i) const { return mbasis.AtomicNumber(i % mnb); };
+    int     NumOfOrbitalsAt(uint i) const { return mbasis.NumOfOrbitalsAt(i % mnb); };
+    long    NumOfAtoms() const { return (long)mnb*mn1*mn2*mn3; };
+    long    NumOfOrbitals() const { return (long)mbasis.NumOfOrbitals()*mn1*mn2*mn3; };
+    const ptable& PeriodicTable() const { return mbasis.PeriodicTable(); };
+    //!< Lattice vectors of the whole supercell.
+    lvec    LatticeVector() const;
+    const AtomicStruct& basis() const { return mbasis; };
+
+    //!< Creates the whole structure, the copies of the basis are filled in
+    //!< on nthreads threads, 0: all.
+    AtomicStruct toStruct(uint nthreads = 1) const;
+
+protected:
+    AtomicStruct    mbasis;
+    uint            mn1, mn2, mn3;
+    uint            mnb;        //!< Number of atoms in the basis.
+    double          ma[3][3];   //!< Lattice vectors of the basis.
+};
+
+}
+}
+
+#endif	/* SUPERCELL_H */
+
@@ -125,6 +125,14 @@ public:
         Cache<Mat<T> >(begin, end, cacheEnabled){
     };
     
+    // forgets element it.
+    void forget(int it){
+        if (this->mCacheEnabled == true){
+            this->getAt(it).reset();
+        }else{
+            this->reset();
+        }
+    };
     
 protected:
     bool isStored(int it){
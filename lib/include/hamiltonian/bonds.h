@@ -0,0 +1,53 @@
+/*
+ * File:   bonds.h
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 9:40 PM
+ *
+ * Description: Hamiltonian between two atomic blocks kept as a bond list.
+ *
+ */
+
+#ifndef BONDS_H
+#define	BONDS_H
+
+#include "hamiltonian/hamiltonian.hpp"
+
+namespace quest{
+namespace hamiltonian{
+
+/**
+ * Hamiltonian and overlap matrices between two atomic blocks kept as a list
+ * of the non-zero elements with the end points of their bonds. The 
+ * neighbors are searched only once; a new magnetic field only changes the 
+ * Peierls phases, which are calculated for all the bonds at once.
+ */
+class BondHam{
+public:
+    BondHam(const cxhamparams &p, const AtomicStructView &bi, 
+            const AtomicStructView &bj);
+    
+    void         Bz(double Bz, int gauge = coord::X); //!< Updates the Peierls phases.
+    double       Bz() const { return mBz; };
+    int          BzGauge() const { return mBzGauge; };
+    
+    const cxmat& H() const { return mH; };
+    const cxmat& S() const { return mS; };
+    uword        nnz() const { return mIdx.n_elem; }; //!< Number of non-zero elements of H.
+    
+protected:
+    uwcol        mIdx;      //!< Linear indices of the non-zero elements of H.
+    cxvec        mH0;       //!< Non-zero elements of H at Bz = 0.
+    vec          mxi, myi;  //!< Start point of the bond of each element.
+    vec          mxj, myj;  //!< End point of the bond of each element.
+    bool         mpeierls;  //!< Do the hoppings carry the Peierls phase?
+    double       mBz;
+    int          mBzGauge;
+    cxmat        mH;
+    cxmat        mS;
+};
+
+}
+}
+#endif	/* BONDS_H */
+
@@ -0,0 +1,53 @@
+/*
+ * File:   hamcache.h
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 11:15 PM
+ *
+ * Description: On-disk cache of generated Hamiltonian blocks.
+ *
+ */
+
+#ifndef HAMCACHE_H
+#define	HAMCACHE_H
+
+#include "hamiltonian/hamiltonian.hpp"
+
+namespace quest{
+namespace hamiltonian{
+
+/**
+ * Content addressed cache of the Hamiltonian and overlap matrices of a list
+ * of pairs of atomic blocks. The key is a hash of the coordinates, species,
+ * orbitals and lattice vectors of all the blocks and of the fingerprint of 
+ * the Hamiltonian parameters, so any change of the geometry or of the 
+ * parameters (including Bz and its gauge) gives a new key. Each key is one
+ * file, <dir>/<key>.hcache:
+ *   header: "QHCACHE1", number of pairs, key;
+ *   sizes:  rows and columns of H and S of each pair;
+ *   data:   H and S of each pair, column major,
+ * which is memory mapped when loaded.
+ */
+class HamCache{
+public:
+    HamCache(const string &dir = ".");
+    
+    //!< Key of the pairs of blocks (bi[ib], bj[ib]) generated with p.
+    string  key(const cxhamparams &p, const vector<AtomicStruct> &bi, 
+                const vector<AtomicStruct> &bj) const;
+    string  fileName(const string &key) const;
+    
+    //!< Loads the blocks of key. Returns false if they are not in the cache.
+    bool    load(const string &key, vector<cxmat> &H, vector<cxmat> &S) const;
+    //!< Saves the blocks of key.
+    void    save(const string &key, const vector<cxmat> &H, 
+                const vector<cxmat> &S) const;
+    
+protected:
+    string  mdir;   //!< Cache directory.
+};
+
+}
+}
+#endif	/* HAMCACHE_H */
+
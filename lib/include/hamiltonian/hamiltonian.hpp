@@ -17,9 +17,15 @@
 #include "maths/constants.h"
 #include "maths/arma.hpp"
 #include "atoms/AtomicStruct.h"
+#include "atoms/AtomicStructView.h"
 #include "utils/vout.h"
 #include "utils/std.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <typeinfo>
+#include <unordered_map>
+
 namespace quest{
 namespace hamiltonian{
 
@@ -27,17 +33,27 @@ using namespace utils::stds;
 using utils::Printable;
 using namespace maths::armadillo;
 using atoms::AtomicStruct;
+using atoms::AtomicStructView;
 using atoms::PeriodicTable;
 using namespace maths::spvec;
 using namespace maths::constants;
 using utils::stds::static_pointer_cast;
 
+//!< Pre-factor of the Peierls phase, q/hbar/2 with the lengths in angstrom.
+const double PeierlsFactor = 1E-20*q/hbar/2;
+
+
+//!< Atomic numbers of the species the built-in models are defined for.
+const int DiscreteID = 0;   //!< "D", a point of a discretized k.p lattice.
+const int CarbonID = 6;     //!< "C"
 
 template<class T>
 class HamParams: public Printable{    
 public:    
+    typedef typename T::elem_type elem_type;
+    
     HamParams(const string &prefix = ""):
-        Printable(" " + prefix)
+        Printable(" " + prefix), mBz(0), mBzGauge(coord::X)
     {        
     }
     
@@ -52,13 +68,67 @@ public:
     
     void   Bz(double Bz, int gauge = coord::X){ mBz = Bz; mBzGauge = gauge; update(); };
     double Bz() const { return mBz; }
+    int    BzGauge() const { return mBzGauge; }
+    //!< Does twoAtomHam() multiply the hoppings by the Peierls phase of Bz?
+    virtual bool usesPeierlsPhase() const { return false; }
+    
+    //!< Largest distance between two coupled atoms. Zero means unknown: 
+    //!< all the pairs of atoms are tried.
+    virtual double cutoff() const { return 0; }
     
-    //!< Generate Hamiltonian between two atoms.
+    //!< Kernel interface. Writes the Hamiltonian between atom i at ri = 
+    //!< {x, y, z} with atomic number si and atom j at rj with atomic number 
+    //!< sj into the column major block out with leading dimension ld. The
+    //!< block must be zeroed by the caller. Returns false if the atoms are not
+    //!< coupled, out is not touched then.
+    virtual bool pairHam(const double *ri, int si, const double *rj, int sj, 
+                            elem_type *out, uword ld) const { return false; };
+    //!< Same as pairHam() for the overlap matrix.
+    virtual bool pairOvl(const double *ri, int si, const double *rj, int sj, 
+                            elem_type *out, uword ld) const { return false; };
+    
+    //!< Generate Hamiltonian between two atoms. Adapter of pairHam().
     virtual T twoAtomHam(const AtomicStruct& atomi, 
-                            const AtomicStruct& atomj) const { return T(); };
-    //!< Generate Overlap matrix between two atoms.
+                            const AtomicStruct& atomj) const;
+    //!< Generate Overlap matrix between two atoms. Adapter of pairOvl().
     virtual T twoAtomOvl(const AtomicStruct& atomi, 
-                            const AtomicStruct& atomj) const { return T(); };
+                            const AtomicStruct& atomj) const;
+    
+    //!< Exact binary image of everything that changes the Hamiltonian. Two
+    //!< parameter sets with the same fingerprint generate the same matrices.
+    virtual string fingerprint() const {
+        string fp = typeid(*this).name();
+        addFingerprint(fp, mdtol);
+        addFingerprint(fp, mortho);
+        addFingerprint(fp, mBz);
+        addFingerprint(fp, mBzGauge);
+        addFingerprint(fp, mfactor);
+        return fp;
+    }
+    
+protected:
+    //!< Appends the bytes of x to fingerprint fp.
+    template<class V>
+    static void addFingerprint(string &fp, const V &x){
+        fp.append(reinterpret_cast<const char*>(&x), sizeof(x));
+    }
+    static void addFingerprint(string &fp, const T &m){
+        addFingerprint(fp, m.n_rows);
+        addFingerprint(fp, m.n_cols);
+        fp.append(reinterpret_cast<const char*>(m.memptr()), 
+                m.n_elem*sizeof(elem_type));
+    }
+    
+    //!< Writes a*blk into out with leading dimension ld.
+    static void putBlock(elem_type *out, uword ld, const T &blk, 
+                            elem_type a = elem_type(1))
+    {
+        for (uword n = 0; n < blk.n_cols; ++n){
+            for (uword m = 0; m < blk.n_rows; ++m){
+                out[n*ld + m] = a*blk(m, n);
+            }
+        }
+    }
     
 protected:
     // Updates internal parameters. Call it after changing any of the 
@@ -76,11 +146,45 @@ protected:
     double mBz;           //!< The z-component of magnetic field.
     int    mBzGauge;      //!< gauge choice for the z-component.
     //!< pre-factor for magnetic phase = i*hbar/q/2
-    double mfactor = 1E-20*q/hbar/2; 
+    double mfactor = PeierlsFactor; 
     static constexpr double mBzTol = 1E-10;
 };
 
 
+template<class T>
+T HamParams<T>::twoAtomHam(const AtomicStruct& atomi, 
+        const AtomicStruct& atomj) const
+{
+    if (atomi.NumOfAtoms() > 1 || atomj.NumOfAtoms() > 1) {
+        throw invalid_argument("In HamParams::twoAtomHam(): atomi and atomj must contain one atom each.");
+    }
+    
+    T hmat = zeros<T>(atomi.NumOfOrbitals(), atomj.NumOfOrbitals());
+    double ri[3] = {atomi.X(0), atomi.Y(0), atomi.Z(0)};
+    double rj[3] = {atomj.X(0), atomj.Y(0), atomj.Z(0)};
+    pairHam(ri, atomi.AtomicNumber(0), rj, atomj.AtomicNumber(0), 
+            hmat.memptr(), hmat.n_rows);
+    
+    return hmat;
+}
+
+template<class T>
+T HamParams<T>::twoAtomOvl(const AtomicStruct& atomi, 
+        const AtomicStruct& atomj) const
+{
+    if (atomi.NumOfAtoms() > 1 || atomj.NumOfAtoms() > 1) {
+        throw invalid_argument("In HamParams::twoAtomOvl(): atomi and atomj must contain one atom each.");
+    }
+    
+    T smat = zeros<T>(atomi.NumOfOrbitals(), atomj.NumOfOrbitals());
+    double ri[3] = {atomi.X(0), atomi.Y(0), atomi.Z(0)};
+    double rj[3] = {atomj.X(0), atomj.Y(0), atomj.Z(0)};
+    pairOvl(ri, atomi.AtomicNumber(0), rj, atomj.AtomicNumber(0), 
+            smat.memptr(), smat.n_rows);
+    
+    return smat;
+}
+
 // Caluclates Peierl's phase factor for magnetic field
 template<class T>
 dcmplx HamParams<T>::calcPeierlsPhase(double xi, double yi, 
@@ -99,41 +203,219 @@ dcmplx HamParams<T>::calcPeierlsPhase(double xi, double yi,
     return phase;
 }
 
+//!< Peierls phases of many bonds (xi, yi) -> (xj, yj) at once.
+inline cxvec peierlsPhase(const vec &xi, const vec &yi, const vec &xj, 
+        const vec &yj, double Bz, int gauge = coord::X)
+{
+    vec phi(xi.n_elem, fill::zeros);
+    if (gauge == coord::X) { // for A = (-Bz*y, 0, 0)
+        phi = (PeierlsFactor*Bz)*((xi - xj) % (yi + yj));
+    } else if (gauge == coord::Y) { // for A = (0, Bz*x, 0)
+        phi = (PeierlsFactor*Bz)*((yj - yi) % (xi + xj));
+    }
+    return cxvec(cos(phi), sin(phi));
+}
+
+//!< Atoms of bj within cutoff of each atom of bi, in ascending order. The
+//!< atoms of bj are put in cubic cells of size cutoff, so each atom of bi is
+//!< compared only with the atoms in the 27 cells around it: O(N) instead of
+//!< O(N^2). If cutoff <= 0, all the atoms of bj are returned for each atom.
+inline vector<vector<uint> > neighborPairs(const AtomicStructView &bi, 
+        const AtomicStructView &bj, double cutoff)
+{
+    uint nai = bi.NumOfAtoms();
+    uint naj = bj.NumOfAtoms();
+    vector<vector<uint> > neigh(nai);
+    if (naj == 0){
+        return neigh;
+    }
+    
+    if (cutoff <= 0){
+        vector<uint> all(naj);
+        for (uint ja = 0; ja < naj; ++ja){
+            all[ja] = ja;
+        }
+        neigh.assign(nai, all);
+        return neigh;
+    }
+    
+    // cells of the atoms of bj, counted from the lowest corner of bj
+    typedef long long cellkey;
+    double rmin[3], rmax[3];
+    long long ncells[3];
+    for (int ic = 0; ic < 3; ++ic){
+        rmin[ic] = rmax[ic] = bj.R(0, ic);
+        for (uint ja = 1; ja < naj; ++ja){
+            rmin[ic] = std::min(rmin[ic], bj.R(ja, ic));
+            rmax[ic] = std::max(rmax[ic], bj.R(ja, ic));
+        }
+        ncells[ic] = (long long)std::floor((rmax[ic] - rmin[ic])/cutoff) + 1;
+    }
+    std::unordered_map<cellkey, vector<uint> > cells;
+    for (uint ja = 0; ja < naj; ++ja){
+        cellkey c[3];
+        for (int ic = 0; ic < 3; ++ic){
+            c[ic] = (cellkey)std::floor((bj.R(ja, ic) - rmin[ic])/cutoff);
+        }
+        cells[(c[0]*ncells[1] + c[1])*ncells[2] + c[2]].push_back(ja);
+    }
+    
+    double cutoff2 = cutoff*cutoff;
+    for (uint ia = 0; ia < nai; ++ia){
+        cellkey c[3];
+        for (int ic = 0; ic < 3; ++ic){
+            c[ic] = (cellkey)std::floor((bi.R(ia, ic) - rmin[ic])/cutoff);
+        }
+        for (cellkey cx = c[0] - 1; cx <= c[0] + 1; ++cx){
+            if (cx < 0 || cx >= ncells[0]) continue;
+            for (cellkey cy = c[1] - 1; cy <= c[1] + 1; ++cy){
+                if (cy < 0 || cy >= ncells[1]) continue;
+                for (cellkey cz = c[2] - 1; cz <= c[2] + 1; ++cz){
+                    if (cz < 0 || cz >= ncells[2]) continue;
+                    std::unordered_map<cellkey, vector<uint> >::const_iterator it = 
+                            cells.find((cx*ncells[1] + cy)*ncells[2] + cz);
+                    if (it == cells.end()) continue;
+                    for (uint in = 0; in < it->second.size(); ++in){
+                        uint ja = it->second[in];
+                        double dx = bj.X(ja) - bi.X(ia);
+                        double dy = bj.Y(ja) - bi.Y(ia);
+                        double dz = bj.Z(ja) - bi.Z(ia);
+                        if (dx*dx + dy*dy + dz*dz <= cutoff2){
+                            neigh[ia].push_back(ja);
+                        }
+                    }
+                }
+            }
+        }
+        std::sort(neigh[ia].begin(), neigh[ia].end());
+    }
+    
+    return neigh;
+}
+
+//!< Per atom data of an atomic block for the pair kernels, extracted once
+//!< so that no AtomicStruct is created per pair.
+struct BlockSites{
+    mat  r;     //!< 3 x na, r.colptr(ia) points to {x, y, z} of atom ia.
+    icol id;    //!< Atomic numbers.
+    icol io;    //!< First orbital of each atom, io(na) is the number of orbitals.
+    int  nomax; //!< Largest number of orbitals of an atom.
+    
+    BlockSites(const AtomicStructView &b): r(3, b.NumOfAtoms()), 
+            id(b.NumOfAtoms()), io(b.NumOfAtoms() + 1), nomax(0)
+    {
+        io(0) = 0;
+        for (int ia = 0; ia < b.NumOfAtoms(); ++ia){
+            r(0, ia) = b.X(ia);
+            r(1, ia) = b.Y(ia);
+            r(2, ia) = b.Z(ia);
+            id(ia) = b.AtomicNumber(ia);
+            int no = b.NumOfOrbitalsAt(ia);
+            io(ia + 1) = io(ia) + no;
+            nomax = std::max(nomax, no);
+        }
+    }
+    
+    int no(uint ia) const { return io(ia + 1) - io(ia); }
+};
+
+//!< Writes the rows of the atoms ia0 to ia1-1 of block i into hmat and smat, 
+//!< which must be allocated and zeroed. Different row ranges write to 
+//!< different elements, so they can be generated concurrently.
+template<class T>
+void generateHamOvlRows(T &hmat, T &smat, const HamParams<T> &p, 
+        const BlockSites &si, const BlockSites &sj, 
+        const vector<vector<uint> > &neigh, uint ia0, uint ia1){
+    uword noi = hmat.n_rows;
+    for(uint ia = ia0; ia < ia1; ++ia){
+        for(uint in = 0; in < neigh[ia].size(); ++in){
+            int ja = neigh[ia][in];
+            // generate Hamiltonian matrix between orbitals of
+            // atom i and atom j
+            p.pairHam(si.r.colptr(ia), si.id(ia), sj.r.colptr(ja), sj.id(ja), 
+                    hmat.colptr(sj.io(ja)) + si.io(ia), noi);
+            p.pairOvl(si.r.colptr(ia), si.id(ia), sj.r.colptr(ja), sj.id(ja), 
+                    smat.colptr(sj.io(ja)) + si.io(ia), noi);
+        }
+    }    
+}
+
 //!< Generates the hamiltonaina and overlap matrices between atomc block
-//!< i and atomic block j. 
+//!< i and atomic block j. Only the atoms within p.cutoff() are visited and
+//!< the pair kernels write straight into hmat and smat.
 template<class T>
 void generateHamOvl(T &hmat, T&smat, const HamParams<T> &p, 
-        const AtomicStruct &bi, const AtomicStruct &bj){
-    // Just for easy reference
-    int nai = bi.NumOfAtoms();
-    int naj = bj.NumOfAtoms();
-    int noi = bi.NumOfOrbitals();
-    int noj = bj.NumOfOrbitals();
-
+        const AtomicStructView &bi, const AtomicStructView &bj){
+    BlockSites si(bi), sj(bj);
+    
     // Most of the matrix elements are zeros. So, we'll only change the 
     // non zero elements below.
-    hmat = zeros<T>(noi, noj);
-    smat = zeros<T>(noi, noj);
+    hmat = zeros<T>(si.io(bi.NumOfAtoms()), sj.io(bj.NumOfAtoms()));
+    smat = zeros<T>(si.io(bi.NumOfAtoms()), sj.io(bj.NumOfAtoms()));
 
     // Lets find the neighbors. 
-    int io = 0;
+    vector<vector<uint> > neigh = neighborPairs(bi, bj, p.cutoff());
+    generateHamOvlRows(hmat, smat, p, si, sj, neigh, 0, bi.NumOfAtoms());
+}   
+
+//!< Same as generateHamOvl() but assembles sparse matrices from the non-zero
+//!< elements only, the dense noi x noj blocks are never created.
+template<class T>
+void generateSpHamOvl(arma::SpMat<typename T::elem_type> &hmat, 
+        arma::SpMat<typename T::elem_type> &smat, const HamParams<T> &p, 
+        const AtomicStructView &bi, const AtomicStructView &bj){
+    typedef typename T::elem_type eT;
+    
+    // Just for easy reference
+    int nai = bi.NumOfAtoms();
+    BlockSites si(bi), sj(bj);
+    int noi = si.io(nai);
+    int noj = sj.io(bj.NumOfAtoms());
+    
+    // non-zero elements as (row, column, value) triplets
+    vector<uword> hloc, sloc;
+    vector<eT> hval, sval;
+    
+    // one two-atom block, reused for all the pairs
+    T h(si.nomax, sj.nomax), s(si.nomax, sj.nomax);
+    
+    vector<vector<uint> > neigh = neighborPairs(bi, bj, p.cutoff());
     for(int ia = 0; ia != nai; ++ia){
-        AtomicStruct atomi = bi(ia);        // extract atom ia
-        int ni = atomi.NumOfOrbitals();     // number of orbitals in atom ia
+        int io = si.io(ia);
+        int ni = si.no(ia);
 
-        int jo = 0;
-        for(int ja = 0; ja != naj; ++ja){
-            AtomicStruct atomj = bj(ja);        // extract atom ja    
-            int nj = atomj.NumOfOrbitals();     // number of orbitals in atom ja
-            // generate Hamiltonian matrix between orbitals of
-            // atom i and atom j
-            hmat(span(io,io+ni-1), span(jo,jo+nj-1)) = p.twoAtomHam(atomi, atomj);
-            smat(span(io,io+ni-1), span(jo,jo+nj-1)) = p.twoAtomOvl(atomi, atomj);
-            jo += nj;
+        for(uint in = 0; in < neigh[ia].size(); ++in){
+            int ja = neigh[ia][in];
+            int jo = sj.io(ja);
+            int nj = sj.no(ja);
+            
+            h.zeros();
+            s.zeros();
+            bool hnz = p.pairHam(si.r.colptr(ia), si.id(ia), sj.r.colptr(ja), 
+                    sj.id(ja), h.memptr(), h.n_rows);
+            bool snz = p.pairOvl(si.r.colptr(ia), si.id(ia), sj.r.colptr(ja), 
+                    sj.id(ja), s.memptr(), s.n_rows);
+            for (int n = 0; n < nj; ++n){
+                for (int m = 0; m < ni; ++m){
+                    if (hnz && h(m, n) != eT(0)){
+                        hloc.push_back(io + m);
+                        hloc.push_back(jo + n);
+                        hval.push_back(h(m, n));
+                    }
+                    if (snz && s(m, n) != eT(0)){
+                        sloc.push_back(io + m);
+                        sloc.push_back(jo + n);
+                        sval.push_back(s(m, n));
+                    }
+                }
+            }
         }
-
-        io += ni;
     }    
+    
+    hmat = arma::SpMat<eT>(arma::Mat<uword>(hloc.data(), 2, hval.size()), 
+            arma::Col<eT>(hval), noi, noj);
+    smat = arma::SpMat<eT>(arma::Mat<uword>(sloc.data(), 2, sval.size()), 
+            arma::Col<eT>(sval), noi, noj);
 }   
 
 typedef HamParams<cxmat>  cxhamparams;
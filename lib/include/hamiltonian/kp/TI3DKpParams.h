@@ -45,10 +45,15 @@ public:
 
     virtual string toString() const;
 
-    //!< Generate Hamiltonian between two atoms.
-    virtual cxmat twoAtomHam(const AtomicStruct& atomi, const AtomicStruct& atomj) const;    
-    //!< Generate overlap matrix between two atoms.
-    virtual cxmat twoAtomOvl(const AtomicStruct& atomi, const AtomicStruct& atomj) const;    
+    //!< Hamiltonian between two atoms.
+    virtual bool  pairHam(const double *ri, int si, const double *rj, int sj, 
+                            dcmplx *out, uword ld) const;
+    //!< Overlap matrix between two atoms.
+    virtual bool  pairOvl(const double *ri, int si, const double *rj, int sj, 
+                            dcmplx *out, uword ld) const;
+    //!< Nearest neighbors only.
+    virtual double cutoff() const { return ma + mdtol; }
+    virtual string fingerprint() const;
     
 private:
     //!< Default parameters.
@@ -14,6 +14,7 @@
 #include "atoms/AtomicStruct.h"
 #include "utils/Printable.hpp"
 #include "hamiltonian/hamiltonian.hpp"
+#include "hamiltonian/kp/kpstencil.h"
 
 namespace quest{
 namespace hamiltonian{
@@ -34,10 +35,17 @@ public:
     double K() const {return mK; }
     void   K(double newK ){ mK = newK; update(); }
 
-    //!< Generate Hamiltonian between two atoms.
-    virtual cxmat twoAtomHam(const AtomicStruct& atomi, const AtomicStruct& atomj) const;    
-    //!< Generate overlap matrix between two atoms.
-    virtual cxmat twoAtomOvl(const AtomicStruct& atomi, const AtomicStruct& atomj) const;
+    //!< Hamiltonian between two atoms.
+    virtual bool  pairHam(const double *ri, int si, const double *rj, int sj, 
+                            dcmplx *out, uword ld) const;
+    //!< Overlap matrix between two atoms.
+    virtual bool  pairOvl(const double *ri, int si, const double *rj, int sj, 
+                            dcmplx *out, uword ld) const;
+    virtual bool  usesPeierlsPhase() const { return true; }
+    virtual double cutoff() const { return ma + mdtol; }
+    //!< Onsite and hopping matrices for generateKpBlocks().
+    KpStencil stencil() const;
+    virtual string fingerprint() const;
 protected:
     //!< Updates internal tight binding parameters calculated using 
     //!< k.p model. Call it after changing any of the k.p parameters.
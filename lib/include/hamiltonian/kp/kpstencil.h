@@ -0,0 +1,72 @@
+/*
+ * File:   kpstencil.h
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 11:05 PM
+ *
+ * Description: Block-tridiagonal Hamiltonian of discretized k.p models on 
+ * rectangular grids, generated from the stencil without neighbor search.
+ *
+ */
+
+#ifndef KPSTENCIL_H
+#define	KPSTENCIL_H
+
+#include "hamiltonian/hamiltonian.hpp"
+
+namespace quest{
+namespace hamiltonian{
+
+/**
+ * Onsite and nearest neighbor matrices of a discretized k.p model on a 
+ * rectangular grid of spacing a. t10x couples a site to its neighbor at 
+ * smaller x, t01x to the one at larger x and the same for y.
+ */
+struct KpStencil{
+    double  a;          //!< Grid spacing.
+    cxmat   I;          //!< Overlap matrix of a site.
+    cxmat   eps;        //!< Onsite matrix.
+    cxmat   t01x;
+    cxmat   t10x;
+    cxmat   t01y;
+    cxmat   t10y;
+    bool    peierls;    //!< Do the hoppings carry the Peierls phase of Bz?
+    double  Bz;
+    int     BzGauge;
+    double  factor;     //!< Pre-factor of the Peierls phase.
+};
+
+/**
+ * The device is nx columns of ny sites along y, at x = x0 + ix*a and y = 
+ * y0 + iy*a, the ordering of genSimpleCubicStruct(). Block ix is column ix
+ * with the orbitals of site iy at iy*no.
+ */
+
+//!< Hamiltonian of block ix.
+cxmat kpBlockH0(const KpStencil &st, uint ny, double x0, double y0, int ix);
+//!< Coupling of block ix to block ix - 1.
+cxmat kpBlockHl(const KpStencil &st, uint ny, double x0, double y0, int ix);
+//!< Overlap matrix of a block.
+cxmat kpBlockS0(const KpStencil &st, uint ny);
+
+//!< H0(0..nx-1), Hl(0..nx) and S0(0..nx-1) of the device, Hl(0) and 
+//!< Hl(nx) being the couplings to the contact blocks at ix = -1 and nx. 
+//!< Blocks that do not depend on x (no field or gauge X) are generated once
+//!< and shared.
+void generateKpBlocks(field<shared_ptr<cxmat> > &H0, 
+        field<shared_ptr<cxmat> > &Hl, field<shared_ptr<cxmat> > &S0, 
+        const KpStencil &st, uint nx, uint ny, double x0 = 0, double y0 = 0);
+
+//!< Same as above, for any parameter class with stencil().
+template<class P>
+void generateKpBlocks(field<shared_ptr<cxmat> > &H0, 
+        field<shared_ptr<cxmat> > &Hl, field<shared_ptr<cxmat> > &S0, 
+        const P &p, uint nx, uint ny, double x0 = 0, double y0 = 0)
+{
+    generateKpBlocks(H0, Hl, S0, p.stencil(), nx, ny, x0, y0);
+}
+
+}
+}
+#endif	/* KPSTENCIL_H */
+
@@ -13,6 +13,7 @@
 #include "utils/Printable.hpp"
 #include "atoms/AtomicStruct.h"
 #include "hamiltonian/hamiltonian.hpp"
+#include "hamiltonian/kp/kpstencil.h"
 
 namespace quest{
 namespace hamiltonian{
@@ -48,10 +49,17 @@ public:
     
     virtual string toString() const;
 
-    //!< Generate Hamiltonian between two atoms.
-    virtual cxmat twoAtomHam(const AtomicStruct& atomi, const AtomicStruct& atomj) const;    
-    //!< Generate overlap matrix between two atoms.
-    virtual cxmat twoAtomOvl(const AtomicStruct& atomi, const AtomicStruct& atomj) const;    
+    //!< Hamiltonian between two atoms.
+    virtual bool  pairHam(const double *ri, int si, const double *rj, int sj, 
+                            dcmplx *out, uword ld) const;
+    //!< Overlap matrix between two atoms.
+    virtual bool  pairOvl(const double *ri, int si, const double *rj, int sj, 
+                            dcmplx *out, uword ld) const;
+    //!< Nearest neighbors only.
+    virtual double cutoff() const { return ma + mdtol; }
+    //!< Onsite and hopping matrices for generateKpBlocks().
+    KpStencil stencil() const;
+    virtual string fingerprint() const;
     
 private:
     //!< Default parameters.
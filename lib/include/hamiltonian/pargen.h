@@ -0,0 +1,47 @@
+/*
+ * File:   pargen.h
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 10:30 PM
+ *
+ * Description: Multithreaded Hamiltonian generation.
+ *
+ */
+
+#ifndef PARGEN_H
+#define	PARGEN_H
+
+#include "hamiltonian/hamiltonian.hpp"
+#include "hamiltonian/bonds.h"
+#include "utils/parallel.h"
+
+namespace quest{
+namespace hamiltonian{
+
+using utils::parallelFor;
+
+//!< Number of threads to use: nthreads, or all the hardware threads if 0.
+inline uint hamThreads(uint nthreads){ return utils::numThreads(nthreads); }
+
+//!< generateHamOvl() with the rows of atoms of bi distributed over nthreads
+//!< threads. Each row is generated exactly as in the serial version, so the 
+//!< result is bit-identical.
+void generateHamOvl(cxmat &hmat, cxmat &smat, const cxhamparams &p, 
+        const AtomicStructView &bi, const AtomicStructView &bj, uint nthreads);
+
+//!< Hamiltonian and overlap matrices of many pairs of blocks, bi[ib] and
+//!< bj[ib], with the pairs distributed over nthreads threads.
+void generateHamOvl(vector<cxmat> &hmat, vector<cxmat> &smat, 
+        const cxhamparams &p, const vector<AtomicStruct> &bi, 
+        const vector<AtomicStruct> &bj, uint nthreads);
+
+//!< Bond lists of many pairs of blocks, bi[ib] and bj[ib], with the pairs
+//!< distributed over nthreads threads.
+vector<shared_ptr<BondHam> > generateBonds(const cxhamparams &p, 
+        const vector<AtomicStruct> &bi, const vector<AtomicStruct> &bj, 
+        uint nthreads);
+
+}
+}
+#endif	/* PARGEN_H */
+
@@ -0,0 +1,246 @@
+/*
+ * File:   partition.hpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 5:10 PM
+ *
+ * Description: Block-tridiagonal partitioning of a device for RGF.
+ *
+ */
+
+#ifndef PARTITION_HPP
+#define	PARTITION_HPP
+
+#include "hamiltonian/hamiltonian.hpp"
+#include "utils/stringutils.h"
+
+#include <algorithm>
+#include <queue>
+
+namespace quest{
+namespace hamiltonian{
+
+using utils::strings::itos;
+
+typedef vector<vector<uint> > neighlist;
+
+//!< Finds the atoms of bj coupled to each atom of bi through the Hamiltonian
+//!< or the overlap matrix. If same is true, bi and bj are the same structure
+//!< and an atom is not its own neighbor. Only the atoms within p.cutoff()
+//!< are tried.
+template<class T>
+neighlist findNeighbors(const HamParams<T> &p, const AtomicStructView &bi,
+        const AtomicStructView &bj, bool same = false)
+{
+    int nai = bi.NumOfAtoms();
+
+    BlockSites si(bi), sj(bj);
+    T blk(si.nomax, sj.nomax);
+    
+    neighlist candidates = neighborPairs(bi, bj, p.cutoff());
+    neighlist neigh(nai);
+    for(int ia = 0; ia != nai; ++ia){
+        for(uint in = 0; in < candidates[ia].size(); ++in){
+            int ja = candidates[ia][in];
+            if (same && ia == ja){
+                continue;
+            }
+            blk.zeros();
+            bool coupled = p.pairHam(si.r.colptr(ia), si.id(ia), 
+                    sj.r.colptr(ja), sj.id(ja), blk.memptr(), blk.n_rows)
+                    && accu(abs(blk)) > 0;
+            if (!coupled && !p.orthogonal()){
+                blk.zeros();
+                coupled = p.pairOvl(si.r.colptr(ia), si.id(ia), 
+                        sj.r.colptr(ja), sj.id(ja), blk.memptr(), blk.n_rows)
+                        && accu(abs(blk)) > 0;
+            }
+            if (coupled){
+                neigh[ia].push_back(ja);
+            }
+        }
+    }
+
+    return neigh;
+}
+
+//!< Breadth first search levels of all the atoms starting from the atoms
+//!< in start. Atoms that cannot be reached get level -1.
+inline ivec bfsLevels(const neighlist &adj, const vector<uint> &start){
+    ivec level(adj.size());
+    level.fill(-1);
+
+    std::queue<uint> Q;
+    for (uint is = 0; is < start.size(); ++is){
+        level(start[is]) = 0;
+        Q.push(start[is]);
+    }
+    while (!Q.empty()){
+        uint ia = Q.front();
+        Q.pop();
+        for (uint in = 0; in < adj[ia].size(); ++in){
+            uint ja = adj[ia][in];
+            if (level(ja) == -1){
+                level(ja) = level(ia) + 1;
+                Q.push(ja);
+            }
+        }
+    }
+    return level;
+}
+
+//!< Layers of the device starting from the atoms coupled to one contact.
+//!< Layer l holds the atoms l hops away from the first contact. The layer
+//!< touching the other contact and everything behind it is one layer, so
+//!< that the other contact is coupled only to the last layer.
+inline vector<vector<uint> > layersFrom(const neighlist &adj,
+        const vector<uint> &first, const vector<uint> &last)
+{
+    ivec level = bfsLevels(adj, first);
+    int lastLevel = level.max();
+    for (uint ia = 0; ia < last.size(); ++ia){
+        if (level(last[ia]) != -1 && level(last[ia]) < lastLevel){
+            lastLevel = level(last[ia]);
+        }
+    }
+
+    // Atoms not reached from the first contact are not coupled to the
+    // others, they can go to any layer.
+    vector<vector<uint> > layers(lastLevel + 1);
+    for (uint ia = 0; ia < adj.size(); ++ia){
+        int l = level(ia);
+        if (l == -1 || l > lastLevel){
+            l = lastLevel;
+        }
+        layers[l].push_back(ia);
+    }
+    return layers;
+}
+
+//!< Checks that the blocks of a device make a block-tridiagonal matrix:
+//!< each block is coupled only to its neighbors, the left contact only to
+//!< the first block and the right contact only to the last block.
+template<class T>
+void checkPartition(const field<ucol> &blocks, const HamParams<T> &p,
+        const AtomicStruct &dev, const AtomicStruct &lc, const AtomicStruct &rc)
+{
+    uint na = dev.NumOfAtoms();
+    uint nb = blocks.n_elem;
+
+    ivec blockOf(na);
+    blockOf.fill(-1);
+    for (uint ib = 0; ib < nb; ++ib){
+        for (uint ia = 0; ia < blocks(ib).n_elem; ++ia){
+            blockOf(blocks(ib)(ia)) = ib;
+        }
+    }
+    if (any(blockOf == -1)){
+        throw invalid_argument("In checkPartition(): some of the atoms are not in any block.");
+    }
+
+    AtomicStructView devv(dev), lcv(lc), rcv(rc);
+    neighlist adj = findNeighbors(p, devv, devv, true);
+    for (uint ia = 0; ia < na; ++ia){
+        for (uint in = 0; in < adj[ia].size(); ++in){
+            if (std::abs(blockOf(ia) - blockOf(adj[ia][in])) > 1){
+                throw invalid_argument("In checkPartition(): atoms "
+                        + itos(ia) + " and " + itos(adj[ia][in])
+                        + " are coupled but are not in neighboring blocks.");
+            }
+        }
+    }
+
+    neighlist toLeft = findNeighbors(p, devv, lcv);
+    neighlist toRight = findNeighbors(p, devv, rcv);
+    for (uint ia = 0; ia < na; ++ia){
+        if (!toLeft[ia].empty() && blockOf(ia) != 0){
+            throw invalid_argument("In checkPartition(): atom " + itos(ia)
+                    + " is coupled to the left contact but is not in the first block.");
+        }
+        if (!toRight[ia].empty() && blockOf(ia) != (int)nb-1){
+            throw invalid_argument("In checkPartition(): atom " + itos(ia)
+                    + " is coupled to the right contact but is not in the last block.");
+        }
+    }
+}
+
+//!< Partitions the device dev between the left contact lc and the right
+//!< contact rc into the thinnest block-tridiagonal layers. The layers are
+//!< built by breadth first search from each of the contacts and the one
+//!< with smaller sum of (block size)^3, i.e., the cheaper for RGF, is taken.
+//!< Returns the indices of the atoms of dev in each block, ordered along
+//!< x, y and z.
+template<class T>
+field<ucol> partition(const HamParams<T> &p, const AtomicStruct &dev,
+        const AtomicStruct &lc, const AtomicStruct &rc)
+{
+    uint na = dev.NumOfAtoms();
+    AtomicStructView devv(dev), lcv(lc), rcv(rc);
+    neighlist adj = findNeighbors(p, devv, devv, true);
+    neighlist toLeft = findNeighbors(p, devv, lcv);
+    neighlist toRight = findNeighbors(p, devv, rcv);
+
+    // device atoms at the surfaces
+    vector<uint> left, right;
+    for (uint ia = 0; ia < na; ++ia){
+        if (!toLeft[ia].empty()){
+            left.push_back(ia);
+        }
+        if (!toRight[ia].empty()){
+            right.push_back(ia);
+        }
+    }
+    if (left.empty() || right.empty()){
+        throw invalid_argument("In partition(): the device is not coupled to both the contacts.");
+    }
+
+    vector<vector<uint> > fromLeft = layersFrom(adj, left, right);
+    vector<vector<uint> > fromRight = layersFrom(adj, right, left);
+    std::reverse(fromRight.begin(), fromRight.end());
+
+    // RGF cost ~ sum of no^3
+    double costLeft = 0, costRight = 0;
+    for (uint il = 0; il < fromLeft.size(); ++il){
+        double no = 0;
+        for (uint ia = 0; ia < fromLeft[il].size(); ++ia){
+            no += devv.NumOfOrbitalsAt(fromLeft[il][ia]);
+        }
+        costLeft += no*no*no;
+    }
+    for (uint il = 0; il < fromRight.size(); ++il){
+        double no = 0;
+        for (uint ia = 0; ia < fromRight[il].size(); ++ia){
+            no += devv.NumOfOrbitalsAt(fromRight[il][ia]);
+        }
+        costRight += no*no*no;
+    }
+    vector<vector<uint> > &layers = (costRight < costLeft) ? fromRight : fromLeft;
+
+    // order the atoms of each block along x, then y, then z.
+    mat xyz = dev.XYZ();
+    struct alongTransport{
+        const mat &xyz;
+        alongTransport(const mat &xyz):xyz(xyz){};
+        bool operator()(uint a, uint b) const {
+            for (uint ic = 0; ic < xyz.n_cols; ++ic){
+                if (xyz(a, ic) != xyz(b, ic)){
+                    return xyz(a, ic) < xyz(b, ic);
+                }
+            }
+            return a < b;
+        };
+    } lessXyz(xyz);
+
+    field<ucol> blocks(layers.size());
+    for (uint il = 0; il < layers.size(); ++il){
+        std::sort(layers[il].begin(), layers[il].end(), lessXyz);
+        blocks(il) = conv_to<ucol>::from(layers[il]);
+    }
+
+    return blocks;
+}
+
+}
+}
+#endif	/* PARTITION_HPP */
+
@@ -47,10 +47,15 @@ public:
     void alpha(double alpha) { malpha = alpha; update(); }
     double alpha() const { return malpha; }
 
-    //!< Generate Hamiltonian between two atoms.
-    virtual cxmat twoAtomHam(const AtomicStruct& atomi, const AtomicStruct& atomj) const;    
-    //!< Generate overlap matrix between two atoms.
-    virtual cxmat twoAtomOvl(const AtomicStruct& atomi, const AtomicStruct& atomj) const;        
+    //!< Hamiltonian between two atoms.
+    virtual bool  pairHam(const double *ri, int si, const double *rj, int sj, 
+                            dcmplx *out, uword ld) const;
+    //!< Overlap matrix between two atoms.
+    virtual bool  pairOvl(const double *ri, int si, const double *rj, int sj, 
+                            dcmplx *out, uword ld) const;
+    //!< In-plane nearest neighbors and out-of-plane neighbors within doX*di0.
+    virtual double cutoff() const { return std::max(mdi0, mdo0 + mdoX*mdi0) + mdtol; }
+    virtual string fingerprint() const;
     
 private:
     //!< Default parameters.
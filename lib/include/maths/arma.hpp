@@ -45,6 +45,9 @@ using arma::abs;
 using arma::cross;
 using arma::conv_to;
 using arma::normalise;
+using arma::sp_mat;
+using arma::sp_cx_mat;
+using arma::spsolve;
 
 typedef arma::Col<double>         vec;       //!< Double precision column vector.
 typedef arma::Col<dcmplx>         cxvec;     //!< Double precision complex column vector.
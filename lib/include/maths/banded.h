@@ -0,0 +1,59 @@
+/*
+ * File:   banded.h
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 3:20 PM
+ *
+ * Helpers for banded matrices: reordering, bandwidth, banded inverse and
+ * low rank updates of an inverse.
+ *
+ */
+
+#ifndef BANDED_H
+#define	BANDED_H
+
+#include "maths/arma.hpp"
+#include "utils/std.hpp"
+
+namespace maths{
+using namespace maths::armadillo;
+using namespace utils::stds;
+
+/*
+ * Reverse Cuthill-McKee ordering of the sparsity pattern of A + A'.
+ * A(p, p) has a smaller bandwidth than A. Elements with |A_ij| <= tol
+ * are treated as zeros.
+ */
+uwcol rcm(const cxmat &A, double tol = 0);
+
+/*
+ * Bandwidth of A: max |i - j| over all |A_ij| > tol.
+ */
+uword bandwidth(const cxmat &A, double tol = 0);
+
+/*
+ * Indices of the non-zero rows (or columns) of A.
+ */
+uwcol nonzeroRows(const cxmat &A, double tol = 0);
+uwcol nonzeroCols(const cxmat &A, double tol = 0);
+
+/*
+ * Ainv = inv(A) where A has kb sub and super diagonals. Uses LU
+ * factorization of the band only: O(n*kb^2) + O(n^2*kb) instead of O(n^3).
+ * Returns false if A is singular.
+ */
+bool invBanded(cxmat &Ainv, const cxmat &A, uword kb);
+
+/*
+ * Returns inv(A - Sig) from Ainv = inv(A) when Sig is non-zero only on
+ * the rows and columns P: Sig = E_P*SigPP*E_P' (Woodbury identity).
+ * Ainv ------> inv(A).
+ * SigPP -----> Sig(P, P).
+ * P ---------> Rows and columns on which Sig is non-zero.
+ */
+cxmat invUpdate(const cxmat &Ainv, const cxmat &SigPP, const uwcol &P);
+
+}
+
+#endif	/* BANDED_H */
+
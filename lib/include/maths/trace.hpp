@@ -76,6 +76,110 @@ T trace(const T &A, uint N = 1, const ucol *vertices = 0){
     return tr;
 }
 
+/*
+ * Checks the arguments of the trace of a product of matrices where the 
+ * product is an m x n matrix.
+ */
+inline void traceProdCheck(uint m, uint n, uint N, const ucol *vertices){
+    if (m != n){
+        stringstream err;
+        err << "In traceProd(A, B, N): A*B(" << m << "x" << n << ")  is not square matrix.";
+        throw invalid_argument(err.str());
+    }    
+    if (m%N != 0){
+        stringstream err;
+        err << "In traceProd(A, B, N): number of rows/cols of A*B(" << m << "x" << n << ") has to be multiple of N = " << N << ".";
+        throw invalid_argument(err.str());
+    } 
+    if(vertices != 0 && (max(*vertices)+1)*N > m){
+        stringstream err;
+        err << "In traceProd(A, B, N, vertices): one of the vertices exceeds size of of A*B(" << m << "x" << n << "). (max(vertices)+1)*N-1 = " <<  (max(*vertices)+1)*N-1 << ".";
+        throw invalid_argument(err.str());        
+    }
+}
+
+/*
+ * Trace of the product A*B. Only the diagonal sub-blocks of A*B that are 
+ * summed over are calculated, i.e., [A*B]_ii = A(i,:)*B(:,i). The full 
+ * product is never formed.
+ *
+ * -----------------------------------------------------------------------------
+ * A --------> m x k matrix.
+ * B --------> k x m matrix.
+ * N --------> Size of the sub-matrix.
+ * vertices -> Index of diagonal matrices that are summed over.
+ * -----------------------------------------------------------------------------
+ */
+template<class T>
+T traceProd(const T &A, const T &B, uint N = 1, const ucol *vertices = 0){
+    if (A.n_cols != B.n_rows){
+        stringstream err;
+        err << "In traceProd(A, B, N): A(" << A.n_rows << "x" << A.n_cols << ") and B(" 
+            << B.n_rows << "x" << B.n_cols << ") cannot be multiplied.";
+        throw invalid_argument(err.str());
+    }
+    uint m = A.n_rows;
+    traceProdCheck(m, B.n_cols, N, vertices);
+    
+    T tr = zeros<T>(N, N);
+    if(vertices == 0){// trace over all elements
+        for(uint i = 0; i < m; i += N){
+            uint j = i+N-1;
+            tr += A.rows(i, j)*B.cols(i, j);
+        }
+    }else{// trace over selective elements
+        const ucol& vert = *vertices;
+        for(uint i = 0; i < vert.n_elem; ++i){
+            uint beg = vert[i]*N;
+            uint end = beg + N - 1;
+            tr += A.rows(beg, end)*B.cols(beg, end);
+        }        
+    }
+    return tr;
+}
+
+/*
+ * Trace of the product A*B*C. Only the rows of A*B and the diagonal 
+ * sub-blocks of A*B*C that are summed over are calculated, i.e., 
+ * [A*B*C]_ii = [A(i,:)*B]*C(:,i).
+ *
+ * -----------------------------------------------------------------------------
+ * A --------> m x k matrix.
+ * B --------> k x l matrix.
+ * C --------> l x m matrix.
+ * N --------> Size of the sub-matrix.
+ * vertices -> Index of diagonal matrices that are summed over.
+ * -----------------------------------------------------------------------------
+ */
+template<class T>
+T traceProd(const T &A, const T &B, const T &C, uint N = 1, const ucol *vertices = 0){
+    if (A.n_cols != B.n_rows || B.n_cols != C.n_rows){
+        stringstream err;
+        err << "In traceProd(A, B, C, N): A(" << A.n_rows << "x" << A.n_cols << "), B(" 
+            << B.n_rows << "x" << B.n_cols << ") and C(" << C.n_rows << "x" 
+            << C.n_cols << ") cannot be multiplied.";
+        throw invalid_argument(err.str());
+    }
+    uint m = A.n_rows;
+    traceProdCheck(m, C.n_cols, N, vertices);
+    
+    T tr = zeros<T>(N, N);
+    if(vertices == 0){// trace over all elements
+        for(uint i = 0; i < m; i += N){
+            uint j = i+N-1;
+            tr += (A.rows(i, j)*B)*C.cols(i, j);
+        }
+    }else{// trace over selective elements
+        const ucol& vert = *vertices;
+        for(uint i = 0; i < vert.n_elem; ++i){
+            uint beg = vert[i]*N;
+            uint end = beg + N - 1;
+            tr += (A.rows(beg, end)*B)*C.cols(beg, end);
+        }        
+    }
+    return tr;
+}
+
 }
 #endif	/* TRACE_HPP */
 
@@ -10,8 +10,10 @@
 
 #include "negf/CohRgfa.h"
 #include "negf/RgfResult.h"
+#include "negf/sectors.h"
 
 #include "utils/ConsoleProgressBar.h"
+#include "utils/Profiler.h"
 #include "utils/std.hpp"
 #include "utils/vout.h"
 #include "utils/serialize.hpp"
@@ -22,7 +24,11 @@
 #include <boost/mpi.hpp>
 #include <boost/serialization/string.hpp>
 #include <boost/serialization/access.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 
+#include <chrono>
+#include <cstdio>
 #include <iterator>
 
 namespace quest{
@@ -61,25 +67,53 @@ public:
     
     void            enableTE(uint N = 1);   
     void            enableI(uint N = 1, uint ib = 0, uint jb = 0);
+    void            enableIMap(uint N = 1); //!< Bond currents between all the neighboring blocks.
     void            enableDOS(uint N = 1);
+    void            enableLDOSMap(); //!< LDOS and electron density of all the orbitals.
     void            enablen(uint N = 1, int ib = -1); //!< Electron density.
     void            enablep(uint N = 1, int ib = -1); //!< Hole density.
     void            atomsTracedOver(shared_ptr<ucol> atomsTracedOver);
+    void            decimate(bool enable = true); //!< Collapse uniform segments.
+    void            banded(bool enable = true); //!< Banded inverse of the diagonal blocks.
+    void            sectors(bool enable = true); //!< Solve independent sectors separately.
+    void            profile(bool enable = true); //!< Time the phases of the run.
+    const Profiler& profiler() const { return mprof; };
+    void            checkpoint(string fileName, double interval = 300); //!< Save the finished points every interval seconds.
+    void            restart(bool enable = true); //!< Skip the points found in the checkpoint.
+    void            addBias(double muD = 0.0, double muS = 0.0); //!< Adds a bias point with the current V.
+    void            clearBias();
+    uint            nbias() const { return mBiasV.size(); };
     
     virtual string  toString() const;
     
     void            run();
     virtual void    save(string fileName, bool isText = true);
+    virtual void    saveBias(uint ibias, string fileName, bool isText = true);
     
 private:
     virtual void    prepare();
+    virtual void    runAll();
+    virtual void    runPoints(bool checkpoint = false);
+    virtual void    runBias();
+    void            setHk(long ik);
+    virtual void    runSectors(const field<uwcol> &sectors);
+    bool            canSplitSectors();
+    vector<cxmat_vec*> localResults();
+    vector<RgfResult*> allResults();
     virtual void    compute();  
     virtual void    collect();
+    virtual void    collectBias();
     virtual void    gather(cxmat_vec &thisR, RgfResult &all);
     
     virtual void    intOverKpoints(RgfResult &integrand);
     
     long            npoints();
+    
+    string          checkpointFile();
+    unsigned long long checkpointHash();
+    void            saveCheckpoint(long myStart, long myEnd, long ndone, 
+                        const vector<size_t> &offsets);
+    long            loadCheckpoint(long myStart, long myEnd);
 
 public:
     
@@ -89,6 +123,12 @@ protected:
     vec                   mE;           //!< Energy grid.
     mat                   mk;           //!< Wave vector.
     bool                  integrateOverKpoints;//!< integrate over k-point?
+    bool                  msplitSectors;//!< solve independent sectors separately?
+    
+    string                mcheckpoint;  //!< Checkpoint file name, empty: no checkpoint.
+    double                mcheckpointInterval; //!< Seconds between two checkpoints.
+    unsigned long long    mcheckpointHash; //!< checkpointHash() of the current run.
+    bool                  mrestart;     //!< Restart from the checkpoint?
     
     shared_ptr<ucol>      matomsTracedOver; //!< A list of atoms on which trace will be performed.
     
@@ -130,11 +170,19 @@ protected:
     // Iop, Current operator for block # i.
     vector<cxmat_vec>    mThisIop;       //!< For local process.
     vector<RgfResult>    mIop;        //!< Collection of all processes.
+
+    // IMapop, Bond currents I_i,i+1 for all the blocks.
+    cxmat_vec            mThisIMap;    //!< For local process.
+    RgfResult            mIMap;        //!< Collection of all processes.
     
     // DOSop: Density of States operator
     cxmat_vec            mThisDOS;     //!< DOS list for local process.
     RgfResult            mDOS;         //!< DOS list for all processes.
 
+    // LDOSMapop: LDOS and electron density of all the orbitals
+    cxmat_vec            mThisLDOSMap; //!< LDOS map list for local process.
+    RgfResult            mLDOSMap;     //!< LDOS map list for all processes.
+
     // Electron density operator
     vector<cxmat_vec>    mThisnOp;     //!< Density list for local process
     vector<RgfResult>    mnOp;         //!< Density list for all processes
@@ -143,8 +191,16 @@ protected:
     vector<cxmat_vec>    mThispOp;     //!< Density list for local process
     vector<RgfResult>    mpOp;         //!< Density list for all processes   
     
+    // Bias sweep
+    vector<field<shared_ptr<vec> > > mBiasV;    //!< Potential of each bias point.
+    vector<double>       mBiasMuD;     //!< Drain Fermi level of each bias point.
+    vector<double>       mBiasMuS;     //!< Source Fermi level of each bias point.
+    vector<vector<cxmat_vec> > mBiasThis; //!< Local results of each bias point.
+    vector<vector<list<cxmat> > > mBiasAll; //!< Results of each bias point.
+    
     // user feedback
     ConsoleProgressBar   mbar;         //!< Shows a nice progress bar.
+    Profiler             mprof;        //!< Time spent in each phase.
     
 };
 }
@@ -11,6 +11,7 @@
 #include "negf/computegs.h"
 
 #include "utils/Printable.hpp"
+#include "utils/Profiler.h"
 #include "utils/myenums.hpp"
 #include "utils/std.hpp"
 #include "utils/vout.h"
@@ -19,6 +20,7 @@
 #include "maths/constants.h"
 #include "maths/trace.hpp"
 #include "maths/fermi.hpp"
+#include "maths/banded.h"
 #include "maths/arma.hpp"
 #include "cache/cache.hpp"
 
@@ -30,8 +32,16 @@ namespace negf{
 
 using std::shared_ptr;
 using maths::trace;
+using maths::traceProd;
+using maths::rcm;
+using maths::bandwidth;
+using maths::nonzeroRows;
+using maths::nonzeroCols;
+using maths::invBanded;
+using maths::invUpdate;
 using cache::CxMatCache;
 using utils::Printable;
+using utils::Profiler;
 using namespace maths::armadillo;
 using namespace maths::constants;
 using namespace utils::stds;
@@ -47,6 +57,26 @@ using namespace utils::stds;
  *          contact              contact
  */
 
+/*
+ * Phases of an RGF run timed by the profiler.
+ */
+enum RgfPhase{
+    RGF_HK = 0,         // H(k) assembly
+    RGF_SURFACE_GF,     // surface Green functions of the contacts
+    RGF_FORWARD,        // forward sweep: glc
+    RGF_BACKWARD,       // backward sweep: grc
+    RGF_TE,             // observables
+    RGF_I,
+    RGF_IMAP,
+    RGF_DOS,
+    RGF_LDOSMAP,
+    RGF_N,
+    RGF_P,
+    RGF_GATHER,         // MPI gather of the results
+    RGF_SAVE,           // saving the results
+    RGF_NPHASES
+};
+
 /**
  * CohRgfa - Coherent RGF algorithm class. 
  * It implements the RGF algorithm for a single energy point.
@@ -122,11 +152,55 @@ protected:
                 mM.set_size(1);
             }
         }
+        // forgets grc_i,i for i <= ib.
+        void invalidate(int ib){
+            if (!mCacheEnabled){
+                reset();
+                return;
+            }
+            int ie = std::min(ib, mEnd);
+            for (int ig = mBegin; ig <= ie; ++ig){
+                getAt(ig).reset();
+            }
+            // continue from the first stored block on the right.
+            if (mIt <= ie){
+                mIt = ie + 1;
+                while (mIt <= mEnd && !isStored(mIt)){
+                    ++mIt;
+                }
+            }
+        }
         const cxmat& operator ()(int ib);
     protected:
         inline void computegrc(cxmat& grci, const cxmat& grcip1, int ib);    
     }; // end of grc
 
+/*
+ * Isolated segment of identical blocks used by the decimation:
+ * g11, g1L, gL1 and gLL are the corner blocks of its Green function.
+ */
+    struct Segment{
+        cxmat g11;
+        cxmat g1L;
+        cxmat gL1;
+        cxmat gLL;
+    }; // end of Segment
+
+/*
+ * Band structure of a diagonal block used by the banded inverse: D_i,i(p,p)
+ * has kb sub and super diagonals. The left (right) self energy is non-zero
+ * only on the orbitals PL (PR) coupled to block i-1 (i+1).
+ */
+    struct BlockBand{
+        uwcol p;
+        uword kb;
+        uwcol PL;
+        uwcol PR;
+        bool  useL;  // banded inverse for glc_i,i?
+        bool  useR;  // banded inverse for grc_i,i?
+        BlockBand():kb(0), useL(false), useR(false){};
+    }; // end of BlockBand
+
 /*
  * Left connected Green function:
  * class glc
@@ -135,6 +209,20 @@ protected:
     public:
         glc(CohRgfa *negf, int begin, int end, bool cache = true):
             NegfMatCache(negf, begin, end, cache){};
+        // forgets glc_i,i for i >= ib.
+        void invalidate(int ib){
+            if (!mCacheEnabled){
+                reset();
+                return;
+            }
+            int is = std::max(ib, mBegin);
+            for (int ig = is; ig <= mEnd; ++ig){
+                getAt(ig).reset();
+            }
+            if (mIt >= is){
+                mIt = is - 1;
+            }
+        }
         const cxmat& operator ()(int ib);
     protected:
         inline void computeglc(cxmat& glci, const cxmat& glcim1, int ib);    
@@ -228,14 +316,23 @@ public:
     void        H(const field<shared_ptr<cxmat> > &H0, const field<shared_ptr<cxmat> > &Hl);
     void        S(const field<shared_ptr<cxmat> > &S0, const field<shared_ptr<cxmat> > &Sl);
     void        V(const field<shared_ptr<vec> >  &V);   
+    void        updateV(const field<shared_ptr<vec> > &V); //!< Keeps the blocks not affected by the change.
+    void        surfaceGCache(bool enable = true); //!< Reuse the surface GFs of the contacts at the same E+V.
+    void        decimate(bool enable = true); //!< Collapse uniform segments by decimation.
+    bool        decimate() { return mdecimate; };
+    void        banded(bool enable = true); //!< Banded inverse of the diagonal blocks.
+    bool        banded() { return mbanded; };
+    void        profiler(Profiler *prof) { mprof = prof; }; //!< Phases are added by the owner.
     
     virtual string toString() const;
     
     cxmat       pOp(uint N = 1, int ib = -1, ucol *atomsTracedOver = 0); //!< hole density.
     cxmat       nOp(uint N = 1, int ib = -1, ucol *atomsTracedOver = 0); //!< electron density.
     cxmat       DOSop(uint N = 1, ucol *atomsTracedOver = 0); //!< density of states.
+    cxmat       LDOSMapop(); //!< local density of states and electron density of all the orbitals.
     cxmat       Aop(uint N = 1, uint ib = 1, ucol *atomsTracedOver = 0); //!< spectral function.    
     cxmat       Iop(uint N = 1, uint ib = 0, uint jb = 0, ucol *atomsTracedOver = 0); //!< Generic current operators: current from block i to block j.
+    cxmat       IMapop(uint N = 1, ucol *atomsTracedOver = 0); //!< Bond currents I_i,i+1 for all the blocks.
     cxmat       TEop(uint N = 1, ucol *atomsTracedOver = 0); //!< Transmission operator
     
     
@@ -250,13 +347,28 @@ protected:
     inline const cxmat&   GamL11();
     inline const cxmat&   GamRNN();
     
-    inline cxmat Iijop(uint ib, uint jb); //!< Current from block i to block j.
-    inline cxmat INop(); //!< Current injected from terminal # N to device.
-    inline cxmat I0op(); //!< Current injected from terminal # 0 to device.
+    inline cxmat Iijop(uint N, uint ib, uint jb, ucol *atomsTracedOver); //!< Current from block i to block j.
+    inline cxmat INop(uint N, ucol *atomsTracedOver); //!< Current injected from terminal # N to device.
+    inline cxmat I0op(uint N, ucol *atomsTracedOver); //!< Current injected from terminal # 0 to device.
 
     inline cxmat Gn(uint ib, uint jb); //!< Correlation function.
+    inline cxmat trGn(uint N, uint ib, ucol *atomsTracedOver); //!< Trace of Gn_i,i.
     inline const cxmat& G(uint ib, uint jb); //!< Retarded green function.
     
+ 
+    inline bool  decimategrc(cxmat& grci, const cxmat& grcip1, int is, int ie);
+    inline bool  joinSegments(Segment& XY, const Segment& X, const Segment& Y, const cxmat& T);
+    inline bool  invWellCond(cxmat& Ainv, const cxmat& A);
+    inline int   uniformRunStart(int ib);
+    void         findUniformRuns();
+    
+    typedef map<long long, cxmat> SurfGCache;
+    inline bool  findSurfG(cxmat& gs, const SurfGCache& cache, double EV);
+    inline void  keepSurfG(SurfGCache& cache, double EV, const cxmat& gs);
+    
+    inline void  invDiSig(cxmat& gi, int ib, bool left);
+    void         findBands();
+    
     inline void  reset();
         
 private:
@@ -281,6 +393,24 @@ private:
     uint                miRc;    // index of right contact block
     
     static constexpr double SurfGTolX = 1E-8;
+    static constexpr int MinDecimationRun = 4; // shortest segment worth decimating
+    static constexpr double MinDecimationRcond = 1E-10; // fall back to RGF below this rcond
+    
+    bool                mdecimate;    // collapse uniform segments?
+    bool                mRunsFound;   // are mRunStart up to date with H, S and V?
+    vector<int>         mRunStart;    // first block of the uniform segment ending at block i
+    
+    bool                mbanded;      // banded inverse of the diagonal blocks?
+    bool                mBandsFound;  // are mBands up to date with H and S?
+    vector<BlockBand>   mBands;       // band structure of the diagonal blocks
+    
+    Profiler           *mprof;        // times the sweeps and the surface GFs, may be null
+    
+    static constexpr double SurfGKeyTol = 1E-10; // E+V closer than this share a surface GF
+    static constexpr int MaxSurfGCache = 4096;   // surface GFs kept per contact
+    bool                mcacheSurfG;  // keep the surface GFs of the contacts?
+    SurfGCache          mgsL;         // surface GF of the left contact keyed by E+V
+    SurfGCache          mgsR;         // surface GF of the right contact keyed by E+V
     
     // Hamiltonian , overlap and potential
     field<shared_ptr<cxmat> >mH0;// Diagonal blocks of Hamiltonian: H0(i) = [H]_i,i
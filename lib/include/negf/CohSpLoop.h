@@ -0,0 +1,104 @@
+/*
+ * File:   CohSpLoop.h
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 11:40 AM
+ */
+
+#ifndef COHSPLOOP_H
+#define	COHSPLOOP_H
+
+#include "negf/CohSpNegf.h"
+#include "negf/RgfResult.h"
+
+#include "utils/ConsoleProgressBar.h"
+#include "utils/std.hpp"
+#include "utils/vout.h"
+#include "utils/serialize.hpp"
+#include "parallel/Workers.h"
+
+#include <boost/mpi.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/access.hpp>
+
+namespace quest{
+namespace negf{
+
+using namespace utils::stds;
+using namespace quest::parallel;
+namespace mpi = boost::mpi;
+
+/*
+ * Energy loop of the sparse NEGF solver. The results are saved the
+ * same way as CohRgfLoop. The lead indices take the place of the
+ * block indices.
+ * Compared to CohRgfLoop, the following are not supported yet: results
+ * resolved by orbital (N > 1) or traced over a subset of atoms, the 
+ * k-point loop, the bond currents (IMap) and the LDOS map.
+ */
+class CohSpLoop: public Printable{
+    typedef vector<cxmat> cxmat_vec;
+public:
+    CohSpLoop(const Workers &workers, double kT = 0.0259,
+        dcmplx ieta = dcmplx(0,1E-3), bool orthogonal = true,
+        string newprefix = "");
+
+    void            E(const vec &E);
+    void            mu(uint ip, double mu);
+
+    // Hamiltonian, overlap, potential and leads
+    void            H(shared_ptr<sp_cx_mat> H);
+    void            S(shared_ptr<sp_cx_mat> S);
+    void            V(shared_ptr<vec> V);
+    uint            addLead(shared_ptr<cxmat> H0, shared_ptr<cxmat> H01,
+                        shared_ptr<cxmat> Hc, shared_ptr<uwcol> orbs, double VL = 0.0,
+                        shared_ptr<cxmat> S0 = shared_ptr<cxmat>(),
+                        shared_ptr<cxmat> S01 = shared_ptr<cxmat>(),
+                        shared_ptr<cxmat> Sc = shared_ptr<cxmat>());
+
+    void            enableTE(uint ip = 0, uint iq = 1); //!< Transmission from lead ip to iq.
+    void            enableI(uint ip = 0);               //!< Terminal current of lead ip.
+    void            enableDOS();
+    void            enablen();                          //!< Electron density.
+    void            enablep();                          //!< Hole density.
+
+    virtual string  toString() const;
+
+    void            run();
+    virtual void    save(string fileName, bool isText = true);
+
+private:
+    virtual void    prepare();
+    virtual void    compute();
+    virtual void    collect();
+    virtual void    gather(cxmat_vec &thisR, RgfResult &all);
+
+protected:
+    const Workers         &mWorkers;    //!< MPI worker processes.
+    CohSpNegf             mnegf;        //!< Sparse Negf calculator.
+    vec                   mE;           //!< Energy grid.
+
+    // --- Results ---
+    vector<cxmat_vec>    mThisTE;      //!< Transmission list for local process.
+    vector<RgfResult>    mTE;          //!< Transmission list for all processes.
+
+    vector<cxmat_vec>    mThisIop;     //!< Current list for local process.
+    vector<RgfResult>    mIop;         //!< Current list for all processes.
+
+    cxmat_vec            mThisDOS;     //!< DOS list for local process.
+    RgfResult            mDOS;         //!< DOS list for all processes.
+
+    cxmat_vec            mThisnOp;     //!< Density list for local process
+    RgfResult            mnOp;         //!< Density list for all processes
+
+    cxmat_vec            mThispOp;     //!< Density list for local process
+    RgfResult            mpOp;         //!< Density list for all processes
+
+    // user feedback
+    ConsoleProgressBar   mbar;         //!< Shows a nice progress bar.
+};
+
+}
+}
+#endif	/* COHSPLOOP_H */
+
@@ -0,0 +1,127 @@
+/*
+ * File:   CohSpNegf.h
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 10:12 AM
+ */
+
+#ifndef COHSPNEGF_H
+#define	COHSPNEGF_H
+
+#include "negf/computegs.h"
+
+#include "utils/Printable.hpp"
+#include "utils/std.hpp"
+#include "utils/vout.h"
+#include "maths/constants.h"
+#include "maths/fermi.hpp"
+#include "maths/arma.hpp"
+
+namespace quest{
+namespace negf{
+
+using std::shared_ptr;
+using utils::Printable;
+using namespace maths::armadillo;
+using namespace maths::constants;
+using namespace utils::stds;
+
+/*
+ * Device geometry:
+ *
+ *        lead 0                      lead 2
+ *    ... |-1 | 0 |               | 0 |-1 | ...
+ *              ^ \   --------   / ^
+ *                 \_| Device |_/
+ *                   |        |
+ *                    --------
+ *                       |
+ *                     | 0 | lead 1
+ *                     |-1 |
+ *                      ...
+ *
+ * The device is a sparse matrix of any shape. Each lead is a semi-infinite
+ * chain of principal layers attached to a few orbitals of the device.
+ */
+
+/**
+ * CohSpNegf - Coherent NEGF with a sparse device Hamiltonian.
+ * It solves a single energy point. E*S - H - U - Sigma is factored once
+ * and only the columns of G connected to the leads are computed.
+ * In coherent transport, these columns are all we need:
+ * A = sum_p G*Gam_p*G' and Gn = sum_p f_p*G*Gam_p*G'.
+ */
+class CohSpNegf: public Printable {
+protected:
+    /*
+     * Semi-infinite lead attached to the device.
+     */
+    struct Lead{
+        shared_ptr<cxmat>   H0;     //!< Hamiltonian of a principal layer.
+        shared_ptr<cxmat>   H01;    //!< Hopping from the surface layer to the next one away from the device.
+        shared_ptr<cxmat>   Hc;     //!< Hopping from the device orbitals to the surface layer.
+        shared_ptr<cxmat>   S0;     //!< Overlap of a principal layer.
+        shared_ptr<cxmat>   S01;    //!< Overlap between the surface layer and the next one.
+        shared_ptr<cxmat>   Sc;     //!< Overlap between the device orbitals and the surface layer.
+        shared_ptr<uwcol>   orbs;   //!< Device orbitals coupled to the lead.
+        double              V;      //!< Electrostatic potential of the lead.
+        double              mu;     //!< Chemical potential of the lead.
+        uwcol               cols;   //!< Columns of mGc belonging to this lead.
+        cxmat               Sig;    //!< Self energy on the orbitals orbs.
+        cxmat               Gam;    //!< Broadening on the orbitals orbs.
+    };
+
+public:
+    CohSpNegf(double kT = 0.0259, dcmplx ieta = dcmplx(0,1E-3),
+        bool orthogonal = true, string newprefix = "");
+
+    // Device Hamiltonian, overlap and potential
+    void    H(shared_ptr<sp_cx_mat> H);
+    void    S(shared_ptr<sp_cx_mat> S);
+    void    V(shared_ptr<vec> V);
+    uint    addLead(shared_ptr<cxmat> H0, shared_ptr<cxmat> H01,
+                shared_ptr<cxmat> Hc, shared_ptr<uwcol> orbs, double VL = 0.0,
+                shared_ptr<cxmat> S0 = shared_ptr<cxmat>(),
+                shared_ptr<cxmat> S01 = shared_ptr<cxmat>(),
+                shared_ptr<cxmat> Sc = shared_ptr<cxmat>());
+    void    mu(uint ip, double mu);
+    void    E(double E);
+
+    uint    nLeads() const { return mLeads.size(); };
+    uint    no() const { return mH ? mH->n_rows : 0; }; //!< Number of device orbitals.
+
+    // Observables
+    cxmat   TEop(uint ip, uint iq); //!< Transmission from lead ip to lead iq.
+    cxmat   Iop(uint ip);           //!< Terminal current of lead ip.
+    cxmat   DOSop();                //!< Density of states.
+    cxmat   nOp();                  //!< Electron density.
+    cxmat   pOp();                  //!< Hole density.
+
+    virtual string toString() const;
+
+protected:
+    void    solve();
+    void    computeSigma(Lead &lead);
+    cxmat   trGGamG(uint ip);
+
+protected:
+    double      mkT;        //!< Temperature in eV.
+    dcmplx      mieta;      //!< Contact broadening parameter.
+    bool        morthogonal;//!< Orthogonal basis?
+    double      mE;         //!< Energy.
+    bool        msolved;    //!< Are the lead columns of G up to date?
+
+    shared_ptr<sp_cx_mat> mH; //!< Device Hamiltonian.
+    shared_ptr<sp_cx_mat> mS; //!< Device overlap matrix.
+    shared_ptr<vec>       mV; //!< Electrostatic potential of the device orbitals.
+    vector<Lead>          mLeads; //!< All the leads.
+
+    cxmat       mGc;        //!< Columns of G on the lead orbitals, one lead after another.
+
+    static constexpr double SurfGTolX = 1E-8;  //!< Tolerance for surface Green function.
+};
+
+}
+}
+#endif	/* COHSPNEGF_H */
+
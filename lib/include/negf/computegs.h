@@ -35,13 +35,14 @@ using namespace maths::constants;
  * TolX ------> convergence tolerance factor
  * gs --------> surface green function (by default gs = gR; for gs = gL 
  *              send Tij dagar)
+ * niter -----> Output (optional): number of iterations
  * returns ---> false if not converged in 500 iteration
  *====================================================================
  */
 
 
 bool computegs(cxmat& gs, double E, const cxmat& Hii, const cxmat& Sii, 
-        const cxmat& Tij, dcmplx ieta, double TolX);
+        const cxmat& Tij, dcmplx ieta, double TolX, int *niter = 0);
 }
 }
 #endif	/* COMPUTEGS_H */
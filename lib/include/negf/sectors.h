@@ -0,0 +1,44 @@
+/* 
+ * File:   sectors.h
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 10:12 AM
+ */
+
+#ifndef SECTORS_H
+#define	SECTORS_H
+
+#include "maths/arma.hpp"
+#include "utils/std.hpp"
+
+namespace quest{
+namespace negf{
+
+using std::shared_ptr;
+using namespace maths::armadillo;
+using namespace utils::stds;
+
+/** 
+ * This function finds the independent sectors of a block tridiagonal 
+ * Hamiltonian, i.e., the groups of orbitals that are not coupled to each 
+ * other by any of the H0, Hl, S0 and Sl blocks. Under the permutation that 
+ * puts the orbitals of a sector next to each other, all the blocks become 
+ * block diagonal and each sector can be solved separately.
+ *======================================================================
+ * H0, S0 ----> diagonal blocks, nb x number of neighbors. S0 and Sl are
+ *              skipped if not set.
+ * Hl, Sl ----> lower diagonal blocks, nb+1 x number of neighbors.
+ * tol -------> matrix elements smaller than tol are treated as zero.
+ * returns ---> orbital indices of sector is in block ib: sectors(is, ib).
+ *              Sectors that do not have orbitals in all the blocks are 
+ *              merged to the first complete sector. 
+ *====================================================================
+ */
+field<uwcol> findSectors(const field<shared_ptr<cxmat> > &H0, 
+        const field<shared_ptr<cxmat> > &Hl, const field<shared_ptr<cxmat> > &S0, 
+        const field<shared_ptr<cxmat> > &Sl, double tol = 1E-12);
+
+}
+}
+#endif	/* SECTORS_H */
+
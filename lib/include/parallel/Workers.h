@@ -33,6 +33,7 @@ public:
     bool    IAmMaster()     const { return mIAmMaster; };
     
     void    assignCpus(long &myStart, long &myEnd, long &myN, long N) const;
+    void    barrier()       const { mWorkers.barrier(); }; //!< Waits for all the workers.
     
     const communicator& Comm() const {return mWorkers; };
     
@@ -19,6 +19,7 @@
 
 #include "potential/terminal.h"
 #include "potential/potential.h"
+#include "utils/parallel.h"
 #include "utils/vout.h"
 
 #include <vector>
@@ -46,6 +47,8 @@ struct LinearRegion4:public Terminal4{
             double Vl = 0, double Vr = 0, double Vt = 0, double Vb = 0,
             const string &prefix = "");
     
+    //!< Linearly interpolated potential at (x, y) inside the region.
+    double V(double x, double y) const;
     virtual string toString() const;
 };
 
@@ -58,6 +61,7 @@ typedef LinearRegion4 linear_region;
 class LinearPot:public Potential{
 protected:
     vector<linear_region> mlr; // linear voltage region
+    uint                  mnthreads; //!< Threads used by compute(), 0: all.
     
 public:
     LinearPot(AtomicStruct::ptr atoms = AtomicStruct::ptr(), const string &prefix = "");
@@ -69,6 +73,8 @@ public:
     virtual double  getPotAt(double x, double y);
     
     uint NLR() const { return mlr.size(); };
+    void nthreads(uint nthreads) { mnthreads = nthreads; };
+    uint nthreads() const { return mnthreads; };
     virtual string  toString() const;
     virtual void    exportSvg(const string &path);
 
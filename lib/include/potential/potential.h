@@ -14,6 +14,7 @@
 #include "maths/svec.h"
 
 #include "atoms/AtomicStruct.h"
+#include "atoms/AtomicStructView.h"
 
 #include "utils/std.hpp"
 #include "utils/stringutils.h"
@@ -42,6 +43,8 @@ protected:
     vector<contact>     md;     //!< Drain contact.
     vector<gate>        mg;     //!< Gates.  
     AtomicStruct::ptr   ma;     //!< Atomistic geometry of the device.
+    ucol                morb0;  //!< First orbital of each atom and the total, na+1 entries.
+    ucol                morbAtom; //!< Atom of each orbital.
     
 public:
     //<!< Constructs potential using the atomistic grid.
@@ -49,6 +52,13 @@ public:
     //!< Convert atomic potential to orbital potential.
     shared_ptr<vec> toOrbPot(span s = span::all);
     vec toOrbPot(uint start, uint end);
+    //!< Orbital potential of atoms s into V, V is resized only if needed.
+    void toOrbPot(vec &V, span s = span::all) const;
+    //!< Orbital potential of consecutive blocks of nab(ib) atoms each. The
+    //!< blocks of V are allocated only if they are null or of wrong size.
+    void toOrbPot(field<shared_ptr<vec> > &V, const ucol &nab) const;
+    //!< Number of orbitals of atoms s.
+    uint NumOfOrbitals(span s = span::all) const;
     // The following two methods will be deprecated in the future.
     double Vatom(uint ia);
     void Vatom(uint ia, double V);
@@ -52,16 +52,25 @@
 
 #include "atoms/Lattice.h"
 #include "atoms/AtomicStruct.h"
+#include "atoms/AtomicStructView.h"
+#include "atoms/Supercell.h"
+#include "atoms/GeomFile.h"
+#include "atoms/AtomIndex.h"
 
 #include "parallel/Workers.h"
 
 #include "kpoints/KPoints.h"
 
 #include "hamiltonian/hamiltonian.hpp"
+#include "hamiltonian/partition.hpp"
+#include "hamiltonian/bonds.h"
+#include "hamiltonian/pargen.h"
+#include "hamiltonian/hamcache.h"
 #include "hamiltonian/tb/graphenetb.h"
 #include "hamiltonian/kp/graphenekp.h"
 #include "hamiltonian/kp/tikp.h"
 #include "hamiltonian/kp/tikp4.h"
+#include "hamiltonian/kp/kpstencil.h"
 
 #include "potential/terminal.h"
 #include "potential/potential.h"
@@ -72,6 +81,8 @@
 #include "negf/computegs.h"
 #include "negf/CohRgfa.h"
 #include "negf/CohRgfLoop.h"
+#include "negf/CohSpNegf.h"
+#include "negf/CohSpLoop.h"
 
 #include "tmfsc/device.h"
 #include "tmfsc/simulator.h"
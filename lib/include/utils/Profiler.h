@@ -0,0 +1,108 @@
+/*
+ * File:   Profiler.h
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 6:30 PM
+ */
+
+#ifndef PROFILER_H
+#define	PROFILER_H
+
+#include "utils/Printable.hpp"
+#include "utils/std.hpp"
+
+#include <boost/mpi.hpp>
+#include <chrono>
+
+namespace utils{
+using namespace stds;
+
+/**
+ * Per-phase profiler. Keeps the wall time, number of calls and a free
+ * counter (e.g., iterations) of each phase. Phases can be nested: the time
+ * of a phase excludes the time spent in the phases started inside it.
+ * A disabled profiler costs one branch per call.
+ */
+class Profiler: public Printable{
+    typedef std::chrono::steady_clock clock;
+public:
+    /*
+     * Starts a phase on construction and stops it on destruction.
+     */
+    class Scope{
+    public:
+        Scope(Profiler *prof, uint phase):mprof(prof), mphase(phase){
+            if (mprof){
+                mprof->start(mphase);
+            }
+        };
+        // A destructor must not throw, e.g., while unwinding an exception
+        // thrown inside the phase. A mismatched phase is then ignored.
+        ~Scope(){
+            if (mprof){
+                try{
+                    mprof->stop(mphase);
+                }catch(...){
+                }
+            }
+        };
+    private:
+        Profiler *mprof;
+        uint      mphase;
+    };
+
+public:
+    Profiler(const string &prefix = "");
+
+    uint    addPhase(const string &name); //!< Returns the index of the new phase.
+    void    enable(bool enable = true);
+    bool    enabled() const { return menabled; };
+    void    reset();
+
+    void    start(uint phase);
+    void    stop(uint phase);
+    void    count(uint phase, long n){ if (menabled) { mcounts[phase] += n; } };
+
+    void    reduce(const boost::mpi::communicator &comm, int root = 0); //!< Aggregates all ranks on root.
+
+    uint    nphases() const { return mnames.size(); };
+    string  name(uint phase) const { return mnames[phase]; };
+    double  time(uint phase) const { return mtimes[phase]; }; //!< Time of this rank in s.
+    long    calls(uint phase) const;    //!< Number of calls, all ranks after reduce().
+    long    counts(uint phase) const;   //!< Counter, all ranks after reduce().
+    double  minTime(uint phase) const;  //!< Fastest rank after reduce().
+    double  avgTime(uint phase) const;  //!< Average over the ranks after reduce().
+    double  maxTime(uint phase) const;  //!< Slowest rank after reduce().
+
+    virtual string toString() const;
+
+protected:
+    /*
+     * A running phase.
+     */
+    struct Frame{
+        uint              phase;
+        clock::time_point t0;
+        double            inner; // time spent in the phases started inside.
+    };
+
+    bool            menabled;
+    vector<string>  mnames;
+    vector<double>  mtimes;
+    vector<long>    mcalls;
+    vector<long>    mcounts;
+    vector<Frame>   mstack;
+
+    // after reduce()
+    int             mnranks;
+    vector<double>  mminTimes;
+    vector<double>  mavgTimes;
+    vector<double>  mmaxTimes;
+    vector<long>    mtotCalls;
+    vector<long>    mtotCounts;
+};
+
+}
+
+#endif	/* PROFILER_H */
+
@@ -0,0 +1,32 @@
+/*
+ * File:   atomicfile.h
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 9:40 PM
+ *
+ * Description: Binary files that are replaced in one step.
+ *
+ */
+
+#ifndef ATOMICFILE_H
+#define	ATOMICFILE_H
+
+#include "utils/std.hpp"
+
+#include <fstream>
+#include <functional>
+
+namespace utils{
+
+//!< Writes fileName with write(). The data goes to fileName.tmp first, which
+//!< is renamed to fileName once it is complete, so that readers and restarts
+//!< never see a partial file. The temporary file is removed if write() throws.
+//!< where is the Class::method() used in the error messages.
+void writeAtomically(const stds::string &fileName, 
+        const std::function<void(stds::ofstream&)> &write, 
+        const stds::string &where);
+
+}
+
+#endif	/* ATOMICFILE_H */
+
@@ -0,0 +1,32 @@
+/*
+ * File:   parallel.h
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 20, 2026, 1:05 AM
+ *
+ * Description: Shared memory parallel loops.
+ *
+ */
+
+#ifndef PARALLEL_H
+#define	PARALLEL_H
+
+#include "utils/std.hpp"
+
+#include <functional>
+
+namespace utils{
+
+//!< Number of threads to use: nthreads, or all the hardware threads if 0.
+uint numThreads(uint nthreads);
+
+//!< Runs work(0) ... work(n-1) on nthreads threads. Each thread takes the
+//!< next index until all are done. The first exception, in index order, is
+//!< rethrown once all the threads are done.
+void parallelFor(uint n, uint nthreads, 
+        const std::function<void(uint)> &work);
+
+}
+
+#endif	/* PARALLEL_H */
+
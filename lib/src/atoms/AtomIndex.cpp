@@ -0,0 +1,89 @@
+/*
+ * File:   AtomIndex.cpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 20, 2026, 12:40 AM
+ */
+
+#include "atoms/AtomIndex.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace quest{
+namespace atoms{
+
+namespace bg = boost::geometry;
+namespace bgi = boost::geometry::index;
+using maths::geometry::point;
+using maths::geometry::stwithin;
+
+// sorted indices of the entries
+static ucol indices(vector<AtomIndex::entry> &found){
+    ucol ind(found.size());
+    for (uint i = 0; i < found.size(); ++i){
+        ind(i) = found[i].second;
+    }
+    std::sort(ind.begin(), ind.end());
+    return ind;
+}
+
+/*
+ * The packing constructor of the rtree bulk loads all the atoms at once.
+ */
+static vector<AtomIndex::entry> entries(const AtomicStructView &atoms){
+    vector<AtomIndex::entry> all;
+    all.reserve(atoms.NumOfAtoms());
+    for (int ia = 0; ia < atoms.NumOfAtoms(); ++ia){
+        all.push_back(AtomIndex::entry(AtomIndex::point3(atoms.X(ia), 
+                atoms.Y(ia), atoms.Z(ia)), ia));
+    }
+    return all;
+}
+
+AtomIndex::AtomIndex(const AtomicStructView &atoms): mtree(entries(atoms)){
+}
+
+ucol AtomIndex::inBox(const double lo[3], const double hi[3]) const{
+    box3 b(point3(lo[0], lo[1], lo[2]), point3(hi[0], hi[1], hi[2]));
+    vector<entry> found;
+    mtree.query(bgi::covered_by(b), std::back_inserter(found));
+    return indices(found);
+}
+
+ucol AtomIndex::inPolygon(const polygon &p) const{
+    maths::geometry::box env = bg::return_envelope<maths::geometry::box>(p);
+    double inf = std::numeric_limits<double>::max();
+    box3 b(point3(env.min_corner().get<0>(), env.min_corner().get<1>(), -inf),
+           point3(env.max_corner().get<0>(), env.max_corner().get<1>(), inf));
+    
+    vector<entry> found;
+    mtree.query(bgi::covered_by(b) && bgi::satisfies([&p](const entry &e){
+        return bg::within(point(e.first.get<0>(), e.first.get<1>()), p, 
+                stwithin());
+    }), std::back_inserter(found));
+    return indices(found);
+}
+
+ucol AtomIndex::inSphere(const double c[3], double r) const{
+    point3 pc(c[0], c[1], c[2]);
+    box3 b(point3(c[0] - r, c[1] - r, c[2] - r), 
+           point3(c[0] + r, c[1] + r, c[2] + r));
+    
+    vector<entry> found;
+    mtree.query(bgi::covered_by(b) && bgi::satisfies([&pc, r](const entry &e){
+        return bg::comparable_distance(e.first, pc) <= r*r;
+    }), std::back_inserter(found));
+    return indices(found);
+}
+
+ucol AtomIndex::nearest(const double c[3], uint k) const{
+    vector<entry> found;
+    mtree.query(bgi::nearest(point3(c[0], c[1], c[2]), k), 
+            std::back_inserter(found));
+    return indices(found);
+}
+
+}
+}
+
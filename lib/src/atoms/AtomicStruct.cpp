@@ -10,6 +10,9 @@
  */
 
 #include "atoms/AtomicStruct.h"
+#include "atoms/GeomFile.h"
+#include "atoms/AtomIndex.h"
+#include "atoms/Supercell.h"
 
 namespace quest{
 namespace atoms{
@@ -24,7 +27,8 @@ AtomicStruct::AtomicStruct(const AtomicStruct& orig):
 mpt(orig.mpt),
 mia(orig.mia),
 mXyz(orig.mXyz),
-mlv(orig.mlv)
+mlv(orig.mlv),
+msindex(orig.msindex)
 {
     mNa = orig.mNa;
     mNo = orig.mNo;
@@ -91,6 +95,7 @@ const ptable& periodicTable):mpt(periodicTable){
 
 /* initializer */
 void AtomicStruct::init(){
+    msindex.reset();
     mNa = 0;
     mNo = 0;
     mNe = 0;
@@ -118,6 +123,7 @@ void swap(AtomicStruct& first, AtomicStruct& second){
     swap(first.mNe, second.mNe);
     swap(first.mNo, second.mNo);
     swap(first.mpt, second.mpt);
+    swap(first.msindex, second.msindex);
     
     /* The swap function in armadillo probably has a bug
      * that prevents swapping a zero sized matrix
@@ -140,10 +146,22 @@ AtomicStruct operator+ (AtomicStruct atmi, const AtomicStruct& atmj){
 AtomicStruct& AtomicStruct::operator+= (const AtomicStruct& atj){
     // update our periodic table
     mpt.update(atj.mpt);
-    
-    // concatenate the atom id's and coordinates
-    mia.insert_rows(mNa,atj.mia);
-    mXyz.insert_rows(mNa,atj.mXyz);
+    msindex.reset();
+    
+    // concatenate the atom id's and coordinates: one new allocation, both
+    // parts copied into it.
+    if (atj.mNa > 0){
+        icol ia(mNa + atj.mNa);
+        mat xyz(mNa + atj.mNa, 3);
+        if (mNa > 0){
+            ia.rows(0, mNa - 1) = mia;
+            xyz.rows(0, mNa - 1) = mXyz;
+        }
+        ia.rows(mNa, mNa + atj.mNa - 1) = atj.mia;
+        xyz.rows(mNa, mNa + atj.mNa - 1) = atj.mXyz;
+        mia.swap(ia);
+        mXyz.swap(xyz);
+    }
     
     // add the lattice vectors
     mlv += atj.mlv;
@@ -156,6 +174,35 @@ AtomicStruct& AtomicStruct::operator+= (const AtomicStruct& atj){
     return *this;
 }
 
+/* 
+ * Concatenation of many structures at once: same as adding them one by one
+ * but the storage is allocated only once.
+ */
+AtomicStruct concat(const vector<AtomicStruct> &parts){
+    AtomicStruct all;
+    int na = 0;
+    for (uint ip = 0; ip < parts.size(); ++ip){
+        na += parts[ip].mNa;
+    }
+    all.mia.set_size(na);
+    all.mXyz.set_size(na, 3);
+    
+    for (uint ip = 0; ip < parts.size(); ++ip){
+        const AtomicStruct &atj = parts[ip];
+        all.mpt.update(atj.mpt);
+        if (atj.mNa > 0){
+            all.mia.rows(all.mNa, all.mNa + atj.mNa - 1) = atj.mia;
+            all.mXyz.rows(all.mNa, all.mNa + atj.mNa - 1) = atj.mXyz;
+        }
+        all.mlv += atj.mlv;
+        all.mNa += atj.mNa;
+        all.mNo += atj.mNo;
+        all.mNe += atj.mNe;
+    }
+    
+    return all;
+}
+
 /* Atoms - Lattice coordinate*/
 AtomicStruct operator- (AtomicStruct atm, const lcoord& lc){
     atm -= lc;
@@ -181,6 +228,7 @@ AtomicStruct operator- (AtomicStruct atm, const svec& r){
 /* Atoms -= position vector */
 AtomicStruct& AtomicStruct::operator-= (const svec& rvec){
     
+    msindex.reset();
     mXyz.col(coord::X) -= rvec(coord::X);
     mXyz.col(coord::Y) -= rvec(coord::Y);
     mXyz.col(coord::Z) -= rvec(coord::Z);
@@ -213,6 +261,7 @@ AtomicStruct operator+ (AtomicStruct atm, const svec& r){
 /* Atoms += position vector */
 AtomicStruct& AtomicStruct::operator+= (const svec& rvec){
     
+    msindex.reset();
     mXyz.col(coord::X) += rvec(coord::X);
     mXyz.col(coord::Y) += rvec(coord::Y);
     mXyz.col(coord::Z) += rvec(coord::Z);
@@ -309,6 +358,10 @@ void AtomicStruct::importGjf(const string& gjfFileName){
     // reset values
     init();
     
+    // coordinates are collected first and copied once at the end
+    vector<int> ids;
+    vector<double> xyz;
+    
     bool inHeader = true;
     while(gjf.good()){
         getline(gjf, line);
@@ -329,12 +382,10 @@ void AtomicStruct::importGjf(const string& gjfFileName){
             ind = mpt.find(sym);
             if (ind > -1){
                 
-                mia.resize(mNa+1);
-                mia(mNa) =  ind;
-                
-                row r(3);
-                r << x << y << z;
-                mXyz.insert_rows(mXyz.n_rows,r);
+                ids.push_back(ind);
+                xyz.push_back(x);
+                xyz.push_back(y);
+                xyz.push_back(z);
                 
                 mNo += mpt[ind].no;
                 mNe += mpt[ind].ne;
@@ -355,6 +406,9 @@ void AtomicStruct::importGjf(const string& gjfFileName){
         
         throw runtime_error(" No atoms found in " + gjfFileName + ".");;
     }
+    
+    mia = conv_to<icol>::from(ids);
+    mXyz = trans(mat(xyz.data(), 3, mNa));
 }
 
 void AtomicStruct::exportGjf(const string& gjfFileName){
@@ -390,6 +444,14 @@ void AtomicStruct::exportGjf(const string& gjfFileName){
     gjf.close();
 }
 
+void AtomicStruct::importGeom(const string& geomFileName){
+    *this = GeomFile(geomFileName).toStruct();
+}
+
+void AtomicStruct::exportGeom(const string& geomFileName) const{
+    GeomFile::write(geomFileName, *this);
+}
+
 void AtomicStruct::genRectLattAtoms(uint nl, uint nw, double ax, double ay, 
         const ptable &periodicTable){
     
@@ -404,6 +466,7 @@ void AtomicStruct::genRectLattAtoms(uint nl, uint nw, double ax, double ay,
     meshgrid(X, Y, -l/2, l/2, ax, -w/2, w/2, ay);
     
     // calculate x, y and z coordinates of the atoms
+    msindex.reset();
     mNa = X.n_rows;            // total number of atoms
     mXyz.set_size(mNa, 3);            // xyz coordinate of atoms
     mXyz.col(coord::X) = X;
@@ -442,6 +505,7 @@ void AtomicStruct::genSimpleCubicStruct(const Atom &atom, double a, double l, do
     
     // total number of atoms
     long nx = X.n_rows, ny = Y.n_rows, nz = Z.n_rows;
+    msindex.reset();
     mNa = nx*ny*nz;
         
     // prepare atomId list containing atomic number of atom.
@@ -500,22 +564,10 @@ void AtomicStruct::genGNR(const Atom &atom, double acc, uint nl, uint nw, uint n
     // generating primitive cell
     AtomicStruct basisStructForGNR = this->genGNRPrimitiveCell( atom, acc );
     
-    AtomicStruct wholeGNR;
-    wholeGNR.init();
-    
     // Creating the GNR structure using the primitive cell and its lattice vector
-    for (long ix = 0; ix < nl; ++ix){
-        for ( long iy=0; iy < nw; ++iy ){
-            AtomicStruct tempBasisStruct = basisStructForGNR;
-            
-            tempBasisStruct += ix * basisStructForGNR.mlv.a1; // shifting basisStruct
-            tempBasisStruct += iy * basisStructForGNR.mlv.a2; // shifting basisStruct
-
-            wholeGNR += tempBasisStruct; //concatenation 
-        }
-    }
+    AtomicStruct wholeGNR = basisStructForGNR.replicate(nl, nw);
     
-    // overriding the lattice vectors // TODO // AtomicStruct operator += overloading adds up the lattice vector 
+    // the lattice vectors of the primitive cell
     wholeGNR.mlv.a1 =  basisStructForGNR.mlv.a1;
     wholeGNR.mlv.a2 =  basisStructForGNR.mlv.a2;
     wholeGNR.mlv.a3 =  basisStructForGNR.mlv.a3;
@@ -524,6 +576,13 @@ void AtomicStruct::genGNR(const Atom &atom, double acc, uint nl, uint nw, uint n
     *this = wholeGNR; 
 }
 
+/*
+ * See Supercell::toStruct(), O(N).
+ */
+AtomicStruct AtomicStruct::replicate(uint n1, uint n2, uint n3) const{
+    return Supercell(*this, n1, n2, n3).toStruct();
+}
+
 AtomicStruct AtomicStruct::genGNRPrimitiveCell(const Atom &atom, double acc){
     //////  generating the Primitive Cell consisting 4 atom for GNR
     //////                O      O
@@ -587,6 +646,36 @@ AtomicStruct AtomicStruct::span(uint start, uint end) const{
     return this->operator()(maths::armadillo::span(start, end));
 }
 
+const AtomIndex& AtomicStruct::spatialIndex() const{
+    if (!msindex){
+        msindex = make_shared<AtomIndex>(AtomicStructView(*this));
+    }
+    return *msindex;
+}
+
+ucol AtomicStruct::inBox(const svec &lo, const svec &hi) const{
+    return spatialIndex().inBox(lo.memptr(), hi.memptr());
+}
+
+ucol AtomicStruct::inPolygon(const mat &xy) const{
+    if (xy.n_cols != 2){
+        throw invalid_argument("In AtomicStruct::inPolygon(): xy must have two columns.");
+    }
+    maths::geometry::polygon p;
+    for (uint iv = 0; iv < xy.n_rows; ++iv){
+        p.outer().push_back(maths::geometry::point(xy(iv, 0), xy(iv, 1)));
+    }
+    return spatialIndex().inPolygon(p);
+}
+
+ucol AtomicStruct::inSphere(const svec &c, double r) const{
+    return spatialIndex().inSphere(c.memptr(), r);
+}
+
+ucol AtomicStruct::nearest(const svec &c, uint k) const{
+    return spatialIndex().nearest(c.memptr(), k);
+}
+
 }
 }
 
@@ -0,0 +1,170 @@
+/*
+ * File:   GeomFile.cpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 20, 2026, 12:10 AM
+ */
+
+#include "atoms/GeomFile.h"
+#include "utils/atomicfile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace quest{
+namespace atoms{
+
+static const char GeomMagic[8] = {'Q','G','E','O','M','0','0','1'};
+
+struct GeomHeader{
+    char     magic[8];
+    uint64_t na;
+    uint64_t nspecies;
+    double   lv[9];     // a1, a2, a3
+};
+
+struct GeomSpecies{
+    int32_t  ia;
+    int32_t  ne;
+    int32_t  no;
+    int32_t  reserved;
+    char     sym[16];
+};
+
+// bytes of the atomic numbers, padded so that the coordinates are aligned.
+static size_t idBytes(uint64_t na){
+    return (na*sizeof(int32_t) + 7)/8*8;
+}
+
+GeomFile::GeomFile(const string &fileName){
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0){
+        throw ios_base::failure(" GeomFile::GeomFile(): Failed to open file " 
+                + fileName + ".");
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(GeomHeader)){
+        close(fd);
+        throw ios_base::failure(" GeomFile::GeomFile(): " + fileName 
+                + " is not a geometry file.");
+    }
+    size_t size = st.st_size;
+    void *addr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED){
+        throw ios_base::failure(" GeomFile::GeomFile(): Failed to map file " 
+                + fileName + ".");
+    }
+    mfile = shared_ptr<const char>(static_cast<const char*>(addr), 
+            [size](const char *p){ munmap(const_cast<char*>(p), size); });
+    
+    // header
+    GeomHeader h;
+    std::memcpy(&h, mfile.get(), sizeof(h));
+    size_t pos = sizeof(GeomHeader);
+    // the counts are bounded by the file size first, so that a corrupt 
+    // header cannot wrap the size around.
+    size_t avail = size - pos;
+    bool valid = std::memcmp(h.magic, GeomMagic, sizeof(GeomMagic)) == 0
+              && h.nspecies <= avail/sizeof(GeomSpecies);
+    if (valid){
+        avail -= h.nspecies*sizeof(GeomSpecies);
+        valid = h.na <= avail/(sizeof(int32_t) + 3*sizeof(double))
+             && h.na <= std::numeric_limits<uint>::max();
+    }
+    if (valid){
+        size_t end = pos + h.nspecies*sizeof(GeomSpecies) + idBytes(h.na) 
+                   + 3*h.na*sizeof(double);
+        valid = end == size;
+    }
+    if (!valid){
+        throw ios_base::failure(" GeomFile::GeomFile(): " + fileName 
+                + " is not a geometry file.");
+    }
+    mna = h.na;
+    for (uint ic = 0; ic < 3; ++ic){
+        mlv.a1(ic) = h.lv[ic];
+        mlv.a2(ic) = h.lv[3 + ic];
+        mlv.a3(ic) = h.lv[6 + ic];
+    }
+    
+    // species
+    for (uint64_t is = 0; is < h.nspecies; ++is){
+        GeomSpecies sp;
+        std::memcpy(&sp, mfile.get() + pos, sizeof(sp));
+        sp.sym[sizeof(sp.sym) - 1] = '\0';
+        mpt.add(sp.ia, sp.sym, sp.ne, sp.no);
+        pos += sizeof(sp);
+    }
+    
+    // atoms, used in place
+    mid = reinterpret_cast<const int*>(mfile.get() + pos);
+    pos += idBytes(mna);
+    for (uint ic = 0; ic < 3; ++ic){
+        mr[ic] = reinterpret_cast<const double*>(mfile.get() + pos) + ic*mna;
+    }
+    for (uint ia = 0; ia < mna; ++ia){
+        if (mpt.find((uint)mid[ia]) < 0){
+            throw ios_base::failure(" GeomFile::GeomFile(): atom " 
+                    + utils::strings::itos(ia) + " of " + fileName + " is not in the species table.");
+        }
+    }
+}
+
+void GeomFile::write(const string &fileName, const AtomicStruct &s){
+    utils::writeAtomically(fileName, [&s](ofstream &out){
+        const ptable &pt = s.PeriodicTable();
+        lvec lv = s.LatticeVector();
+        GeomHeader h;
+        std::memcpy(h.magic, GeomMagic, sizeof(GeomMagic));
+        h.na = s.NumOfAtoms();
+        h.nspecies = pt.elements.size();
+        for (uint ic = 0; ic < 3; ++ic){
+            h.lv[ic] = lv.a1(ic);
+            h.lv[3 + ic] = lv.a2(ic);
+            h.lv[6 + ic] = lv.a3(ic);
+        }
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        
+        for (ptable::cpiter it = pt.elements.begin(); it != pt.elements.end(); ++it){
+            GeomSpecies sp;
+            std::memset(&sp, 0, sizeof(sp));
+            sp.ia = it->second.ia;
+            sp.ne = it->second.ne;
+            sp.no = it->second.no;
+            std::strncpy(sp.sym, it->second.sym.c_str(), sizeof(sp.sym) - 1);
+            out.write(reinterpret_cast<const char*>(&sp), sizeof(sp));
+        }
+        
+        vector<int32_t> id(idBytes(h.na)/sizeof(int32_t), 0);
+        for (uint ia = 0; ia < h.na; ++ia){
+            id[ia] = s.AtomicNumber(ia);
+        }
+        out.write(reinterpret_cast<const char*>(id.data()), idBytes(h.na));
+        
+        mat xyz = s.XYZ();
+        if (h.na > 0){
+            out.write(reinterpret_cast<const char*>(xyz.memptr()), 
+                    3*h.na*sizeof(double));
+        }
+    }, "GeomFile::write()");
+}
+
+void gjfToGeom(const string &gjfFileName, const string &geomFileName){
+    GeomFile::write(geomFileName, AtomicStruct(gjfFileName));
+}
+
+void geomToGjf(const string &geomFileName, const string &gjfFileName){
+    GeomFile(geomFileName).toStruct().exportGjf(gjfFileName);
+}
+
+}
+}
+
@@ -0,0 +1,78 @@
+/*
+ * File:   Supercell.cpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 11:55 PM
+ */
+
+#include "atoms/Supercell.h"
+#include "utils/parallel.h"
+
+#include <algorithm>
+
+namespace quest{
+namespace atoms{
+
+// atoms filled in by one thread at a time
+static const long AtomChunk = 4096;
+
+Supercell::Supercell(const AtomicStruct &basis, uint n1, uint n2, uint n3):
+        mbasis(basis), mn1(n1), mn2(n2), mn3(n3), mnb(basis.NumOfAtoms())
+{
+    lvec lv = basis.LatticeVector();
+    for (uint ic = 0; ic < 3; ++ic){
+        ma[0][ic] = lv.a1(ic);
+        ma[1][ic] = lv.a2(ic);
+        ma[2][ic] = lv.a3(ic);
+    }
+}
+
+lvec Supercell::LatticeVector() const{
+    lvec lv = mbasis.LatticeVector();
+    lv.a1 = mn1*lv.a1;
+    lv.a2 = mn2*lv.a2;
+    lv.a3 = mn3*lv.a3;
+    return lv;
+}
+
+/*
+ * The storage is allocated once and each copy of the basis writes its own
+ * rows, so the copies can be filled concurrently. O(N).
+ */
+AtomicStruct Supercell::toStruct(uint nthreads) const{
+    long nc = (long)mn1*mn2*mn3;
+    long na = nc*mnb;
+
+    AtomicStruct cell(mbasis);
+    cell.msindex.reset();
+    cell.mia.set_size(na);
+    cell.mXyz.set_size(na, 3);
+
+    if (na > 0){
+        long cellsPerChunk = std::max(1L, AtomChunk/mnb);
+        long nchunks = (nc + cellsPerChunk - 1)/cellsPerChunk;
+        utils::parallelFor(nchunks, nthreads, [&](uint ichunk){
+            long cend = std::min(nc, (ichunk + 1)*cellsPerChunk);
+            for (long c = ichunk*cellsPerChunk; c < cend; ++c){
+                long ia = c*mnb;
+                for (uint ib = 0; ib < mnb; ++ib, ++ia){
+                    cell.mia(ia) = mbasis.mia(ib);
+                    cell.mXyz(ia, coord::X) = R(ia, coord::X);
+                    cell.mXyz(ia, coord::Y) = R(ia, coord::Y);
+                    cell.mXyz(ia, coord::Z) = R(ia, coord::Z);
+                }
+            }
+        });
+    }
+
+    cell.mlv = LatticeVector();
+    cell.mNa = na;
+    cell.mNo = nc*mbasis.mNo;
+    cell.mNe = nc*mbasis.mNe;
+
+    return cell;
+}
+
+}
+}
+
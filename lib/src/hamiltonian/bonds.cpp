@@ -0,0 +1,90 @@
+/*
+ * File:   bonds.cpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 9:40 PM
+ */
+
+#include "hamiltonian/bonds.h"
+
+namespace quest{
+namespace hamiltonian{
+
+/*
+ * Generates H and S the same way as generateHamOvl() and keeps the 
+ * non-zero elements of H. The phase of the field p was generated with is 
+ * taken out so that the elements at Bz = 0 are stored.
+ */
+BondHam::BondHam(const cxhamparams &p, const AtomicStructView &bi, 
+        const AtomicStructView &bj): mpeierls(p.usesPeierlsPhase()), 
+        mBz(p.Bz()), mBzGauge(p.BzGauge())
+{
+    int nai = bi.NumOfAtoms();
+    BlockSites si(bi), sj(bj);
+    uword noi = si.io(nai);
+    uword noj = sj.io(bj.NumOfAtoms());
+
+    mH = zeros<cxmat>(noi, noj);
+    mS = zeros<cxmat>(noi, noj);
+    
+    vector<uword> idx;
+    vector<double> xi, yi, xj, yj;
+    
+    cxmat h(si.nomax, sj.nomax);
+
+    vector<vector<uint> > neigh = neighborPairs(bi, bj, p.cutoff());
+    for(int ia = 0; ia != nai; ++ia){
+        uword io = si.io(ia);
+        uword ni = si.no(ia);
+        const double *ri = si.r.colptr(ia);
+
+        for(uint in = 0; in < neigh[ia].size(); ++in){
+            int ja = neigh[ia][in];
+            uword jo = sj.io(ja);
+            uword nj = sj.no(ja);
+            const double *rj = sj.r.colptr(ja);
+            
+            p.pairOvl(ri, si.id(ia), rj, sj.id(ja), mS.colptr(jo) + io, noi);
+            h.zeros();
+            if (!p.pairHam(ri, si.id(ia), rj, sj.id(ja), h.memptr(), h.n_rows)){
+                continue;
+            }
+            for (uword n = 0; n < nj; ++n){
+                for (uword m = 0; m < ni; ++m){
+                    if (h(m, n) != dcmplx(0, 0)){
+                        idx.push_back((jo + n)*noi + io + m);
+                        xi.push_back(ri[0]);
+                        yi.push_back(ri[1]);
+                        xj.push_back(rj[0]);
+                        yj.push_back(rj[1]);
+                        mH(io + m, jo + n) = h(m, n);
+                    }
+                }
+            }
+        }
+    }
+    
+    mIdx = conv_to<uwcol>::from(idx);
+    mxi = conv_to<vec>::from(xi);
+    myi = conv_to<vec>::from(yi);
+    mxj = conv_to<vec>::from(xj);
+    myj = conv_to<vec>::from(yj);
+    
+    mH0 = mH.elem(mIdx);
+    if (mpeierls && mIdx.n_elem > 0){
+        mH0 /= peierlsPhase(mxi, myi, mxj, myj, mBz, mBzGauge);
+    }
+}
+
+void BondHam::Bz(double Bz, int gauge){
+    mBz = Bz;
+    mBzGauge = gauge;
+    if (!mpeierls || mIdx.n_elem == 0){
+        return;
+    }
+    mH.elem(mIdx) = mH0 % peierlsPhase(mxi, myi, mxj, myj, mBz, mBzGauge);
+}
+
+}
+}
+
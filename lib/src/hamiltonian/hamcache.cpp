@@ -0,0 +1,216 @@
+/*
+ * File:   hamcache.cpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 11:15 PM
+ */
+
+#include "hamiltonian/hamcache.h"
+#include "utils/atomicfile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+namespace quest{
+namespace hamiltonian{
+
+static const char CacheMagic[8] = {'Q','H','C','A','C','H','E','1'};
+static const size_t KeyLength = 32;
+
+/*
+ * Two 64 bit FNV-1a hashes with different offsets, 128 bits together.
+ */
+struct KeyHash{
+    uint64_t h1, h2;
+    
+    KeyHash(): h1(14695981039346656037ULL), h2(0x6c62272e07bb0142ULL) {};
+    
+    void add(const void *data, size_t n){
+        const unsigned char *p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < n; ++i){
+            h1 = (h1 ^ p[i])*1099511628211ULL;
+            h2 = (h2 ^ p[i])*1099511628211ULL;
+        }
+    }
+    
+    template<class V>
+    void add(const V &x){
+        add(&x, sizeof(x));
+    }
+    
+    void add(const mat &m){
+        add(m.n_rows);
+        add(m.n_cols);
+        add(m.memptr(), m.n_elem*sizeof(double));
+    }
+    
+    void add(const AtomicStruct &b){
+        int na = b.NumOfAtoms();
+        add(na);
+        add(b.XYZ());
+        for (int ia = 0; ia < na; ++ia){
+            add(b.AtomicNumber(ia));
+            add(b.NumOfOrbitalsAt(ia));
+        }
+        lvec lv = b.LatticeVector();
+        add(mat(lv.a1));
+        add(mat(lv.a2));
+        add(mat(lv.a3));
+    }
+    
+    string hex() const {
+        stringstream ss;
+        ss << std::hex << std::setfill('0') << std::setw(16) << h1 
+           << std::setw(16) << h2;
+        return ss.str();
+    }
+};
+
+/*
+ * a*b into ab if it is not larger than max.
+ */
+static bool boundedProduct(uint64_t a, uint64_t b, uint64_t max, uint64_t &ab){
+    if (a != 0 && b > max/a){
+        return false;
+    }
+    ab = a*b;
+    return ab <= max;
+}
+
+HamCache::HamCache(const string &dir):mdir(dir){
+}
+
+string HamCache::key(const cxhamparams &p, const vector<AtomicStruct> &bi, 
+        const vector<AtomicStruct> &bj) const
+{
+    if (bi.size() != bj.size()){
+        throw invalid_argument("In HamCache::key(): bi and bj must have the same number of blocks.");
+    }
+    
+    KeyHash h;
+    string fp = p.fingerprint();
+    h.add(fp.size());
+    h.add(fp.data(), fp.size());
+    h.add(bi.size());
+    for (size_t ib = 0; ib < bi.size(); ++ib){
+        h.add(bi[ib]);
+        h.add(bj[ib]);
+    }
+    
+    return h.hex();
+}
+
+string HamCache::fileName(const string &key) const {
+    return mdir + "/" + key + ".hcache";
+}
+
+bool HamCache::load(const string &key, vector<cxmat> &H, vector<cxmat> &S) const {
+    if (key.size() != KeyLength){
+        return false;
+    }
+    string fname = fileName(key);
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0){
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)(sizeof(CacheMagic) 
+            + sizeof(uint64_t) + KeyLength)){
+        close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    void *addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED){
+        return false;
+    }
+    
+    // header
+    const char *p = static_cast<const char*>(addr);
+    bool valid = std::memcmp(p, CacheMagic, sizeof(CacheMagic)) == 0
+              && std::memcmp(p + sizeof(CacheMagic) + sizeof(uint64_t), 
+                    key.data(), KeyLength) == 0;
+    uint64_t npairs = 0;
+    if (valid){
+        std::memcpy(&npairs, p + sizeof(CacheMagic), sizeof(npairs));
+    }
+    size_t pos = sizeof(CacheMagic) + sizeof(uint64_t) + KeyLength;
+    
+    // sizes, all the counts are bounded by what is left of the file before 
+    // they are multiplied, so that a corrupt file cannot wrap them around.
+    const uint64_t *dims = reinterpret_cast<const uint64_t*>(p + pos);
+    valid = valid && npairs <= (size - pos)/(4*sizeof(uint64_t));
+    uint64_t ndata = 0;
+    if (valid){
+        pos += 4*npairs*sizeof(uint64_t);
+        uint64_t nleft = (size - pos)/sizeof(dcmplx);
+        for (uint64_t ib = 0; valid && ib < npairs; ++ib){
+            uint64_t nh, ns;
+            valid = boundedProduct(dims[4*ib], dims[4*ib+1], nleft - ndata, nh)
+                 && boundedProduct(dims[4*ib+2], dims[4*ib+3], nleft - ndata - nh, ns);
+            ndata += valid ? nh + ns : 0;
+        }
+    }
+    valid = valid && pos + ndata*sizeof(dcmplx) == size;
+    
+    // data
+    if (valid){
+        const dcmplx *data = reinterpret_cast<const dcmplx*>(p + pos);
+        H.resize(npairs);
+        S.resize(npairs);
+        for (uint64_t ib = 0; ib < npairs; ++ib){
+            H[ib] = cxmat(data, dims[4*ib], dims[4*ib+1]);
+            data += H[ib].n_elem;
+            S[ib] = cxmat(data, dims[4*ib+2], dims[4*ib+3]);
+            data += S[ib].n_elem;
+        }
+    }
+    munmap(addr, size);
+    
+    return valid;
+}
+
+void HamCache::save(const string &key, const vector<cxmat> &H, 
+        const vector<cxmat> &S) const
+{
+    if (H.size() != S.size()){
+        throw invalid_argument("In HamCache::save(): H and S must have the same number of blocks.");
+    }
+    if (key.size() != KeyLength){
+        throw invalid_argument("In HamCache::save(): invalid key " + key + ".");
+    }
+    if (mkdir(mdir.c_str(), 0755) != 0 && errno != EEXIST){
+        throw ios_base::failure(" HamCache::save(): Failed to create directory " 
+                + mdir + ".");
+    }
+    
+    utils::writeAtomically(fileName(key), [&key, &H, &S](ofstream &out){
+        uint64_t npairs = H.size();
+        out.write(CacheMagic, sizeof(CacheMagic));
+        out.write(reinterpret_cast<const char*>(&npairs), sizeof(npairs));
+        out.write(key.data(), KeyLength);
+        for (uint64_t ib = 0; ib < npairs; ++ib){
+            uint64_t dims[4] = {H[ib].n_rows, H[ib].n_cols, S[ib].n_rows, S[ib].n_cols};
+            out.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+        }
+        for (uint64_t ib = 0; ib < npairs; ++ib){
+            out.write(reinterpret_cast<const char*>(H[ib].memptr()), 
+                    H[ib].n_elem*sizeof(dcmplx));
+            out.write(reinterpret_cast<const char*>(S[ib].memptr()), 
+                    S[ib].n_elem*sizeof(dcmplx));
+        }
+    }, "HamCache::save()");
+}
+
+}
+}
+
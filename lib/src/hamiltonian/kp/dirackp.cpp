@@ -18,82 +18,88 @@ DiracKpParams::DiracKpParams(const string &prefix):cxhamparams(prefix)
 }
 
 
-cxmat DiracKpParams::twoAtomHam(const AtomicStruct& atomi, const AtomicStruct& atomj) const
+string DiracKpParams::fingerprint() const {
+    string fp = cxhamparams::fingerprint();
+    addFingerprint(fp, ma);
+    addFingerprint(fp, mK);
+    addFingerprint(fp, mI);
+    addFingerprint(fp, meps);
+    addFingerprint(fp, mt01x);
+    addFingerprint(fp, mt10x);
+    addFingerprint(fp, mt01y);
+    addFingerprint(fp, mt10y);
+    return fp;
+}
+
+KpStencil DiracKpParams::stencil() const {
+    KpStencil st = {ma, mI, meps, mt01x, mt10x, mt01y, mt10y, true, mBz, 
+                    mBzGauge, mfactor};
+    return st;
+}
+
+bool DiracKpParams::pairHam(const double *ri, int si, const double *rj, int sj, 
+        dcmplx *out, uword ld) const
 {
-    if (atomi.NumOfAtoms() > 1 || atomj.NumOfAtoms() > 1) {
-        throw invalid_argument("DiracKpParams(): atomi and atomj must should contain one atom each.");
+    if (si != DiscreteID || sj != DiscreteID) {
+        return false;
     }
     
-    int noi = atomi.NumOfOrbitals();
-    int noj = atomj.NumOfOrbitals();
-
-    cxmat hmat =  zeros<cxmat>(noi, noj);
-
     // calculate distance between atom i and atom j
-    double xi = atomi.X(0), yi = atomi.Y(0), zi = atomi.Z(0);
-    double xj = atomj.X(0), yj = atomj.Y(0), zj = atomj.Z(0);
+    double xi = ri[0], yi = ri[1], xj = rj[0], yj = rj[1];
     
-    double dx = abs(xi - xj), dy = abs(yi - yj), dz = abs(zi - zj);           
+    double dx = abs(xi - xj), dy = abs(yi - yj), dz = abs(ri[2] - rj[2]);           
     double d = sqrt(dx*dx + dy*dy + dz*dz);
 
     // Assign the the matrix elements based on the distance between 
     // the lattice points.
-    if (atomi.Symbol(0) == "D" && atomj.Symbol(0) == "D") {
-        // site energy
-        if (d <= mdtol){
-            hmat = meps;
-        // nearest neighbor in x
-        } else if (abs(d - ma) <= mdtol && abs(dx - ma) <= mdtol) { 
-            // add magnetic field
-            dcmplx phase = calcPeierlsPhase(xi, yi, xj, yj);
-            
-            if (xi > xj){
-                hmat = mt10x*phase;
-            } else {
-                hmat = mt01x*phase;
-            }
-        //nearest neighbor y
-        } else if (abs(d - ma) <= mdtol && abs(dy - ma) <= mdtol) {
-            // add magnetic field
-            dcmplx phase = calcPeierlsPhase(xi, yi, xj, yj);
-            
-            if (yi > yj) {
-                hmat = mt10y*phase;
-            } else {
-                hmat = mt01y*phase;
-            }
-        }            
-    }  
-    return hmat;
+    // site energy
+    if (d <= mdtol){
+        putBlock(out, ld, meps);
+    // nearest neighbor in x
+    } else if (abs(d - ma) <= mdtol && abs(dx - ma) <= mdtol) { 
+        // add magnetic field
+        dcmplx phase = calcPeierlsPhase(xi, yi, xj, yj);
+
+        if (xi > xj){
+            putBlock(out, ld, mt10x, phase);
+        } else {
+            putBlock(out, ld, mt01x, phase);
+        }
+    //nearest neighbor y
+    } else if (abs(d - ma) <= mdtol && abs(dy - ma) <= mdtol) {
+        // add magnetic field
+        dcmplx phase = calcPeierlsPhase(xi, yi, xj, yj);
+
+        if (yi > yj) {
+            putBlock(out, ld, mt10y, phase);
+        } else {
+            putBlock(out, ld, mt01y, phase);
+        }
+    } else {
+        return false;
+    }
+    
+    return true;
 };
 
-cxmat DiracKpParams::twoAtomOvl(const AtomicStruct& atomi, const AtomicStruct& atomj) const
+bool DiracKpParams::pairOvl(const double *ri, int si, const double *rj, int sj, 
+        dcmplx *out, uword ld) const
 {
-    if (atomi.NumOfAtoms() > 1 || atomj.NumOfAtoms() > 1) {
-        throw invalid_argument("DiracKpParams(): atomi and atomj must should contain one atom each.");
+    if (si != DiscreteID || sj != DiscreteID) {
+        return false;
     }
     
-    int noi = atomi.NumOfOrbitals();
-    int noj = atomj.NumOfOrbitals();
-
-    cxmat smat =  zeros<cxmat>(noi, noj);
-
     // calculate distance between atom i and atom j
-    double xi = atomi.X(0), yi = atomi.Y(0), zi = atomi.Z(0);
-    double xj = atomj.X(0), yj = atomj.Y(0), zj = atomj.Z(0);
-    
-    double dx = abs(xi - xj), dy = abs(yi - yj), dz = abs(zi - zj);           
+    double dx = ri[0] - rj[0], dy = ri[1] - rj[1], dz = ri[2] - rj[2];
     double d = sqrt(dx*dx + dy*dy + dz*dz);
 
-    // Assign the the matrix elements based on the distance between 
-    // the lattice points.
-    if (atomi.Symbol(0) == "D" && atomj.Symbol(0) == "D"){
-        // overlap matrix of atom i.
-        if (d <= mdtol){
-            smat = mI;
-        }
+    // overlap matrix of atom i.
+    if (d <= mdtol){
+        putBlock(out, ld, mI);
+        return true;
     }
-    return smat;
+    
+    return false;
 };
 
 
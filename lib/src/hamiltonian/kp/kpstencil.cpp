@@ -0,0 +1,105 @@
+/*
+ * File:   kpstencil.cpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 11:05 PM
+ */
+
+#include "hamiltonian/kp/kpstencil.h"
+
+namespace quest{
+namespace hamiltonian{
+
+// Peierls phase of the hopping from (xj, yj) to (xi, yi).
+static dcmplx phase(const KpStencil &st, double xi, double yi, double xj, 
+        double yj)
+{
+    if (!st.peierls || std::abs(st.Bz) <= 1E-10){
+        return dcmplx(1, 0);
+    }
+    double phi = 0;
+    if (st.BzGauge == coord::X){ // for A = (-Bz*y, 0, 0)
+        phi = st.factor*st.Bz*(xi - xj)*(yi + yj);
+    }else if (st.BzGauge == coord::Y){ // for A = (0, Bz*x, 0)
+        phi = st.factor*st.Bz*(yj - yi)*(xi + xj);
+    }
+    return dcmplx(cos(phi), sin(phi));
+}
+
+// Puts blk into the (iy, jy) site block of H.
+static void put(cxmat &H, uint no, uint iy, uint jy, const cxmat &blk, 
+        dcmplx a = dcmplx(1, 0))
+{
+    H.submat(iy*no, jy*no, (iy + 1)*no - 1, (jy + 1)*no - 1) = a*blk;
+}
+
+cxmat kpBlockH0(const KpStencil &st, uint ny, double x0, double y0, int ix){
+    uint no = st.eps.n_rows;
+    double x = x0 + ix*st.a;
+    
+    cxmat H0(ny*no, ny*no, fill::zeros);
+    for (uint iy = 0; iy < ny; ++iy){
+        double y = y0 + iy*st.a;
+        put(H0, no, iy, iy, st.eps);
+        if (iy > 0){
+            put(H0, no, iy, iy - 1, st.t10y, phase(st, x, y, x, y - st.a));
+            put(H0, no, iy - 1, iy, st.t01y, phase(st, x, y - st.a, x, y));
+        }
+    }
+    return H0;
+}
+
+cxmat kpBlockHl(const KpStencil &st, uint ny, double x0, double y0, int ix){
+    uint no = st.eps.n_rows;
+    double x = x0 + ix*st.a;
+    
+    cxmat Hl(ny*no, ny*no, fill::zeros);
+    for (uint iy = 0; iy < ny; ++iy){
+        double y = y0 + iy*st.a;
+        put(Hl, no, iy, iy, st.t10x, phase(st, x, y, x - st.a, y));
+    }
+    return Hl;
+}
+
+cxmat kpBlockS0(const KpStencil &st, uint ny){
+    uint no = st.I.n_rows;
+    cxmat S0(ny*no, ny*no, fill::zeros);
+    for (uint iy = 0; iy < ny; ++iy){
+        put(S0, no, iy, iy, st.I);
+    }
+    return S0;
+}
+
+void generateKpBlocks(field<shared_ptr<cxmat> > &H0, 
+        field<shared_ptr<cxmat> > &Hl, field<shared_ptr<cxmat> > &S0, 
+        const KpStencil &st, uint nx, uint ny, double x0, double y0)
+{
+    H0.set_size(nx);
+    Hl.set_size(nx + 1);
+    S0.set_size(nx);
+    
+    // With gauge A = (-Bz*y, 0, 0) the phases depend only on y. 
+    bool uniform = !st.peierls || std::abs(st.Bz) <= 1E-10 
+                || st.BzGauge == coord::X;
+    
+    shared_ptr<cxmat> S = make_shared<cxmat>(kpBlockS0(st, ny));
+    for (uint ix = 0; ix < nx; ++ix){
+        S0(ix) = S;
+        if (uniform && ix > 0){
+            H0(ix) = H0(0);
+        }else{
+            H0(ix) = make_shared<cxmat>(kpBlockH0(st, ny, x0, y0, ix));
+        }
+    }
+    for (uint ix = 0; ix <= nx; ++ix){
+        if (uniform && ix > 0){
+            Hl(ix) = Hl(0);
+        }else{
+            Hl(ix) = make_shared<cxmat>(kpBlockHl(st, ny, x0, y0, ix));
+        }
+    }
+}
+
+}
+}
+
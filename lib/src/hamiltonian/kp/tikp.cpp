@@ -51,103 +51,110 @@ void TISurfKpParams::update(){
     mt10y = trans(mt01y);
 } 
 
-cxmat TISurfKpParams::twoAtomHam(const AtomicStruct& atomi, 
-        const AtomicStruct& atomj)  const
-{
-    if (atomi.NumOfAtoms() > 1 || atomj.NumOfAtoms() > 1){
-        throw invalid_argument("TISurfHamGen(): atomi and atomj must should contain one atom each.");
-    }
+string TISurfKpParams::fingerprint() const {
+    string fp = cxhamparams::fingerprint();
+    addFingerprint(fp, ma);
+    addFingerprint(fp, mK);
+    addFingerprint(fp, mC);
+    addFingerprint(fp, mA2);
+    addFingerprint(fp, mfactor);
+    addFingerprint(fp, mI);
+    addFingerprint(fp, meps);
+    addFingerprint(fp, mt01x);
+    addFingerprint(fp, mt10x);
+    addFingerprint(fp, mt01y);
+    addFingerprint(fp, mt10y);
+    return fp;
+}
 
-    int noi = atomi.NumOfOrbitals();
-    int noj = atomj.NumOfOrbitals();
+KpStencil TISurfKpParams::stencil() const {
+    KpStencil st = {ma, mI, meps, mt01x, mt10x, mt01y, mt10y, true, mBz, 
+                    mBzGauge, mfactor};
+    return st;
+}
 
-    cxmat hmat =  zeros<cxmat>(noi, noj);
+bool TISurfKpParams::pairHam(const double *ri, int si, const double *rj, 
+        int sj, dcmplx *out, uword ld) const
+{
+    if (si != DiscreteID || sj != DiscreteID){
+        return false;
+    }
 
     // calculate distance between atom i and atom j
-    double xi = atomi.X(0), yi = atomi.Y(0), zi = atomi.Z(0);
-    double xj = atomj.X(0), yj = atomj.Y(0), zj = atomj.Z(0);
+    double xi = ri[0], yi = ri[1], zi = ri[2];
+    double xj = rj[0], yj = rj[1], zj = rj[2];
     
     double dx = abs(xi - xj), dy = abs(yi - yj), dz = abs(zi - zj);           
     double d = sqrt(dx*dx + dy*dy + dz*dz);
 
     // Assign the the matrix elements based on the distance between 
     // the lattice points.
-    if (atomi.Symbol(0) == "D" && atomj.Symbol(0) == "D"){
-        // site energy
-        if (d <= mdtol){
-            hmat = meps;
-        // nearest neighbor in x
-        }else if(abs(d - ma) <= mdtol && abs(dx - ma) <= mdtol){ 
-            // add magnetic field
-            dcmplx phase = dcmplx(1,0);
-            if(abs(mBz) > mBzTol){
-                if (mBzGauge == coord::X){ // for A = (-Bz*y, 0, 0)
-                    double phi = mfactor*mBz*(xi - xj)*(yi+yj);
-                    phase = exp(i*phi);
-                }else if (mBzGauge == coord::Y){ // for A = (0, Bz*x, 0)
-                    double phi = mfactor*mBz*(yj - yi)*(xi+xj);
-                    phase = exp(i*phi);
-                }
+    // site energy
+    if (d <= mdtol){
+        putBlock(out, ld, meps);
+    // nearest neighbor in x
+    }else if(abs(d - ma) <= mdtol && abs(dx - ma) <= mdtol){ 
+        // add magnetic field
+        dcmplx phase = dcmplx(1,0);
+        if(abs(mBz) > mBzTol){
+            if (mBzGauge == coord::X){ // for A = (-Bz*y, 0, 0)
+                double phi = mfactor*mBz*(xi - xj)*(yi+yj);
+                phase = exp(i*phi);
+            }else if (mBzGauge == coord::Y){ // for A = (0, Bz*x, 0)
+                double phi = mfactor*mBz*(yj - yi)*(xi+xj);
+                phase = exp(i*phi);
             }
-            
-            if (xi > xj){
-                hmat = mt10x*phase;
-            }else{
-                hmat = mt01x*phase;
-            }
-        //nearest neighbor y
-        }else if (abs(d - ma) <= mdtol && abs(dy - ma) <= mdtol){
-            // add magnetic field
-            dcmplx phase = dcmplx(1,0);
-            if(abs(mBz) > mBzTol){
-                if (mBzGauge == coord::Y){ // for A = (0, Bz*x, 0)
-                    double phi = mfactor*mBz*(yj - yi)*(xi+xj);
-                    phase = exp(i*phi);
-                }else if (mBzGauge == coord::X){ // for A = (-Bz*y, 0, 0)
-                    double phi = mfactor*mBz*(xi - xj)*(yi+yj);
-                    phase = exp(i*phi);
-                }
-            }
-            
-            if(yi > yj){
-                hmat = mt10y*phase;
-            }else{
-                hmat = mt01y*phase;
+        }
+
+        if (xi > xj){
+            putBlock(out, ld, mt10x, phase);
+        }else{
+            putBlock(out, ld, mt01x, phase);
+        }
+    //nearest neighbor y
+    }else if (abs(d - ma) <= mdtol && abs(dy - ma) <= mdtol){
+        // add magnetic field
+        dcmplx phase = dcmplx(1,0);
+        if(abs(mBz) > mBzTol){
+            if (mBzGauge == coord::Y){ // for A = (0, Bz*x, 0)
+                double phi = mfactor*mBz*(yj - yi)*(xi+xj);
+                phase = exp(i*phi);
+            }else if (mBzGauge == coord::X){ // for A = (-Bz*y, 0, 0)
+                double phi = mfactor*mBz*(xi - xj)*(yi+yj);
+                phase = exp(i*phi);
             }
-        }            
+        }
+
+        if(yi > yj){
+            putBlock(out, ld, mt10y, phase);
+        }else{
+            putBlock(out, ld, mt01y, phase);
+        }
+    }else{
+        return false;
     }
     
-    return hmat;
+    return true;
 };
 
-cxmat TISurfKpParams::twoAtomOvl(const AtomicStruct& atomi, 
-        const AtomicStruct& atomj)  const
+bool TISurfKpParams::pairOvl(const double *ri, int si, const double *rj, 
+        int sj, dcmplx *out, uword ld) const
 {
-    if (atomi.NumOfAtoms() > 1 || atomj.NumOfAtoms() > 1){
-        throw invalid_argument("TISurfHamGen(): atomi and atomj must should contain one atom each.");
+    if (si != DiscreteID || sj != DiscreteID){
+        return false;
     }
 
-    int noi = atomi.NumOfOrbitals();
-    int noj = atomj.NumOfOrbitals();
-
-    cxmat smat =  zeros<cxmat>(noi, noj);
-
     // calculate distance between atom i and atom j
-    double xi = atomi.X(0), yi = atomi.Y(0), zi = atomi.Z(0);
-    double xj = atomj.X(0), yj = atomj.Y(0), zj = atomj.Z(0);
-    
-    double dx = abs(xi - xj), dy = abs(yi - yj), dz = abs(zi - zj);           
+    double dx = ri[0] - rj[0], dy = ri[1] - rj[1], dz = ri[2] - rj[2];
     double d = sqrt(dx*dx + dy*dy + dz*dz);
 
-    // Assign the the matrix elements based on the distance between 
-    // the lattice points.
-    if (atomi.Symbol(0) == "D" && atomj.Symbol(0) == "D"){
-        // site energy
-        if (d <= mdtol){
-            smat = mI;
-        }
-    }   
-    return smat;
+    // site energy
+    if (d <= mdtol){
+        putBlock(out, ld, mI);
+        return true;
+    }
+    
+    return false;
 };
 
 }
@@ -69,79 +69,85 @@ void TISurfKpParams4::update(){
     mt10y = trans(mt01y);
 }  
 
-cxmat TISurfKpParams4::twoAtomHam(const AtomicStruct& atomi, 
-        const AtomicStruct& atomj) const
-{
-    if (atomi.NumOfAtoms() > 1 || atomj.NumOfAtoms() > 1){
-        throw invalid_argument("TISurfHamGen(): atomi and atomj must should contain one atom each.");
-    }
+string TISurfKpParams4::fingerprint() const {
+    string fp = cxhamparams::fingerprint();
+    addFingerprint(fp, ma);
+    addFingerprint(fp, mK);
+    addFingerprint(fp, mC);
+    addFingerprint(fp, mA2);
+    addFingerprint(fp, mI);
+    addFingerprint(fp, meps);
+    addFingerprint(fp, mt01x);
+    addFingerprint(fp, mt10x);
+    addFingerprint(fp, mt01y);
+    addFingerprint(fp, mt10y);
+    return fp;
+}
 
-    int noi = atomi.NumOfOrbitals();
-    int noj = atomj.NumOfOrbitals();
+KpStencil TISurfKpParams4::stencil() const {
+    KpStencil st = {ma, mI, meps, mt01x, mt10x, mt01y, mt10y, false, mBz, 
+                    mBzGauge, mfactor};
+    return st;
+}
 
-    cxmat hmat =  zeros<cxmat>(noi, noj);
+bool TISurfKpParams4::pairHam(const double *ri, int si, const double *rj, 
+        int sj, dcmplx *out, uword ld) const
+{
+    if (si != DiscreteID || sj != DiscreteID){
+        return false;
+    }
 
     // calculate distance between atom i and atom j
-    double xi = atomi.X(0), yi = atomi.Y(0), zi = atomi.Z(0);
-    double xj = atomj.X(0), yj = atomj.Y(0), zj = atomj.Z(0);
+    double xi = ri[0], yi = ri[1], zi = ri[2];
+    double xj = rj[0], yj = rj[1], zj = rj[2];
     
     double dx = abs(xi - xj), dy = abs(yi - yj), dz = abs(zi - zj);           
     double d = sqrt(dx*dx + dy*dy + dz*dz);
 
     // Assign the the matrix elements based on the distance between 
     // the lattice points.
-    if (atomi.Symbol(0) == "D" && atomj.Symbol(0) == "D"){
-        // site energy
-        if (d <= mdtol){
-            hmat = meps;
-        // nearest neighbor in x
-        }else if(abs(d - ma) <= mdtol && abs(dx - ma) <= mdtol){ 
-            if (xi > xj){
-                hmat = mt10x;
-            }else{
-                hmat = mt01x;
-            }
-        //nearest neighbor y
-        }else if (abs(d - ma) <= mdtol && abs(dy - ma) <= mdtol){
-            if(yi > yj){
-                hmat = mt10y;
-            }else{
-                hmat = mt01y;
-            }
-        }            
+    // site energy
+    if (d <= mdtol){
+        putBlock(out, ld, meps);
+    // nearest neighbor in x
+    }else if(abs(d - ma) <= mdtol && abs(dx - ma) <= mdtol){ 
+        if (xi > xj){
+            putBlock(out, ld, mt10x);
+        }else{
+            putBlock(out, ld, mt01x);
+        }
+    //nearest neighbor y
+    }else if (abs(d - ma) <= mdtol && abs(dy - ma) <= mdtol){
+        if(yi > yj){
+            putBlock(out, ld, mt10y);
+        }else{
+            putBlock(out, ld, mt01y);
+        }
+    }else{
+        return false;
     }
     
-    return hmat;
+    return true;
 };
 
-cxmat TISurfKpParams4::twoAtomOvl(const AtomicStruct& atomi, 
-        const AtomicStruct& atomj) const
+bool TISurfKpParams4::pairOvl(const double *ri, int si, const double *rj, 
+        int sj, dcmplx *out, uword ld) const
 {
-    if (atomi.NumOfAtoms() > 1 || atomj.NumOfAtoms() > 1){
-        throw invalid_argument("TISurfHamGen(): atomi and atomj must should contain one atom each.");
+    if (si != DiscreteID || sj != DiscreteID){
+        return false;
     }
 
-    int noi = atomi.NumOfOrbitals();
-    int noj = atomj.NumOfOrbitals();
-
-    cxmat smat =  zeros<cxmat>(noi, noj);
-
     // calculate distance between atom i and atom j
-    double xi = atomi.X(0), yi = atomi.Y(0), zi = atomi.Z(0);
-    double xj = atomj.X(0), yj = atomj.Y(0), zj = atomj.Z(0);
-    
-    double dx = abs(xi - xj), dy = abs(yi - yj), dz = abs(zi - zj);           
+    double dx = ri[0] - rj[0], dy = ri[1] - rj[1], dz = ri[2] - rj[2];
     double d = sqrt(dx*dx + dy*dy + dz*dz);
 
-    // Assign the the matrix elements based on the distance between 
-    // the lattice points.
-    if (atomi.Symbol(0) == "D" && atomj.Symbol(0) == "D"){
-        // site energy
-        if (d <= mdtol){
-            smat = mI;
-        }
-    }   
-    return smat;
+    // site energy
+    if (d <= mdtol){
+        putBlock(out, ld, mI);
+        return true;
+    }
+    
+    return false;
 };
 
 }
@@ -0,0 +1,68 @@
+/*
+ * File:   pargen.cpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 10:30 PM
+ */
+
+#include "hamiltonian/pargen.h"
+
+namespace quest{
+namespace hamiltonian{
+
+// atoms of a block generated by one thread at a time
+static const uint RowChunk = 64;
+
+void generateHamOvl(cxmat &hmat, cxmat &smat, const cxhamparams &p, 
+        const AtomicStructView &bi, const AtomicStructView &bj, uint nthreads)
+{
+    BlockSites si(bi), sj(bj);
+    uint nai = bi.NumOfAtoms();
+    hmat = zeros<cxmat>(si.io(nai), sj.io(bj.NumOfAtoms()));
+    smat = zeros<cxmat>(si.io(nai), sj.io(bj.NumOfAtoms()));
+
+    vector<vector<uint> > neigh = neighborPairs(bi, bj, p.cutoff());
+    
+    uint nchunks = (nai + RowChunk - 1)/RowChunk;
+    parallelFor(nchunks, nthreads, [&](uint ic){
+        generateHamOvlRows(hmat, smat, p, si, sj, neigh, ic*RowChunk, 
+                std::min(nai, (ic + 1)*RowChunk));
+    });
+}
+
+void generateHamOvl(vector<cxmat> &hmat, vector<cxmat> &smat, 
+        const cxhamparams &p, const vector<AtomicStruct> &bi, 
+        const vector<AtomicStruct> &bj, uint nthreads)
+{
+    if (bi.size() != bj.size()){
+        throw invalid_argument("In generateHamOvl(): bi and bj must have the same number of blocks.");
+    }
+    
+    hmat.assign(bi.size(), cxmat());
+    smat.assign(bi.size(), cxmat());
+    parallelFor(bi.size(), nthreads, [&](uint ib){
+        generateHamOvl(hmat[ib], smat[ib], p, AtomicStructView(bi[ib]), 
+                AtomicStructView(bj[ib]));
+    });
+}
+
+vector<shared_ptr<BondHam> > generateBonds(const cxhamparams &p, 
+        const vector<AtomicStruct> &bi, const vector<AtomicStruct> &bj, 
+        uint nthreads)
+{
+    if (bi.size() != bj.size()){
+        throw invalid_argument("In generateBonds(): bi and bj must have the same number of blocks.");
+    }
+    
+    vector<shared_ptr<BondHam> > bonds(bi.size());
+    parallelFor(bi.size(), nthreads, [&](uint ib){
+        bonds[ib] = make_shared<BondHam>(p, AtomicStructView(bi[ib]), 
+                AtomicStructView(bj[ib]));
+    });
+    
+    return bonds;
+}
+
+}
+}
+
@@ -43,79 +43,84 @@ string GrapheneTbParams::toString() const {
 void GrapheneTbParams::update(){
 }
 
-cxmat GrapheneTbParams::twoAtomHam(const AtomicStruct& atomi, 
-        const AtomicStruct& atomj) const
-{
-    double d, dx, dy, dz;
-    int noi = atomi.NumOfOrbitals();
-    int noj = atomj.NumOfOrbitals();
-
-    cxmat hmat =  zeros<cxmat>(noi, noj);
+string GrapheneTbParams::fingerprint() const {
+    string fp = cxhamparams::fingerprint();
+    addFingerprint(fp, mec);
+    addFingerprint(fp, mdi0);
+    addFingerprint(fp, mti0);
+    addFingerprint(fp, mdo0);
+    addFingerprint(fp, mto0);
+    addFingerprint(fp, mdoX);
+    addFingerprint(fp, mlmdz);
+    addFingerprint(fp, mlmdxy);
+    addFingerprint(fp, malpha);
+    return fp;
+}
 
+bool GrapheneTbParams::pairHam(const double *ri, int si, const double *rj, 
+        int sj, dcmplx *out, uword ld) const
+{
+    // C-C
+    if (si != CarbonID || sj != CarbonID){
+        return false;
+    }
+    
     // calculate distance between atom i and atom j
-    dx = atomi.X(0) - atomj.X(0);
-    dy = atomi.Y(0) - atomj.Y(0);           
-    dz = atomi.Z(0) - atomj.Z(0);
-    d = sqrt(dx*dx + dy*dy + dz*dz);
+    double dx = ri[0] - rj[0];
+    double dy = ri[1] - rj[1];
+    double dz = ri[2] - rj[2];
+    double d = sqrt(dx*dx + dy*dy + dz*dz);
 
     // Assign the the matrix elements based on the distance between 
     // the atoms
-    // C-C
-    if (atomi.Symbol(0) == "C" && atomj.Symbol(0) == "C"){
-
-        dz = abs(dz); // inter-plane distance
-
-        // site energy
-        if (d <= mdtol){ 
-            hmat(0,0) = mec;
-        // in-plane first nearest neighbor
-        }else if (dz <= mdtol && abs(d - mdi0) <= mdtol){
-            hmat(0,0) = -mti0;
-        /*// out-of-plane first nearest neighbors
-        }else if (abs(delz - do0cc) <= dtol && abs(d - do0cc) <= dtol){
-            hmat(ia,ja) = -to0cc;
-        }*/
-        // out-of-plane some nearest neighbors
-        }else if (abs(dz - mdo0) <= mdtol && abs(d - mdo0) <= (mdoX*mdi0 + mdtol)){
-            // PRB 84, 195421 (2011)
-            // DBG hmat(ia,ja) = -to0cc*exp(-3.0*(d - do0cc));
-
-            // PRL 109, 236604 (2012)
-            double dxy = sqrt(dx*dx + dy*dy);
-            hmat(0,0) = -mto0*exp(-(d - mdo0)/mlmdz)*exp(-pow(dxy/mlmdxy, malpha));
-        }
+    dz = abs(dz); // inter-plane distance
+
+    // site energy
+    if (d <= mdtol){ 
+        out[0] = mec;
+    // in-plane first nearest neighbor
+    }else if (dz <= mdtol && abs(d - mdi0) <= mdtol){
+        out[0] = -mti0;
+    /*// out-of-plane first nearest neighbors
+    }else if (abs(delz - do0cc) <= dtol && abs(d - do0cc) <= dtol){
+        hmat(ia,ja) = -to0cc;
+    }*/
+    // out-of-plane some nearest neighbors
+    }else if (abs(dz - mdo0) <= mdtol && abs(d - mdo0) <= (mdoX*mdi0 + mdtol)){
+        // PRB 84, 195421 (2011)
+        // DBG hmat(ia,ja) = -to0cc*exp(-3.0*(d - do0cc));
+
+        // PRL 109, 236604 (2012)
+        double dxy = sqrt(dx*dx + dy*dy);
+        out[0] = -mto0*exp(-(d - mdo0)/mlmdz)*exp(-pow(dxy/mlmdxy, malpha));
+    }else{
+        return false;
     }
     
-    return hmat;
+    return true;
 };
 
-cxmat GrapheneTbParams::twoAtomOvl(const AtomicStruct& atomi, 
-        const AtomicStruct& atomj) const
+bool GrapheneTbParams::pairOvl(const double *ri, int si, const double *rj, 
+        int sj, dcmplx *out, uword ld) const
 {
-    float d, dx, dy, dz;
-    int noi = atomi.NumOfOrbitals();
-    int noj = atomj.NumOfOrbitals();
-
-    cxmat smat =  zeros<cxmat>(noi, noj);
-
-    // calculate distance between atom i and atom j
-    dx = atomi.X(0) - atomj.X(0);
-    dy = atomi.Y(0) - atomj.Y(0);           
-    dz = atomi.Z(0) - atomj.Z(0);
-    d = sqrt(dx*dx + dy*dy + dz*dz);
-
-    // Assign the the matrix elements based on the distance between 
-    // the atoms
     // C-C
-    if (atomi.Symbol(0) == "C" && atomj.Symbol(0) == "C"){
-        dz = abs(dz); // inter-plane distance
-        // site energy
-        if (d <= mdtol){ 
-            smat = eye<cxmat>(noi, noj);
-        }
+    if (si != CarbonID || sj != CarbonID){
+        return false;
+    }
+    
+    // calculate distance between atom i and atom j
+    double dx = ri[0] - rj[0];
+    double dy = ri[1] - rj[1];
+    double dz = ri[2] - rj[2];
+    double d = sqrt(dx*dx + dy*dy + dz*dz);
+
+    // site energy, one p_z orbital per carbon atom
+    if (d <= mdtol){ 
+        out[0] = 1;
+        return true;
     }
     
-    return smat;
+    return false;
 };
 
 
@@ -86,15 +86,14 @@ void KPoints::addKRect(const point& lb, const point& rt, uint nkx, uint nky){
     // generate kx and ky
     newkx = linspace<row>(kxmin, kxmax, nkx);
     newky = linspace<col>(kymin, kymax, nky);
-    // insert the new k-points
+    // all the new k-points, inserted at once
+    mat newk(nkx*nky,3);
     for(uint ikx = 0; ikx < nkx; ++ikx){
-        mat newk(nky,3);
-
-        newk.col(coord::X).fill(newkx(ikx));
-        newk.col(coord::Y) = newky;
-        newk.col(coord::Z).zeros();         
-        mk.insert_rows(mk.n_rows,newk);
+        newk(span(ikx*nky, (ikx+1)*nky-1), coord::X).fill(newkx(ikx));
+        newk(span(ikx*nky, (ikx+1)*nky-1), coord::Y) = newky;
     }
+    newk.col(coord::Z).zeros();         
+    mk.insert_rows(mk.n_rows,newk);
 }
 
 mat KPoints::kp(){
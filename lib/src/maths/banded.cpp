@@ -0,0 +1,161 @@
+/*
+ * File:   banded.cpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 3:20 PM
+ */
+
+#include "maths/banded.h"
+
+#include <algorithm>
+#include <queue>
+
+// LAPACK band LU.
+extern "C" {
+void zgbtrf_(const int* m, const int* n, const int* kl, const int* ku,
+        std::complex<double>* ab, const int* ldab, int* ipiv, int* info);
+void zgbtrs_(const char* trans, const int* n, const int* kl, const int* ku,
+        const int* nrhs, const std::complex<double>* ab, const int* ldab,
+        const int* ipiv, std::complex<double>* b, const int* ldb, int* info);
+}
+
+namespace maths{
+
+uwcol rcm(const cxmat &A, double tol){
+    uword n = A.n_rows;
+
+    // adjacency list of A + A'
+    vector<vector<uword> > adj(n);
+    for (uword j = 0; j < n; ++j){
+        for (uword i = j+1; i < n; ++i){
+            if (std::abs(A(i, j)) > tol || std::abs(A(j, i)) > tol){
+                adj[i].push_back(j);
+                adj[j].push_back(i);
+            }
+        }
+    }
+
+    // neighbours are visited from the lowest degree.
+    struct byDegree{
+        const vector<vector<uword> > &adj;
+        byDegree(const vector<vector<uword> > &adj):adj(adj){};
+        bool operator()(uword a, uword b) const {
+            return adj[a].size() < adj[b].size();
+        };
+    } lessDegree(adj);
+
+    vector<bool> visited(n, false);
+    vector<uword> order;
+    order.reserve(n);
+    while (order.size() < n){
+        // start each connected component from its lowest degree node.
+        uword start = n;
+        for (uword i = 0; i < n; ++i){
+            if (!visited[i] && (start == n || lessDegree(i, start))){
+                start = i;
+            }
+        }
+
+        std::queue<uword> Q;
+        Q.push(start);
+        visited[start] = true;
+        while (!Q.empty()){
+            uword i = Q.front();
+            Q.pop();
+            order.push_back(i);
+
+            vector<uword> next;
+            for (uword k = 0; k < adj[i].size(); ++k){
+                if (!visited[adj[i][k]]){
+                    visited[adj[i][k]] = true;
+                    next.push_back(adj[i][k]);
+                }
+            }
+            std::stable_sort(next.begin(), next.end(), lessDegree);
+            for (uword k = 0; k < next.size(); ++k){
+                Q.push(next[k]);
+            }
+        }
+    }
+
+    uwcol p(n);
+    for (uword i = 0; i < n; ++i){
+        p(i) = order[n-1-i];
+    }
+    return p;
+}
+
+uword bandwidth(const cxmat &A, double tol){
+    uword kb = 0;
+    for (uword j = 0; j < A.n_cols; ++j){
+        for (uword i = 0; i < A.n_rows; ++i){
+            uword d = (i > j) ? i - j : j - i;
+            if (d > kb && std::abs(A(i, j)) > tol){
+                kb = d;
+            }
+        }
+    }
+    return kb;
+}
+
+uwcol nonzeroRows(const cxmat &A, double tol){
+    vector<uword> rows;
+    for (uword i = 0; i < A.n_rows; ++i){
+        for (uword j = 0; j < A.n_cols; ++j){
+            if (std::abs(A(i, j)) > tol){
+                rows.push_back(i);
+                break;
+            }
+        }
+    }
+    return conv_to<uwcol>::from(rows);
+}
+
+uwcol nonzeroCols(const cxmat &A, double tol){
+    return nonzeroRows(trans(A), tol);
+}
+
+bool invBanded(cxmat &Ainv, const cxmat &A, uword kb){
+    int n = A.n_rows;
+    int k = kb;
+    int ldab = 3*k + 1;
+
+    // LAPACK band storage: A(i, j) -> AB(2*kb + i - j, j)
+    cxmat AB(ldab, n, fill::zeros);
+    for (int j = 0; j < n; ++j){
+        int i0 = std::max(0, j - k);
+        int i1 = std::min(n - 1, j + k);
+        for (int i = i0; i <= i1; ++i){
+            AB(2*k + i - j, j) = A(i, j);
+        }
+    }
+
+    Col<int> ipiv(n);
+    int info = 0;
+    zgbtrf_(&n, &n, &k, &k, AB.memptr(), &ldab, ipiv.memptr(), &info);
+    if (info != 0){
+        return false;
+    }
+
+    Ainv = eye<cxmat>(n, n);
+    char tr = 'N';
+    zgbtrs_(&tr, &n, &k, &k, &n, AB.memptr(), &ldab, ipiv.memptr(),
+            Ainv.memptr(), &n, &info);
+
+    return info == 0;
+}
+
+cxmat invUpdate(const cxmat &Ainv, const cxmat &SigPP, const uwcol &P){
+    if (P.is_empty()){
+        return Ainv;
+    }
+    // inv(A - E*Sig*E') = Ainv + Ainv*E*Sig*inv(I - E'*Ainv*E*Sig)*E'*Ainv
+    uword k = P.n_elem;
+    uword n = Ainv.n_rows;
+    uwcol all = linspace<uwcol>(0, n-1, n);
+    cxmat M = eye<cxmat>(k, k) - Ainv.submat(P, P)*SigPP;
+    return Ainv + Ainv.submat(all, P)*SigPP*arma::solve(M, Ainv.submat(P, all));
+}
+
+}
+
@@ -7,6 +7,8 @@
 
 #include "negf/CohRgfLoop.h"
 #include "negf/RgfResult.h"
+#include "utils/stringutils.h"
+#include "utils/atomicfile.h"
 
 namespace quest{
 namespace negf{
@@ -14,7 +16,7 @@ namespace negf{
 CohRgfLoop::CohRgfLoop(const Workers &workers, uint nb, double kT, dcmplx ieta, 
         bool orthogonal, uint nTransNeigh, string newprefix): Printable(newprefix), 
         mrgf(nb, kT, ieta, orthogonal, " " + newprefix), mbar("  NEGF: "),
-        mWorkers(workers) 
+        mWorkers(workers), mprof(" " + newprefix)
 {    
     mH0.set_size(nb, nTransNeigh+1);
     mS0.set_size(nb, nTransNeigh+1);
@@ -26,6 +28,26 @@ CohRgfLoop::CohRgfLoop(const Workers &workers, uint nb, double kT, dcmplx ieta,
     mV.set_size(nb);
     
     integrateOverKpoints = false;
+    msplitSectors = false;
+    mcheckpointInterval = 300;
+    mcheckpointHash = 0;
+    mrestart = false;
+    
+    // in the order of RgfPhase
+    mprof.addPhase("H(k) assembly");
+    mprof.addPhase("Surface GF");
+    mprof.addPhase("Forward sweep");
+    mprof.addPhase("Backward sweep");
+    mprof.addPhase("Transmission");
+    mprof.addPhase("Current");
+    mprof.addPhase("Bond currents");
+    mprof.addPhase("DOS");
+    mprof.addPhase("LDOS map");
+    mprof.addPhase("Electron density");
+    mprof.addPhase("Hole density");
+    mprof.addPhase("Gather");
+    mprof.addPhase("Save");
+    mrgf.profiler(&mprof);
 }
 
 void CohRgfLoop::E(const vec &E){
@@ -143,11 +165,25 @@ void CohRgfLoop::enableI(uint N, uint ib, uint jb){
     mThisIop.push_back(cxmat_vec());
 }
 
+void CohRgfLoop::enableIMap(uint N){
+    mIMap.tag = "CURRENT";
+    mIMap.N = N;
+    mIMap.ib = 0;
+    mIMap.jb = mrgf.nb()-1;
+}
+
 void CohRgfLoop::enableDOS(uint N){
     mDOS.tag = "DOS";
     mDOS.N = N;
 }
 
+void CohRgfLoop::enableLDOSMap(){
+    mLDOSMap.tag = "LDOS_MAP";
+    mLDOSMap.N = 1;
+    mLDOSMap.ib = 1;
+    mLDOSMap.jb = mrgf.nb()-2;
+}
+
 void CohRgfLoop::enablen(uint N, int ib){    
     mnOp.push_back(RgfResult("n", N, ib, ib));
     mThisnOp.push_back(cxmat_vec());
@@ -164,6 +200,45 @@ void CohRgfLoop::atomsTracedOver(shared_ptr<ucol> atomsTracedOver){
     matomsTracedOver = atomsTracedOver;
 }
 
+void CohRgfLoop::decimate(bool enable){
+    mrgf.decimate(enable);
+}
+
+void CohRgfLoop::banded(bool enable){
+    mrgf.banded(enable);
+}
+
+void CohRgfLoop::sectors(bool enable){
+    msplitSectors = enable;
+}
+
+void CohRgfLoop::profile(bool enable){
+    mprof.enable(enable);
+}
+
+void CohRgfLoop::checkpoint(string fileName, double interval){
+    mcheckpoint = fileName;
+    mcheckpointInterval = interval;
+}
+
+void CohRgfLoop::restart(bool enable){
+    mrestart = enable;
+}
+
+void CohRgfLoop::addBias(double muD, double muS){
+    mBiasV.push_back(mV);
+    mBiasMuD.push_back(muD);
+    mBiasMuS.push_back(muS);
+}
+
+void CohRgfLoop::clearBias(){
+    mBiasV.clear();
+    mBiasMuD.clear();
+    mBiasMuS.clear();
+    mBiasThis.clear();
+    mBiasAll.clear();
+}
+
 string CohRgfLoop::toString() const {
     stringstream out;
     out << mrgf;
@@ -172,91 +247,257 @@ string CohRgfLoop::toString() const {
 }
 
 void CohRgfLoop::run(){
+    // the profile of each run is printed on its own.
+    mprof.reset();
+    
+    if (!mBiasV.empty()){
+        if (msplitSectors || !mcheckpoint.empty()){
+            vout << vnormal << endl << mPrefix 
+                 << " Sectors and checkpoints are not used in a bias sweep." << endl;
+        }
+        mbar.expectedCount(npoints()*mBiasV.size());
+        prepare();
+        runBias();
+        mWorkers.Comm().barrier();
+        mbar.complete();
+        collectBias();
+    }else{
+        runAll();
+    }
+    
+    if (mprof.enabled()){
+        mprof.reduce(mWorkers.Comm(), mWorkers.MasterId());
+        if (mWorkers.IAmMaster()){
+            vout << vnormal << endl << mprof << endl;
+        }
+    }
+}
+
+/*
+ * Runs all the E and k points at the current bias.
+ */
+void CohRgfLoop::runAll(){
+    
+    // Find the independent sectors of the Hamiltonian.
+    field<uwcol> sectors;
+    if (msplitSectors && canSplitSectors()){
+        sectors = findSectors(mH0, mHl, mS0, mSl);
+    }
+    mbar.expectedCount(npoints()*(sectors.n_rows > 1 ? sectors.n_rows:1));
     
     prepare();
 
+    if (sectors.n_rows > 1){
+        if (!mcheckpoint.empty()){
+            vout << vnormal << endl << mPrefix 
+                 << " Checkpoints are not used with sectors." << endl;
+        }
+        runSectors(sectors);
+    }else{
+        runPoints(!mcheckpoint.empty());
+    }
+    
+    mWorkers.Comm().barrier();
+    mbar.complete();
+    collect();
+}
+
+/*
+ * Runs the sectors one after another and sums up the results. The 
+ * blocks of each sector are cut out of the full H0, Hl, S0, Sl and V.
+ */
+void CohRgfLoop::runSectors(const field<uwcol> &sectors){
+    uint nb = mrgf.nb();
+    
+    // keep the full blocks.
+    field<shared_ptr<cxmat> > H0 = mH0, S0 = mS0, Hl = mHl, Sl = mSl;
+    field<shared_ptr<vec> > V = mV;
+    
+    // results of the previous runs are put aside.
+    vector<cxmat_vec*> results = localResults();
+    vector<cxmat_vec> before(results.size()), sum(results.size());
+    for (int ir = 0; ir < results.size(); ++ir){
+        before[ir].swap(*results[ir]);
+    }
+    
+    // the full blocks and the earlier results are put back even if a 
+    // sector fails.
+    auto restore = [&](){
+        mH0 = H0;
+        mS0 = S0;
+        mHl = Hl;
+        mSl = Sl;
+        mV = V;
+        for (int ir = 0; ir < results.size(); ++ir){
+            results[ir]->swap(before[ir]);
+        }
+    };
+    
+    try{
+        for (uint is = 0; is < sectors.n_rows; ++is){
+            for (uint ib = 0; ib <= nb; ++ib){
+                // rows and columns of the lower diagonal blocks
+                const uwcol &ir = sectors(is, (ib == nb) ? nb-1:ib);
+                const uwcol &ic = sectors(is, (ib == 0) ? 0:ib-1);
+                for (uint in = 0; in < mHl.n_cols; ++in){
+                    if (Hl(ib, in)){
+                        mHl(ib, in) = make_shared<cxmat>(Hl(ib, in)->submat(ir, ic));
+                    }
+                    if (Sl(ib, in)){
+                        mSl(ib, in) = make_shared<cxmat>(Sl(ib, in)->submat(ir, ic));
+                    }
+                }
+                if (ib == nb){
+                    continue;
+                }
+                for (uint in = 0; in < mH0.n_cols; ++in){
+                    if (H0(ib, in)){
+                        mH0(ib, in) = make_shared<cxmat>(H0(ib, in)->submat(ir, ir));
+                    }
+                    if (S0(ib, in)){
+                        mS0(ib, in) = make_shared<cxmat>(S0(ib, in)->submat(ir, ir));
+                    }
+                }
+                if (V(ib)){
+                    mV(ib) = make_shared<vec>(V(ib)->elem(ir));
+                }
+            }
+        
+            runPoints();
+        
+            // traced results are additive.
+            for (int ir = 0; ir < results.size(); ++ir){
+                if (sum[ir].empty()){
+                    sum[ir].swap(*results[ir]);
+                }else{
+                    for (int it = 0; it < sum[ir].size(); ++it){
+                        sum[ir][it] += (*results[ir])[it];
+                    }
+                    results[ir]->clear();
+                }
+            }
+        }
+    }catch(...){
+        restore();
+        throw;
+    }
+    
+    restore();
+    for (int ir = 0; ir < results.size(); ++ir){
+        results[ir]->insert(results[ir]->end(), sum[ir].begin(), sum[ir].end());
+    }
+}
+
+/*
+ * Results of the sectors can be summed up only if they are traced over 
+ * all the orbitals.
+ */
+bool CohRgfLoop::canSplitSectors(){
+    bool traced = !matomsTracedOver && !mLDOSMap.isEnabled() && mTE.N <= 1 
+            && mIMap.N <= 1 && mDOS.N <= 1;
+    for (int it = 0; it < mIop.size(); ++it){
+        traced = traced && mIop[it].N <= 1;
+    }
+    for (int it = 0; it < mnOp.size(); ++it){
+        traced = traced && mnOp[it].N <= 1;
+    }
+    for (int it = 0; it < mpOp.size(); ++it){
+        traced = traced && mpOp[it].N <= 1;
+    }
+    if (!traced){
+        vout << vnormal << endl << mPrefix 
+             << " Sectors are not used: all the results need to be traced over all the orbitals (N = 1)." << endl;
+    }
+    return traced;
+}
+
+/*
+ * Local results of all the enabled calculations.
+ */
+vector<CohRgfLoop::cxmat_vec*> CohRgfLoop::localResults(){
+    vector<cxmat_vec*> results;
+    results.push_back(&mThisTE);
+    results.push_back(&mThisIMap);
+    results.push_back(&mThisDOS);
+    results.push_back(&mThisLDOSMap);
+    for (int it = 0; it < mThisIop.size(); ++it){
+        results.push_back(&mThisIop[it]);
+    }
+    for (int it = 0; it < mThisnOp.size(); ++it){
+        results.push_back(&mThisnOp[it]);
+    }
+    for (int it = 0; it < mThispOp.size(); ++it){
+        results.push_back(&mThispOp[it]);
+    }
+    return results;
+}
+
+/*
+ * Results of all the processes in the same order as localResults().
+ */
+vector<RgfResult*> CohRgfLoop::allResults(){
+    vector<RgfResult*> results;
+    results.push_back(&mTE);
+    results.push_back(&mIMap);
+    results.push_back(&mDOS);
+    results.push_back(&mLDOSMap);
+    for (int it = 0; it < mIop.size(); ++it){
+        results.push_back(&mIop[it]);
+    }
+    for (int it = 0; it < mnOp.size(); ++it){
+        results.push_back(&mnOp[it]);
+    }
+    for (int it = 0; it < mpOp.size(); ++it){
+        results.push_back(&mpOp[it]);
+    }
+    return results;
+}
+
+/*
+ * Loops over the E and k points assigned to this process. With checkpoint, 
+ * the results of the finished points are saved every mcheckpointInterval 
+ * seconds and, on restart, the points found in the checkpoint are skipped.
+ */
+void CohRgfLoop::runPoints(bool checkpoint){
+    typedef std::chrono::steady_clock clock;
+    
     long n = npoints();
     long nE = mE.n_rows;
-    long nk = mk.n_rows;
-    uint nb = mrgf.nb();
     
     long myStart, myEnd, myN;
     // Assign E and k points to CPUs 
     mWorkers.assignCpus(myStart, myEnd, myN, n);
+    
+    // results of the previous runs are not part of the checkpoint.
+    vector<cxmat_vec*> results = localResults();
+    vector<size_t> offsets(results.size());
+    for (int ir = 0; ir < results.size(); ++ir){
+        offsets[ir] = results[ir]->size();
+    }
+    
+    // the blocks are hashed once, they do not change during the run.
+    if (checkpoint){
+        mcheckpointHash = checkpointHash();
+    }
+    
+    long ndone = 0;
+    if (checkpoint && mrestart){
+        ndone = loadCheckpoint(myStart, myEnd);
+        for (long it = 0; it < ndone; ++it){
+            ++mbar;
+        }
+    }
+    clock::time_point lastSaved = clock::now();
+    
     // Loop over problem assigned to this CPU.
     long ik, ikPrev = -1, iE;
-    for(long it = myStart; it <= myEnd; ++it){
+    for(long it = myStart + ndone; it <= myEnd; ++it){
         
         ik = it/nE;
         iE = it%nE;
         
         if (ik != ikPrev){ // change H and S matrices only for new k vectors.
-            // Hamiltonian and overlap matrices. 
-            field<shared_ptr<cxmat> > H0(nb);
-            field<shared_ptr<cxmat> > S0(nb);
-            field<shared_ptr<cxmat> > Hl(nb+1);
-            field<shared_ptr<cxmat> > Sl(nb+1);
-
-            if (nk != 0){ // Do a k-loop
-                //@TODO: Needs memory optimization.
-                row k = mk.row(ik);
-
-                // Calculate block diagonal matrices.
-                for(int ib = 0; ib < nb; ++ib){
-                    shared_ptr<cxmat> H0k = make_shared<cxmat>(mH0(ib,0)->n_rows, mH0(ib,0)->n_cols, fill::zeros);
-                    shared_ptr<cxmat> S0k;
-                    if (!mrgf.OrthoBasis()){
-                        S0k = make_shared<cxmat>(mS0(ib,0)->n_rows, mS0(ib,0)->n_cols, fill::zeros);
-                    }else{
-                        S0k = make_shared<cxmat>(mS0(ib,0)->n_rows, mS0(ib,0)->n_cols, fill::eye);
-                    }
-
-                    double th;
-                    dcmplx expith;
-                    for(int in = 0; in < mH0.n_cols; ++in){
-                        th = dot(k, *mpv0(ib, in));
-                        expith = exp(i*th);
-                        (*H0k) = (*H0k) + (*mH0(ib, in))*expith; 
-                        if (!mrgf.OrthoBasis()){
-                            (*S0k) = (*S0k) + (*mS0(ib, in))*expith;
-                        }
-                    }
-                    H0(ib) = H0k;
-                    S0(ib) = S0k;
-                }
-                // Calculate lower block diagonals
-                for(int ib = 0; ib <= nb; ++ib){
-                    shared_ptr<cxmat> Hlk = make_shared<cxmat>(mHl(ib,0)->n_rows, mHl(ib,0)->n_cols, fill::zeros);
-                    shared_ptr<cxmat> Slk;
-                    if (!mrgf.OrthoBasis()){
-                        Slk = make_shared<cxmat>(mSl(ib,0)->n_rows, mSl(ib,0)->n_cols, fill::zeros);
-                    }
-                    double th;
-                    dcmplx expith;
-                    for(int in = 0; in < mHl.n_cols; ++in){
-                        th = dot(k, *mpvl(in));
-                        expith = exp(i*th);
-                        (*Hlk) = (*Hlk) + (*mHl(ib, in))*expith;
-                        if (!mrgf.OrthoBasis()){
-                            (*Slk) = (*Slk) + (*mSl(ib, in))*expith;
-                        }
-                    }
-                    Hl(ib) = Hlk;
-                    if (!mrgf.OrthoBasis()){
-                        Sl(ib) = Slk;
-                    }
-                }
-            }else{ // Do only E loop
-                H0 = mH0.col(0);
-                S0 = mS0.col(0);
-                Hl = mHl.col(0);
-                Sl = mSl.col(0);                   
-            }
-            // set H and S.
-            mrgf.H(H0, Hl);
-            mrgf.S(S0, Sl);
-            mrgf.V(mV);
-            
+            setHk(ik);
             ikPrev = ik;
         }
         
@@ -266,10 +507,316 @@ void CohRgfLoop::run(){
         // run simulation step.
         compute();
         ++mbar;                // Show feedback        
+        
+        if (checkpoint && std::chrono::duration<double>(clock::now() 
+                - lastSaved).count() >= mcheckpointInterval)
+        {
+            saveCheckpoint(myStart, myEnd, it - myStart + 1, offsets);
+            lastSaved = clock::now();
+        }
     }
     
-    collect();
+    if (checkpoint){
+        saveCheckpoint(myStart, myEnd, myEnd - myStart + 1, offsets);
+    }
+}
+
+/*
+ * Bias sweep. For each E and k point, the bias points are run one after 
+ * another at the same energy. Between two bias points CohRgfa::updateV() 
+ * keeps the Green functions of the blocks outside the changed region, and 
+ * the surface Green functions of the contacts are reused when E+V repeats. 
+ * The results of each bias point are kept in mBiasThis.
+ */
+void CohRgfLoop::runBias(){
+    long n = npoints();
+    long nE = mE.n_rows;
+    uint nbias = mBiasV.size();
+    
+    long myStart, myEnd, myN;
+    // Assign E and k points to CPUs 
+    mWorkers.assignCpus(myStart, myEnd, myN, n);
+    
+    vector<cxmat_vec*> results = localResults();
+    mBiasThis.assign(nbias, vector<cxmat_vec>(results.size()));
+    
+    mrgf.surfaceGCache(true);
+    long ik, ikPrev = -1, iE;
+    for(long it = myStart; it <= myEnd; ++it){
+        ik = it/nE;
+        iE = it%nE;
+        
+        if (ik != ikPrev){
+            setHk(ik);
+            ikPrev = ik;
+        }
+        mrgf.E(mE[iE]);
+        
+        for (uint ib = 0; ib < nbias; ++ib){
+            mrgf.mu(mBiasMuD[ib], mBiasMuS[ib]);
+            mrgf.updateV(mBiasV[ib]);
+            
+            // compute() stores to the local results of this bias point.
+            for (int ir = 0; ir < results.size(); ++ir){
+                results[ir]->swap(mBiasThis[ib][ir]);
+            }
+            compute();
+            for (int ir = 0; ir < results.size(); ++ir){
+                results[ir]->swap(mBiasThis[ib][ir]);
+            }
+            ++mbar;
+        }
+    }
+    mrgf.surfaceGCache(false);
+}
+
+/*
+ * Gathers the results of each bias point into mBiasAll.
+ */
+void CohRgfLoop::collectBias(){
+    uint nbias = mBiasV.size();
+    vector<cxmat_vec*> results = localResults();
+    vector<RgfResult*> all = allResults();
+    mBiasAll.assign(nbias, vector<list<cxmat> >(all.size()));
+    
+    for (uint ib = 0; ib < nbias; ++ib){
+        for (int ir = 0; ir < results.size(); ++ir){
+            results[ir]->swap(mBiasThis[ib][ir]);
+            all[ir]->R.clear();
+        }
+        collect();
+        for (int ir = 0; ir < results.size(); ++ir){
+            results[ir]->swap(mBiasThis[ib][ir]);
+            all[ir]->R.swap(mBiasAll[ib][ir]);
+        }
+    }
+}
+
+/*
+ * FNV-1a hash of n bytes, continued from h.
+ */
+static unsigned long long hashBytes(unsigned long long h, const void *data, size_t n){
+    const unsigned char *b = static_cast<const unsigned char*>(data);
+    for (size_t ib = 0; ib < n; ++ib){
+        h ^= b[ib];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/*
+ * Hash of the sizes and contents of the blocks, continued from h. A block 
+ * that is not set counts as an empty one.
+ */
+template<class T>
+static unsigned long long hashBlocks(unsigned long long h, 
+        const field<shared_ptr<T> > &blocks)
+{
+    for (uint ib = 0; ib < blocks.n_elem; ++ib){
+        const shared_ptr<T> &b = blocks(ib);
+        unsigned long long dims[2] = {b ? b->n_rows:0, b ? b->n_cols:0};
+        h = hashBytes(h, dims, sizeof(dims));
+        if (b){
+            h = hashBytes(h, b->memptr(), b->n_elem*sizeof(typename T::elem_type));
+        }
+    }
+    return h;
+}
+
+/*
+ * Fingerprint of the calculation a checkpoint belongs to: the device (H, S,
+ * V and the position vectors of the blocks), the run parameters (kT, ieta, 
+ * mu, basis, E and k grids, atoms traced over) and the tags, sizes and 
+ * blocks of the enabled results.
+ */
+unsigned long long CohRgfLoop::checkpointHash(){
+    unsigned long long h = 14695981039346656037ULL;
+    
+    uint nb = mrgf.nb();
+    double kT = mrgf.kT(), muS = mrgf.muS(), muD = mrgf.muD();
+    dcmplx ieta = mrgf.ieta();
+    bool orthogonal = mrgf.OrthoBasis();
+    h = hashBytes(h, &nb, sizeof(nb));
+    h = hashBytes(h, &kT, sizeof(kT));
+    h = hashBytes(h, &ieta, sizeof(ieta));
+    h = hashBytes(h, &muS, sizeof(muS));
+    h = hashBytes(h, &muD, sizeof(muD));
+    h = hashBytes(h, &orthogonal, sizeof(orthogonal));
+    
+    h = hashBlocks(h, mH0);
+    h = hashBlocks(h, mHl);
+    if (!orthogonal){
+        h = hashBlocks(h, mS0);
+        h = hashBlocks(h, mSl);
+    }
+    h = hashBlocks(h, mV);
+    h = hashBlocks(h, mpv0);
+    h = hashBlocks(h, mpvl);
+    
+    h = hashBytes(h, mE.memptr(), mE.n_elem*sizeof(double));
+    h = hashBytes(h, mk.memptr(), mk.n_elem*sizeof(double));
+    if (matomsTracedOver){
+        h = hashBytes(h, matomsTracedOver->memptr(), 
+                matomsTracedOver->n_elem*sizeof(uint));
+    }
+    
+    vector<RgfResult*> results = allResults();
+    for (int ir = 0; ir < results.size(); ++ir){
+        const RgfResult &r = *results[ir];
+        h = hashBytes(h, r.tag.data(), r.tag.size() + 1);
+        h = hashBytes(h, &r.N, sizeof(r.N));
+        h = hashBytes(h, &r.ib, sizeof(r.ib));
+        h = hashBytes(h, &r.jb, sizeof(r.jb));
+    }
+    return h;
+}
+
+/*
+ * One checkpoint file per process.
+ */
+string CohRgfLoop::checkpointFile(){
+    stringstream fileName;
+    fileName << mcheckpoint << "." << mWorkers.MyId();
+    return fileName.str();
+}
+
+/*
+ * Saves the number of points finished by this process and their results. 
+ * A crash while saving keeps the last checkpoint.
+ */
+void CohRgfLoop::saveCheckpoint(long myStart, long myEnd, long ndone, 
+        const vector<size_t> &offsets)
+{
+    utils::writeAtomically(checkpointFile(), 
+            [this, myStart, myEnd, ndone, &offsets](ofstream &out){
+        boost::archive::binary_oarchive oa(out);
+        
+        long n = npoints();
+        int nprocs = mWorkers.N();
+        vector<cxmat_vec*> results = localResults();
+        size_t nr = results.size();
+        unsigned long long hash = mcheckpointHash;
+        oa << nprocs << n << myStart << myEnd << ndone << nr << hash;
+        for (int ir = 0; ir < nr; ++ir){
+            cxmat_vec r(results[ir]->begin() + offsets[ir], results[ir]->end());
+            oa << r;
+        }
+    }, "CohRgfLoop::saveCheckpoint()");
+}
+
+/*
+ * Loads the results of the finished points from the checkpoint of this 
+ * process. Returns the number of finished points, zero if there is no 
+ * checkpoint.
+ */
+long CohRgfLoop::loadCheckpoint(long myStart, long myEnd){
+    string fileName = checkpointFile();
+    ifstream in(fileName.c_str(), ios::binary);
+    if (!in.is_open()){
+        return 0;
+    }
+    boost::archive::binary_iarchive ia(in);
+
+    int nprocs;
+    long n, start, end, ndone;
+    size_t nr;
+    unsigned long long hash;
+    ia >> nprocs >> n >> start >> end >> ndone >> nr >> hash;
+    
+    // the same number of points and results is not enough: the device, the
+    // run parameters and the enabled results must be the same too.
+    vector<cxmat_vec*> results = localResults();
+    if (nprocs != mWorkers.N() || n != npoints() || start != myStart 
+            || end != myEnd || nr != results.size() || hash != mcheckpointHash)
+    {
+        throw runtime_error("In CohRgfLoop::loadCheckpoint(): " + fileName 
+                + " does not match with this calculation.");
+    }
+    for (int ir = 0; ir < nr; ++ir){
+        cxmat_vec r;
+        ia >> r;
+        results[ir]->insert(results[ir]->end(), r.begin(), r.end());
+    }
+    
+    vout << vnormal << endl << mPrefix << " Restarting from " << fileName 
+         << ": " << ndone << " point(s) done." << endl;
     
+    return ndone;
+}
+
+/*
+ * Sets the Hamiltonian and overlap matrices of k-point ik.
+ */
+void CohRgfLoop::setHk(long ik){
+    long nk = mk.n_rows;
+    uint nb = mrgf.nb();
+    
+    Profiler::Scope prof(&mprof, RGF_HK);
+    // Hamiltonian and overlap matrices. 
+    field<shared_ptr<cxmat> > H0(nb);
+    field<shared_ptr<cxmat> > S0(nb);
+    field<shared_ptr<cxmat> > Hl(nb+1);
+    field<shared_ptr<cxmat> > Sl(nb+1);
+
+    if (nk != 0){ // Do a k-loop
+        //@TODO: Needs memory optimization.
+        row k = mk.row(ik);
+
+        // Calculate block diagonal matrices.
+        for(int ib = 0; ib < nb; ++ib){
+            shared_ptr<cxmat> H0k = make_shared<cxmat>(mH0(ib,0)->n_rows, mH0(ib,0)->n_cols, fill::zeros);
+            shared_ptr<cxmat> S0k;
+            if (!mrgf.OrthoBasis()){
+                S0k = make_shared<cxmat>(mS0(ib,0)->n_rows, mS0(ib,0)->n_cols, fill::zeros);
+            }else{
+                S0k = make_shared<cxmat>(mS0(ib,0)->n_rows, mS0(ib,0)->n_cols, fill::eye);
+            }
+
+            double th;
+            dcmplx expith;
+            for(int in = 0; in < mH0.n_cols; ++in){
+                th = dot(k, *mpv0(ib, in));
+                expith = exp(i*th);
+                (*H0k) = (*H0k) + (*mH0(ib, in))*expith; 
+                if (!mrgf.OrthoBasis()){
+                    (*S0k) = (*S0k) + (*mS0(ib, in))*expith;
+                }
+            }
+            H0(ib) = H0k;
+            S0(ib) = S0k;
+        }
+        // Calculate lower block diagonals
+        for(int ib = 0; ib <= nb; ++ib){
+            shared_ptr<cxmat> Hlk = make_shared<cxmat>(mHl(ib,0)->n_rows, mHl(ib,0)->n_cols, fill::zeros);
+            shared_ptr<cxmat> Slk;
+            if (!mrgf.OrthoBasis()){
+                Slk = make_shared<cxmat>(mSl(ib,0)->n_rows, mSl(ib,0)->n_cols, fill::zeros);
+            }
+            double th;
+            dcmplx expith;
+            for(int in = 0; in < mHl.n_cols; ++in){
+                th = dot(k, *mpvl(in));
+                expith = exp(i*th);
+                (*Hlk) = (*Hlk) + (*mHl(ib, in))*expith;
+                if (!mrgf.OrthoBasis()){
+                    (*Slk) = (*Slk) + (*mSl(ib, in))*expith;
+                }
+            }
+            Hl(ib) = Hlk;
+            if (!mrgf.OrthoBasis()){
+                Sl(ib) = Slk;
+            }
+        }
+    }else{ // Do only E loop
+        H0 = mH0.col(0);
+        S0 = mS0.col(0);
+        Hl = mHl.col(0);
+        Sl = mSl.col(0);                   
+    }
+    // set H and S.
+    mrgf.H(H0, Hl);
+    mrgf.S(S0, Sl);
+    mrgf.V(mV);
 }
 
 void CohRgfLoop::prepare() {
@@ -282,26 +829,43 @@ void CohRgfLoop::compute(){
     
     // Transmission
     if(mTE.isEnabled()){
+        Profiler::Scope prof(&mprof, RGF_TE);
         r = mrgf.TEop(mTE.N, matomsTracedOver.get());  // M => T(E)
         mThisTE.push_back(r);  
     }
     // Current
     for (int it = 0; it < mIop.size(); ++it){
+        Profiler::Scope prof(&mprof, RGF_I);
         r = mrgf.Iop(mIop[it].N,  mIop[it].ib, mIop[it].jb, matomsTracedOver.get()); 
         mThisIop[it].push_back(r);           // ThisIop[it] => vector of Iop()
     }
+    // Bond currents
+    if(mIMap.isEnabled()){
+        Profiler::Scope prof(&mprof, RGF_IMAP);
+        r = mrgf.IMapop(mIMap.N, matomsTracedOver.get());
+        mThisIMap.push_back(r);
+    }
     // Density of States
     if(mDOS.isEnabled()){
+        Profiler::Scope prof(&mprof, RGF_DOS);
         r = mrgf.DOSop(mDOS.N, matomsTracedOver.get());  // M => DOS(E)
         mThisDOS.push_back(r);  
     }
+    // LDOS and electron density map
+    if(mLDOSMap.isEnabled()){
+        Profiler::Scope prof(&mprof, RGF_LDOSMAP);
+        r = mrgf.LDOSMapop();
+        mThisLDOSMap.push_back(r);
+    }
     // Non-equilibrium electron density
     for (int it = 0; it < mnOp.size(); ++it){
+        Profiler::Scope prof(&mprof, RGF_N);
         r = mrgf.nOp(mnOp[it].N,  mnOp[it].ib, matomsTracedOver.get()); 
         mThisnOp[it].push_back(r);           // Thisnop[it] => vector of nop()
     }
     // Non-equilibrium hole density
     for (int it = 0; it < mpOp.size(); ++it){
+        Profiler::Scope prof(&mprof, RGF_P);
         r = mrgf.pOp(mpOp[it].N,  mpOp[it].ib, matomsTracedOver.get()); 
         mThispOp[it].push_back(r);        
     }    
@@ -309,10 +873,6 @@ void CohRgfLoop::compute(){
 }
 
 void CohRgfLoop::collect(){
-    // Update the progress bar.
-    mWorkers.Comm().barrier();
-    mbar.complete();
-    
     // Gather transmission
     if(mTE.isEnabled()){
         gather(mThisTE, mTE);
@@ -329,6 +889,14 @@ void CohRgfLoop::collect(){
         }
     }
 
+    // Gather bond currents
+    if(mIMap.isEnabled()){
+        gather(mThisIMap, mIMap);
+        if(integrateOverKpoints){
+            intOverKpoints(mIMap);
+        }
+    }
+
     // Gather Density of States
     if(mDOS.isEnabled()){
         gather(mThisDOS, mDOS);
@@ -337,6 +905,18 @@ void CohRgfLoop::collect(){
         }        
     }
 
+    // Gather LDOS map
+    if(mLDOSMap.isEnabled()){
+        gather(mThisLDOSMap, mLDOSMap);
+        if(integrateOverKpoints){
+            intOverKpoints(mLDOSMap);
+        }
+        // number of rows of the saved matrices.
+        if(!mLDOSMap.R.empty()){
+            mLDOSMap.N = mLDOSMap.R.front().n_rows;
+        }
+    }
+
     // Gather equilibrium electron density
     for (int it = 0; it < mnOp.size(); ++it){
         gather(mThisnOp[it], mnOp[it]);
@@ -356,6 +936,7 @@ void CohRgfLoop::collect(){
 }
 
 void CohRgfLoop::gather(cxmat_vec &thisR, RgfResult &all){
+    Profiler::Scope prof(&mprof, RGF_GATHER);
 
     if(!mWorkers.IAmMaster()){    
         // slaves send their local data
@@ -409,7 +990,7 @@ void CohRgfLoop::intOverKpoints(RgfResult& integrand){
     // simple sum
     cxmat sum;
     for (long iE = 0; iE < nE; ++iE){
-        sum = zeros<cxmat>(integrand.N, integrand.N);  
+        sum = zeros<cxmat>(result[iE].n_rows, result[iE].n_cols);  
         for (long ik = 0; ik < nk; ++ik){            
             sum = sum + result[ik*nE+iE];
         }
@@ -422,7 +1003,26 @@ long CohRgfLoop::npoints(){
     return n;
 }
 
+/*
+ * Saves the results of bias point ibias of the last bias sweep.
+ */
+void CohRgfLoop::saveBias(uint ibias, string fileName, bool isText){
+    if (ibias >= mBiasAll.size()){
+        throw invalid_argument("In CohRgfLoop::saveBias(): bias point " 
+                + utils::strings::itos(ibias) + " has not been run.");
+    }
+    vector<RgfResult*> all = allResults();
+    for (int ir = 0; ir < all.size(); ++ir){
+        all[ir]->R.swap(mBiasAll[ibias][ir]);
+    }
+    save(fileName, isText);
+    for (int ir = 0; ir < all.size(); ++ir){
+        all[ir]->R.swap(mBiasAll[ibias][ir]);
+    }
+}
+
 void CohRgfLoop::save(string fileName, bool isText){
+    Profiler::Scope prof(&mprof, RGF_SAVE);
     if(mWorkers.IAmMaster()){
         // save to a file
         
@@ -452,10 +1052,26 @@ void CohRgfLoop::save(string fileName, bool isText){
             for (int it = 0; it < mIop.size(); ++it){
                 mIop[it].save(out, isText);
             }
+            // Bond currents are saved the same way as the individual 
+            // currents I_i,i+1, one block for each bond.
+            if (mIMap.isEnabled()){
+                uint N = mIMap.N;
+                for (int ib = mIMap.ib; ib < mIMap.jb; ++ib){
+                    RgfResult Iij(mIMap.tag, N, ib, ib+1);
+                    for (RgfResult::iter it = mIMap.R.begin(); it != mIMap.R.end(); ++it){
+                        Iij.R.push_back(it->cols((ib-mIMap.ib)*N, (ib-mIMap.ib+1)*N-1));
+                    }
+                    Iij.save(out, isText);
+                }
+            }
             // Density of States
             if (mDOS.isEnabled()){
                 mDOS.save(out, isText);
             }
+            // LDOS map
+            if (mLDOSMap.isEnabled()){
+                mLDOSMap.save(out, isText);
+            }
             // Non-equilibrium electron density
             for (int it = 0; it < mnOp.size(); ++it){
                 mnOp[it].save(out, isText);
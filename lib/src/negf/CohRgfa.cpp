@@ -10,11 +10,27 @@
 namespace quest{
 namespace negf{
 
+/*
+ * Are two blocks the same? Same object or same size and same elements.
+ */
+template<class T>
+static bool isSameBlock(const shared_ptr<T> &A, const shared_ptr<T> &B){
+    if (A == B){
+        return true;
+    }
+    if (!A || !B){
+        return false;
+    }
+    return A->n_rows == B->n_rows && A->n_cols == B->n_cols 
+            && std::equal(A->begin(), A->end(), B->begin());
+}
+
 CohRgfa::CohRgfa(uint nb, double kT, dcmplx ieta, bool orthogonal, string newprefix):
         Printable(newprefix),
         mnb(nb), mkT(kT), mieta(ieta), morthogonal(orthogonal),
         mH0(nb), mS0(nb), mHl(nb+1), mSl(nb+1), mV(nb),
-        mN(nb-2), miLc(0), miRc(nb-1),
+        mN(nb-2), miLc(0), miRc(nb-1), mdecimate(false), mRunsFound(false),
+        mbanded(false), mBandsFound(false), mprof(0), mcacheSurfG(false),
         mDi(this, miLc, miRc), 
         mTl(this, miLc, miRc+1),
         mgrc(this, miLc+1, miRc),
@@ -55,8 +71,18 @@ void CohRgfa::H(const field<shared_ptr<cxmat> > &H0, const field<shared_ptr<cxma
         throw runtime_error("In CohRgfa::H(): size of Hl should be equal to number of blocks + 1.");
     }
     
+    // the surface GFs depend only on the contact blocks.
+    if (!isSameBlock(mH0(miLc), H0(miLc)) || !isSameBlock(mHl(miLc), Hl(miLc))){
+        mgsL.clear();
+    }
+    if (!isSameBlock(mH0(miRc), H0(miRc)) || !isSameBlock(mHl(miRc+1), Hl(miRc+1))){
+        mgsR.clear();
+    }
+    
     mH0 = H0;
     mHl = Hl;    
+    mRunsFound = false;
+    mBandsFound = false;
 }
 
 void CohRgfa::S(const field<shared_ptr<cxmat> > &S0, const field<shared_ptr<cxmat> > &Sl){
@@ -68,8 +94,17 @@ void CohRgfa::S(const field<shared_ptr<cxmat> > &S0, const field<shared_ptr<cxma
         throw runtime_error("In CohRgfa::S(): size of Sl should be equal to number of blocks + 1.");
     }
 
+    if (!isSameBlock(mS0(miLc), S0(miLc)) || !isSameBlock(mSl(miLc), Sl(miLc))){
+        mgsL.clear();
+    }
+    if (!isSameBlock(mS0(miRc), S0(miRc)) || !isSameBlock(mSl(miRc+1), Sl(miRc+1))){
+        mgsR.clear();
+    }
+
     mS0 = S0;
     mSl = Sl;
+    mRunsFound = false;
+    mBandsFound = false;
 }
 
 void CohRgfa::V(const field<shared_ptr<vec> > &V){
@@ -78,6 +113,77 @@ void CohRgfa::V(const field<shared_ptr<vec> > &V){
     }
     
     mV = V;
+    mRunsFound = false;
+}
+
+/*
+ * Changes the potential at the same energy keeping everything that does not
+ * depend on the changed blocks: glc_i,i on the left of the first changed 
+ * block and grc_i,i on the right of the last one. A block is unchanged if 
+ * its potential is the same object or has the same values. This is what 
+ * makes a bias sweep at a fixed energy cheap when the bias changes only a 
+ * part of the device.
+ */
+void CohRgfa::updateV(const field<shared_ptr<vec> > &V){
+    if (V.n_elem != mnb){
+        throw runtime_error("In CohRgfa::updateV(): size of V should be equal to number of blocks.");
+    }
+    
+    int first = mnb, last = -1;
+    for (int ib = 0; ib < mnb; ++ib){
+        if (!isSameBlock(mV(ib), V(ib))){
+            first = std::min(first, ib);
+            last = std::max(last, ib);
+        }
+    }
+    mV = V;
+    if (last == -1){
+        return;
+    }
+    mRunsFound = false;
+    
+    for (int ib = first; ib <= last; ++ib){
+        mDi.forget(ib);
+        // T_i,i-1 depends on V_i and V_i-1 in non-orthogonal basis.
+        if (!morthogonal){
+            mTl.forget(ib);
+            mTl.forget(ib+1);
+        }
+    }
+    mglc.invalidate(first);
+    mgrc.invalidate(last);
+    
+    if (first <= miLc+1){
+        mSigL11.reset();
+        mGamL11.reset();
+    }
+    if (last >= mN){
+        mSigRNN.reset();
+        mGamRNN.reset();
+    }
+    
+    // the full Green function depends on all the blocks.
+    mGii.reset();
+    mGi1.reset();
+    mGiN.reset();
+    mGiip1.reset();
+    mGiim1.reset();
+}
+
+void CohRgfa::surfaceGCache(bool enable){
+    mcacheSurfG = enable;
+    if (!enable){
+        mgsL.clear();
+        mgsR.clear();
+    }
+}
+
+void CohRgfa::decimate(bool enable){
+    mdecimate = enable;
+}
+
+void CohRgfa::banded(bool enable){
+    mbanded = enable;
 }
 
 string CohRgfa::toString() const {
@@ -89,7 +195,9 @@ string CohRgfa::toString() const {
     out << mPrefix << " ieta         = " << mieta << endl;
     out << mPrefix << " kT           = " << mkT << endl;
     out << mPrefix << " muS          = " << mmuS << endl;
-    out << mPrefix << " muD          = " << mmuD;
+    out << mPrefix << " muD          = " << mmuD << endl;
+    out << mPrefix << " Decimation   = " << (mdecimate ? "Yes" : "No") << endl;
+    out << mPrefix << " Banded       = " << (mbanded ? "Yes" : "No");
 
     return out.str();
 }
@@ -103,10 +211,10 @@ cxmat CohRgfa::pOp(uint N, int ib, ucol *atomsTracedOver){
     // If out of range, sum over the device
     if (ib >= miRc || ib <= miLc){
         for (uint ib = miLc+1; ib < miRc; ++ib){
-            pOp += trace<cxmat>(Aop(ib, ib) - Gn(ib, ib), N, atomsTracedOver);
+            pOp += Aop(N, ib, atomsTracedOver) - trGn(N, ib, atomsTracedOver);
         }
     }else{
-        pOp = trace<cxmat>(Aop(ib, ib) - Gn(ib, ib), N, atomsTracedOver);
+        pOp = Aop(N, ib, atomsTracedOver) - trGn(N, ib, atomsTracedOver);
     }
     
     return pOp/(2*pi);    
@@ -122,10 +230,10 @@ cxmat CohRgfa::nOp(uint N, int ib, ucol *traveOveratoms){
     // If out of range, sum over the device
     if (ib >= miRc || ib <= miLc){
         for (uint ib = miLc+1; ib < miRc; ++ib){
-            nOp += trace<cxmat>(Gn(ib, ib), N, traveOveratoms);
+            nOp += trGn(N, ib, traveOveratoms);
         }
     }else{
-        nOp = trace<cxmat>(Gn(ib, ib), N, traveOveratoms);
+        nOp = trGn(N, ib, traveOveratoms);
     }
     
     return nOp/(2*pi);        
@@ -142,14 +250,49 @@ cxmat CohRgfa::DOSop(uint N, ucol *atomsTracedOver){
     return D/(2*pi);
 }
 
+/*
+ * Local density of states and electron density map. It returns a 
+ * No x 2 matrix, where No is the number of orbitals in the device (block 1 
+ * to N). The first column holds diag(A_i,i)/2pi and the second column holds 
+ * diag(Gn_i,i)/2pi of all the blocks one after another. Only the diagonals 
+ * are calculated, the full A_i,i and Gn_i,i blocks are never formed.
+ */
+cxmat CohRgfa::LDOSMapop(){
+    uint No = 0;
+    for (uint ib = miLc+1; ib < miRc; ++ib){
+        No += mH0(ib)->n_rows;
+    }
+    
+    cxmat LDOSMap(No, 2);
+    uint io = 0;
+    for (uint ib = miLc+1; ib < miRc; ++ib){
+        const cxmat &Gii = mGii(ib);
+        const cxmat &Gi1 = G(ib, miLc+1);
+        uint no = Gii.n_rows;
+        
+        // diag(A_i,i) = i*[diag(G_i,i) - diag(G_i,i)']
+        cxcol dGii = Gii.diag();
+        cxcol dAii = i*(dGii - conj(dGii));
+        // diag(Gn_i,i) = diag(A_i,i)*fN + diag(G_i,1*Gam_1,1*G_i,1')*(f1-fN)
+        cxmat Gi1Gam = Gi1*GamL11();
+        cxcol dGnii = mfNp1*dAii + (mf0 - mfNp1)*sum(Gi1Gam % conj(Gi1), 1);
+        
+        LDOSMap(span(io, io+no-1), 0) = dAii;
+        LDOSMap(span(io, io+no-1), 1) = dGnii;
+        io += no;
+    }
+    
+    return LDOSMap/(2*pi);
+}
+
 /*
  * Spectral function for block ib
  */
 cxmat CohRgfa::Aop(uint N, uint ib, ucol *traveOveratoms){
-    cxmat A = mGii(ib);
-    A = i*(A - trans(A));
+    // tr{A_i,i} = i*[tr{G_i,i} - tr{G_i,i}']
+    cxmat trGii = trace<cxmat>(mGii(ib), N, traveOveratoms);
     
-    return trace<cxmat>(A, N, traveOveratoms);    
+    return i*(trGii - trans(trGii));    
 }
 
 
@@ -161,23 +304,18 @@ cxmat CohRgfa::Iop(uint N, uint ib, uint jb, ucol *atomsTracedOver){
         
     if (ib == miLc && jb == miLc + 1){
         // current from contact 0 to device.
-        return i*trace<cxmat>(I0op(), N, atomsTracedOver);
-//        return I0op(N, atoms);
+        return i*I0op(N, atomsTracedOver);
     }else if (ib == miLc + 1 && jb == miLc){
         // current from device to contact 0.
-        return -i*trace<cxmat>(I0op(), N, atomsTracedOver);
-//        return -I0op(N, atoms);
+        return -i*I0op(N, atomsTracedOver);
     } else if (ib == miRc && jb == miRc-1){
         // current from contact N to device.
-        return i*trace<cxmat>(INop(), N, atomsTracedOver);
-//        return INop(N, atoms);
+        return i*INop(N, atomsTracedOver);
     } else if (ib == miRc-1 && jb == miRc){
         // current from device to contact N.
-        return -i*trace<cxmat>(INop(), N, atomsTracedOver);
-//        return -INop(N, atoms);
+        return -i*INop(N, atomsTracedOver);
     } else if (abs(int(ib) - int (jb)) <= 1 && ib > miLc && ib < miRc && jb > miLc && jb < miRc) {
-        return i*trace<cxmat>(Iijop(ib, jb), N, atomsTracedOver);
-//        return Iijop(N, ib, jb, atoms);
+        return i*Iijop(N, ib, jb, atomsTracedOver);
     }else{
         stringstream error;
         error << "ERROR: Iop(i, j) only works for |i-j| <= 1 and  0<= i,j <= N+1."
@@ -187,6 +325,39 @@ cxmat CohRgfa::Iop(uint N, uint ib, uint jb, ucol *atomsTracedOver){
     }
 }
 
+/*
+ * Bond current map: current from block i to block i+1 for all the bonds
+ * from the left contact (i = 0) to the right contact (i = N) in a single 
+ * sweep. The result is an N x N*(N+1) matrix; columns ib*N to (ib+1)*N-1 
+ * hold the current I_ib,ib+1 as returned by Iop(N, ib, ib+1).
+ * -----------------------------------------------------------------------------
+ */
+cxmat CohRgfa::IMapop(uint N, ucol *atomsTracedOver){
+    uint nbonds = miRc - miLc;
+    cxmat IMap(N, N*nbonds, fill::zeros);
+    
+    // current from contact 0 to device and from device to contact N.
+    IMap.cols(0, N-1) = i*I0op(N, atomsTracedOver);
+    IMap.cols((nbonds-1)*N, nbonds*N-1) = -i*INop(N, atomsTracedOver);
+    
+    // Bonds inside the device. 
+    // Gn_i,i+1 = i*[G_i,i+1 - G_i+1,i']*fN + G_i,1*Gam_1,1*G_i+1,1'*(f1-fN)
+    // G_i+1,1*Gam_1,1 of one bond is the G_i,1*Gam_1,1 of the next one.
+    cxmat GiGam = mGii(miLc+1)*GamL11();
+    for (uint ib = miLc+1; ib < miRc-1; ++ib){
+        uint jb = ib + 1;
+        const cxmat &Gj1 = G(jb, miLc+1);
+        cxmat Gnij = (i*mfNp1)*(G(ib, jb) - trans(G(jb, ib))) 
+                   + (mf0 - mfNp1)*(GiGam*trans(Gj1));
+        //I_i,i+1 = H_i,i+1*Gn_i+1,i - Gn_i,i+1*H_i+1,i
+        cxmat trGnT = traceProd<cxmat>(Gnij, mTl(jb), N, atomsTracedOver);
+        IMap.cols((ib-miLc)*N, (ib-miLc+1)*N-1) = i*(trans(trGnT) - trGnT);
+        GiGam = Gj1*GamL11();
+    }
+    
+    return IMap;
+}
+
 /*
  * Transmission operator T(E) = tr{Gamma_1,1*[A_1,1 - G_1,1*Gamma_1,1*G_1,1']}
  * -----------------------------------------------------------------------------
@@ -198,84 +369,110 @@ cxmat CohRgfa::TEop(uint N, ucol *traveOveratoms){
     const cxmat &G11 = mGii(1);                       // Get or caluclate G_1,1
     const cxmat &Gaml11 = GamL11();
     cxmat G11a = trans(G11);
-    cxmat TEop = Gaml11*(i*(G11 - G11a) - G11*Gaml11*G11a); 
-    return trace<cxmat>(TEop, N, traveOveratoms);
+    // Only the diagonal blocks of the products are calculated:
+    // T(E) = tr{Gamma_1,1*A_1,1} - tr{Gamma_1,1*G_1,1*[Gamma_1,1*G_1,1']}
+    cxmat A11 = i*(G11 - G11a);
+    cxmat GamG11a = Gaml11*G11a;
+    return traceProd<cxmat>(Gaml11, A11, N, traveOveratoms) 
+         - traceProd<cxmat>(Gaml11, G11, GamG11a, N, traveOveratoms);
 }
 
 /*
- * Current from block # i and block j where i and j are neighbors.
+ * Current from block # i and block j where i and j are neighbors, traced 
+ * over the atoms. The adjoint of a diagonal block is the diagonal block of 
+ * the adjoint, so tr{T'*Gn'} = tr{Gn*T}' and only one product is needed.
  * -----------------------------------------------------------------------------
  */
-inline cxmat CohRgfa::Iijop(uint ib, uint jb){
-    cxmat Iijop;
-    cxmat &Gnij = Iijop;
-    
-    Gnij = Gn(ib, jb);
+inline cxmat CohRgfa::Iijop(uint N, uint ib, uint jb, ucol *atomsTracedOver){
+    cxmat Gnij = Gn(ib, jb);
+    cxmat trGnT;
     //I_i,j = H_i,j*Gn_j,i - Gn_i,j*H_j,i; 
     if (ib < jb){
         //I_i,i+1 = H_i,i+1*Gn_i+1,i - Gn_i,i+1*H_i+1,i
-        Iijop = trans(mTl(jb))*trans(Gnij) - Gnij*mTl(jb);
+        trGnT = traceProd<cxmat>(Gnij, mTl(jb), N, atomsTracedOver);
+        return trans(trGnT) - trGnT;
     }else if (ib > jb){
         //I_i+1,i = H_i+1,i*Gn_i,i+1 - Gn_i+1,i*H_i,i+1
-        Iijop = mTl(ib)*trans(Gnij) - Gnij*trans(mTl(ib));
+        cxmat Tlia = trans(mTl(ib));
+        trGnT = traceProd<cxmat>(Gnij, Tlia, N, atomsTracedOver);
+        return trans(trGnT) - trGnT;
     }else{
-        Iijop = mDi(ib)*Gnij - Gnij*mDi(ib);
+        return traceProd<cxmat>(mDi(ib), Gnij, N, atomsTracedOver) 
+             - traceProd<cxmat>(Gnij, mDi(ib), N, atomsTracedOver);
     }
-    
-    //return i*trace<cxmat>(Iijop, N);    
-    return Iijop;
 }
 
 
 /*
- * Current operator at right contact (block # N).
+ * Current operator at right contact (block # N), traced over the atoms.
  * INOp
  * -----------------------------------------------------------------------------
  */
-inline cxmat CohRgfa::INop(){
+inline cxmat CohRgfa::INop(uint N, ucol *atomsTracedOver){
 
     const cxmat &SigrNN = SigRNN();
     const cxmat &GamrNN = GamRNN();
     const cxmat &GNN = mGii(mN);            // Get or caluclate G_N,N
     cxmat GNNa = trans(GNN);
+    cxmat GNNGam = GNN*GamrNN;
     
     // Density matrix: Gn11 = G^n_1,1
     // G^n_1,1 = Al_1,1*(f1-fN) + [A_1,1]*fN
     // Al_1,1 = G_1,1*gamma_1,1*G1,1'
     // A_1,1 = i*(G_1,1 - G_1,1')
-    cxmat GnNN = GNN*GamrNN*GNNa*(mfNp1-mf0) + i*(GNN - GNNa)*mf0;
-    // Current operator
-    cxmat INop = GnNN*trans(SigrNN) - SigrNN*GnNN 
-          + GNN*GamrNN*mfNp1 - GamrNN*GNNa*mfNp1;
-
-    //return i*trace<cxmat>(INop, N, atoms);    
-    return INop;
+    cxmat GnNN = GNNGam*GNNa*(mfNp1-mf0) + i*(GNN - GNNa)*mf0;
+    // Current operator:
+    // INop = GnNN*SigRNN' - SigRNN*GnNN + G_N,N*GamRNN*fN - GamRNN*G_N,N'*fN
+    // GnNN and GamRNN are Hermitian, so the second and the fourth terms 
+    // are the adjoints of the first and the third.
+    cxmat SigrNNa = trans(SigrNN);
+    cxmat trGnSig = traceProd<cxmat>(GnNN, SigrNNa, N, atomsTracedOver);
+    cxmat trGGam = trace<cxmat>(GNNGam, N, atomsTracedOver);
+
+    return trGnSig - trans(trGnSig) + (trGGam - trans(trGGam))*mfNp1;
 }
 
 
 /*
- * Current operator at terminal 1.
+ * Current operator at terminal 1, traced over the atoms.
  * I1op
  * -----------------------------------------------------------------------------
  */
-inline cxmat CohRgfa::I0op(){
+inline cxmat CohRgfa::I0op(uint N, ucol *atomsTracedOver){
     
     const cxmat &Sigl11 = SigL11();
     const cxmat &Gaml11 = GamL11();
     const cxmat &G11 = mGii(1);            // Get or caluclate G_1,1
     cxmat G11a = trans(G11);
+    cxmat G11Gam = G11*Gaml11;
     
     // Density matrix: Gn11 = G^n_1,1
     // G^n_1,1 = Al_1,1*(f1-fN) + [A_1,1]*fN
     // Al_1,1 = G_1,1*gamma_1,1*G1,1'
     // A_1,1 = i*(G_1,1 - G_1,1')
-    cxmat Gn11 = G11*Gaml11*G11a*(mf0-mfNp1) + i*(G11 - G11a)*mfNp1;
-    // Current operator
-    cxmat I0op = Gn11*trans(Sigl11) - Sigl11*Gn11 
-          +G11*Gaml11*mf0 - Gaml11*G11a*mf0;
+    cxmat Gn11 = G11Gam*G11a*(mf0-mfNp1) + i*(G11 - G11a)*mfNp1;
+    // Current operator:
+    // I0op = Gn11*SigL11' - SigL11*Gn11 + G_1,1*GamL11*f1 - GamL11*G_1,1'*f1
+    cxmat Sigl11a = trans(Sigl11);
+    cxmat trGnSig = traceProd<cxmat>(Gn11, Sigl11a, N, atomsTracedOver);
+    cxmat trGGam = trace<cxmat>(G11Gam, N, atomsTracedOver);
     
-    //return i*trace<cxmat>(I1op, N, atoms);    
-    return I0op;
+    return trGnSig - trans(trGnSig) + (trGGam - trans(trGGam))*mf0;
+}
+
+/*
+ * Trace of the diagonal block of the correlation function. Only the 
+ * diagonal sub-blocks of the products are calculated.
+ * ----------------------------------------------------------------------------- 
+ */
+inline cxmat CohRgfa::trGn(uint N, uint ib, ucol *atomsTracedOver){
+    // tr{Gn_i,i} = i*[tr{G_i,i} - tr{G_i,i}']*fN + tr{G_i,1*Gam_1,1*G_i,1'}*(f1-fN)
+    cxmat trGii = trace<cxmat>(mGii(ib), N, atomsTracedOver);
+    const cxmat &Gi1 = G(ib, miLc+1);
+    cxmat Gi1a = trans(Gi1);
+    
+    return (i*mfNp1)*(trGii - trans(trGii)) 
+         + (mf0 - mfNp1)*traceProd<cxmat>(Gi1, GamL11(), Gi1a, N, atomsTracedOver);
 }
 
 /**
@@ -574,6 +771,7 @@ inline void CohRgfa::Gii::computeGii(cxmat& Gii, const cxmat& Gim1im1, int ib){
  */
 const cxmat& CohRgfa::glc::operator ()(int ib){
     if (!isStored(ib)){
+        Profiler::Scope prof(mnegf->mprof, RGF_FORWARD);
         // Block from which we start the calculation is the one just after
         // the last calculated block.
         int igStart = mIt + 1; 
@@ -605,7 +803,19 @@ inline void CohRgfa::glc::computeglc(cxmat& glci, const cxmat& glcim1, int ib){
     if(ib == iLc){
         double E = mnegf->mE;
         double VL = (*mnegf->mV(iLc))(0); // all the atoms on a contact have the save bias
-        computegs(glci, E+VL, *mnegf->mH0(iLc), *mnegf->mS0(iLc), Tiim1, mnegf->mieta, CohRgfa::SurfGTolX);
+        // the contact only shifts rigidly with its potential.
+        if (mnegf->findSurfG(glci, mnegf->mgsL, E+VL)){
+            mIt = ib;
+            return;
+        }
+        Profiler::Scope prof(mnegf->mprof, RGF_SURFACE_GF);
+        int niter = 0;
+        computegs(glci, E+VL, *mnegf->mH0(iLc), *mnegf->mS0(iLc), Tiim1, mnegf->mieta, 
+                  CohRgfa::SurfGTolX, &niter);
+        if (mnegf->mprof){
+            mnegf->mprof->count(RGF_SURFACE_GF, niter);
+        }
+        mnegf->keepSurfG(mnegf->mgsL, E+VL, glci);
     // calculate glc_i,i using recursive equation:
     // glc_i = [ES_ii - H_ii - U_ii - T_ii-1*glc_i-1*T_i-1i]^-1;
     // glc_i = [ES_ii - H_ii - U_ii - SigL_ii]^-1;
@@ -621,7 +831,7 @@ inline void CohRgfa::glc::computeglc(cxmat& glci, const cxmat& glcim1, int ib){
         }else{
             mnegf->computeSigL(glci, Tiim1, glcim1);
         }
-        glci = inv(mnegf->mDi(ib) - glci);
+        mnegf->invDiSig(glci, ib, true);
     }    
     mIt = ib;
 }
@@ -640,17 +850,41 @@ inline void CohRgfa::glc::computeglc(cxmat& glci, const cxmat& glcim1, int ib){
  */
 const cxmat& CohRgfa::grc::operator ()(int ib){
     if (!isStored(ib)){
+        Profiler::Scope prof(mnegf->mprof, RGF_BACKWARD);
+        // Block ib is inside a segment collapsed by the decimation. Fill in 
+        // the segment block by block starting from the nearest stored block.
+        if (mCacheEnabled && ib > mIt){
+            int itLast = mIt;
+            int igStart = ib + 1;
+            while (!isStored(igStart)){
+                ++igStart;
+            }
+            for (int ig = igStart - 1; ig >= ib; --ig){
+                computegrc(getAt(ig), getAt(ig+1), ig);
+            }
+            mIt = itLast;
+            return getAt(ib);
+        }
+        
         // Block from which we start the calculation is the one just before
         // the last calculated block.
-        int igStart = mIt - 1; 
-        //if (igStart > mIt){
-        //    igStart = mnegf->miRc;
-        //}
-        for (int ig = igStart; ig >= ib; --ig){
+        int ig = mIt - 1; 
+        while (ig >= ib){
             int igp1 = (ig == end()) ? ig:ig+1;
-            cxmat &grci = getAt(ig);
             cxmat &grcip1 = getAt(igp1);
-            computegrc(grci, grcip1,ig);
+            // First block of the uniform segment that ends at block ig.
+            int is = (ig == end()) ? ig:mnegf->uniformRunStart(ig);
+            if (is < ib){
+                is = ib;
+            }
+            if (ig - is + 1 >= CohRgfa::MinDecimationRun 
+                    && mnegf->decimategrc(getAt(is), grcip1, is, ig)){
+                mIt = is;
+                ig = is - 1;
+            }else{
+                computegrc(getAt(ig), grcip1, ig);
+                --ig;
+            }
         }
     }
     return getAt(ib);    
@@ -671,8 +905,18 @@ inline void CohRgfa::grc::computegrc(cxmat& grci, const cxmat& grcip1, int ib){
     if(ib == iRc){
         double E = mnegf->mE;
         double VR = (*mnegf->mV(iRc))(0); // all the atoms on a contact have the save bias
+        if (mnegf->findSurfG(grci, mnegf->mgsR, E+VR)){
+            mIt = ib;
+            return;
+        }
+        Profiler::Scope prof(mnegf->mprof, RGF_SURFACE_GF);
+        int niter = 0;
         computegs(grci, E+VR, *mnegf->mH0(iRc), *mnegf->mS0(iRc), trans(Tip1i), mnegf->mieta, 
-                  CohRgfa::SurfGTolX);
+                  CohRgfa::SurfGTolX, &niter);
+        if (mnegf->mprof){
+            mnegf->mprof->count(RGF_SURFACE_GF, niter);
+        }
+        mnegf->keepSurfG(mnegf->mgsR, E+VR, grci);
 
     // Calculate grc_i,i using recursive equation:
     // grc_i = [ES_ii - H_ii - U_ii - T_ii+1*grc_i+1*T_i+1i]^-1;
@@ -687,12 +931,281 @@ inline void CohRgfa::grc::computegrc(cxmat& grci, const cxmat& grcip1, int ib){
         }else{
             mnegf->computeSigR(grci, Tip1i, grcip1);
         }
-        grci = inv(mnegf->mDi(ib) - grci);        
+        mnegf->invDiSig(grci, ib, false);        
     }
     mIt = ib;
 }
 
 
+/*
+ * Renormalization-decimation of uniform segments.
+ * =============================================================================
+ */
+
+/* 
+ * This function calculates the right connected Green function of the first
+ * block of a uniform segment (identical D_i,i and T_i,i-1) from block is to
+ * block ie in one go. The segment is collapsed by repeated doubling in 
+ * O(log L) block operations, L = ie - is + 1. The blocks in between are not 
+ * calculated.
+ * The isolated segments use the same D_i,i as the block by block recursion,
+ * without any extra broadening. An isolated segment is singular when E is 
+ * one of its eigenvalues, and the doubling loses accuracy near such an E 
+ * (e.g. at the band edges). Every block eliminated on the way is therefore 
+ * checked with invWellCond(). If one is ill-conditioned, false is returned 
+ * and the caller falls back to the block by block recursion.
+ * grci ------> Output: grc_is,is
+ * grcip1 ----> Input: grc_ie+1,ie+1.
+ * is, ie ----> First and last blocks of the segment.
+ */
+inline bool CohRgfa::decimategrc(cxmat& grci, const cxmat& grcip1, int is, int ie){
+    // Self energy of the blocks on the right of the segment.
+    cxmat SigR;
+    if (ie == mN){
+        SigR = SigRNN();
+    }else{
+        computeSigR(SigR, mTl(ie+1), grcip1);
+    }
+    
+    // Isolated Green function of a single block.
+    const cxmat &Di = mDi(ie);
+    const cxmat &Tiim1 = mTl(ie);
+    cxmat I = eye<cxmat>(Di.n_rows, Di.n_cols);
+    Segment P;
+    if (!invWellCond(P.g11, Di)){
+        return false;
+    }
+    P.g1L = P.g11;
+    P.gL1 = P.g11;
+    P.gLL = P.g11;
+    
+    // P is a segment of 2^k blocks, R accumulates the segments of the
+    // binary representation of L.
+    Segment R;
+    bool isEmpty = true;
+    for (int L = ie - is + 1; L > 0; L >>= 1){
+        if (L & 1){
+            if (isEmpty){
+                R = P;
+                isEmpty = false;
+            }else if (!joinSegments(R, R, P, Tiim1)){
+                return false;
+            }
+        }
+        if (L > 1 && !joinSegments(P, P, P, Tiim1)){
+            return false;
+        }
+    }
+    
+    // Connect the segment to the right:
+    // grc_is = g_1,1 + g_1,L*SigR*[I - g_L,L*SigR]^-1*g_L,1
+    cxmat A;
+    if (!invWellCond(A, I - R.gLL*SigR)){
+        return false;
+    }
+    cxmat g = R.g11 + R.g1L*SigR*A*R.gL1;
+    if (!g.is_finite()){
+        return false;
+    }
+    grci = g;
+    return true;
+}
+
+/* 
+ * Joins two isolated segments X and Y into XY, where the first block of Y 
+ * is coupled to the last block of X by T = T_Y1,XL. XY may be X or Y.
+ * G_XL,X1 = [I - gLL_X*T'*g11_Y*T]^-1*gL1_X
+ * G_Y1,YL = [I - g11_Y*T*gLL_X*T']^-1*g1L_Y
+ * Returns false if either inverse is ill-conditioned.
+ */
+inline bool CohRgfa::joinSegments(Segment& XY, const Segment& X, const Segment& Y, 
+        const cxmat& T)
+{
+    cxmat Ta = trans(T);
+    cxmat IX = eye<cxmat>(X.gLL.n_rows, X.gLL.n_cols);
+    cxmat IY = eye<cxmat>(Y.g11.n_rows, Y.g11.n_cols);
+    cxmat AX, AY;
+    if (!invWellCond(AX, IX - X.gLL*Ta*Y.g11*T) 
+            || !invWellCond(AY, IY - Y.g11*T*X.gLL*Ta)){
+        return false;
+    }
+    cxmat GXLX1 = AX*X.gL1;
+    cxmat GY1YL = AY*Y.g1L;
+    
+    Segment J;
+    J.g11 = X.g11 + X.g1L*Ta*Y.g11*T*GXLX1;
+    J.g1L = X.g1L*Ta*GY1YL;
+    J.gL1 = Y.gL1*T*GXLX1;
+    J.gLL = Y.gLL + Y.gL1*T*X.gLL*Ta*GY1YL;
+    XY = J;
+    
+    return true;
+}
+
+/*
+ * Inverts A for the decimation. Returns false if A is singular or its 
+ * reciprocal condition number in the 1-norm, 1/(|A|*|A^-1|), is below 
+ * MinDecimationRcond.
+ */
+inline bool CohRgfa::invWellCond(cxmat& Ainv, const cxmat& A){
+    if (!inv(Ainv, A)){
+        return false;
+    }
+    double rc = 1.0/(norm(A, 1)*norm(Ainv, 1));
+    return std::isfinite(rc) && rc >= MinDecimationRcond;
+}
+
+/*
+ * Returns the first block of the longest uniform segment that ends at 
+ * block ib. Returns ib if decimation is disabled.
+ */
+inline int CohRgfa::uniformRunStart(int ib){
+    if (!mdecimate || ib <= miLc || ib >= miRc){
+        return ib;
+    }
+    if (!mRunsFound){
+        findUniformRuns();
+    }
+    return mRunStart[ib];
+}
+
+/*
+ * Finds the uniform segments of the device. Blocks i-1 and i are in the 
+ * same segment if H0, S0 and V are the same and T_i,i-1 is the same as the
+ * coupling inside the segment.
+ */
+void CohRgfa::findUniformRuns(){
+    mRunStart.assign(mnb, 0);
+    for (int ib = miLc+1; ib < miRc; ++ib){
+        mRunStart[ib] = ib;
+        if (ib == miLc+1){
+            continue;
+        }
+        bool same = isSameBlock(mH0(ib), mH0(ib-1)) && isSameBlock(mV(ib), mV(ib-1));
+        if (same && !morthogonal){
+            same = isSameBlock(mS0(ib), mS0(ib-1));
+        }
+        // coupling inside the segment
+        if (same && mRunStart[ib-1] != ib-1){
+            same = isSameBlock(mHl(ib), mHl(ib-1));
+            if (same && !morthogonal){
+                same = isSameBlock(mSl(ib), mSl(ib-1));
+            }
+        }
+        if (same){
+            mRunStart[ib] = mRunStart[ib-1];
+        }
+    }
+    mRunsFound = true;
+}
+
+
+/*
+ * Surface Green functions of the contacts.
+ * =============================================================================
+ */
+
+/*
+ * The surface Green function of a contact with uniform potential V depends 
+ * only on E+V: D = (E+V)*S - H and T = H + U - E*S = H - (E+V)*S. 
+ * Returns true and the stored one if E+V was seen before.
+ */
+inline bool CohRgfa::findSurfG(cxmat& gs, const SurfGCache& cache, double EV){
+    if (!mcacheSurfG){
+        return false;
+    }
+    SurfGCache::const_iterator it = cache.find(std::llround(EV/SurfGKeyTol));
+    if (it == cache.end()){
+        return false;
+    }
+    gs = it->second;
+    return true;
+}
+
+inline void CohRgfa::keepSurfG(SurfGCache& cache, double EV, const cxmat& gs){
+    if (!mcacheSurfG){
+        return;
+    }
+    if (cache.size() >= MaxSurfGCache){
+        cache.clear();
+    }
+    cache[std::llround(EV/SurfGKeyTol)] = gs;
+}
+
+
+/*
+ * Banded inverse of the diagonal blocks.
+ * =============================================================================
+ */
+
+/*
+ * gi = inv(D_i,i - Sig) where Sig is passed in gi. If the banded inverse is
+ * enabled and pays off for this block, D_i,i is reordered into a band, 
+ * inverted in band storage and Sig is added by a low rank update on the 
+ * orbitals coupled to the neighbouring block.
+ * gi --------> Input: Sig_i,i; Output: inv(D_i,i - Sig_i,i).
+ * ib --------> Block index.
+ * left ------> Sig is the left (glc) or the right (grc) self energy.
+ */
+inline void CohRgfa::invDiSig(cxmat& gi, int ib, bool left){
+    if (mbanded && !mBandsFound){
+        findBands();
+    }
+    const cxmat &Di = mDi(ib);
+    if (!mbanded || !(left ? mBands[ib].useL : mBands[ib].useR)){
+        gi = inv(Di - gi);
+        return;
+    }
+    
+    const BlockBand &band = mBands[ib];
+    const uwcol &P = left ? band.PL : band.PR;
+    cxmat Dinvp;
+    if (!invBanded(Dinvp, Di.submat(band.p, band.p), band.kb)){
+        gi = inv(Di - gi);
+        return;
+    }
+    // back to the original order
+    cxmat Dinv(Di.n_rows, Di.n_cols);
+    Dinv.submat(band.p, band.p) = Dinvp;
+    gi = invUpdate(Dinv, gi.submat(P, P), P);
+}
+
+/*
+ * Finds the reverse Cuthill-McKee order, the bandwidth and the orbitals 
+ * coupled to the neighbours of all the device blocks. The banded inverse 
+ * costs ~n^2*(3*kb + k) against ~n^3 of the dense one, k being the number 
+ * of coupled orbitals, so it is used only when that is clearly cheaper.
+ */
+void CohRgfa::findBands(){
+    mBands.assign(mnb, BlockBand());
+    for (int ib = miLc+1; ib < miRc; ++ib){
+        BlockBand &band = mBands[ib];
+        
+        // sparsity patterns of D_i,i, T_i,i-1 and T_i+1,i.
+        mat D = arma::abs(*mH0(ib));
+        mat Tiim1 = arma::abs(*mHl(ib));
+        mat Tip1i = arma::abs(*mHl(ib+1));
+        if (!morthogonal){
+            D += arma::abs(*mS0(ib));
+            Tiim1 += arma::abs(*mSl(ib));
+            Tip1i += arma::abs(*mSl(ib+1));
+        }
+        D.diag().ones();
+        
+        cxmat Dp = conv_to<cxmat>::from(D);
+        band.p = rcm(Dp);
+        band.kb = bandwidth(Dp.submat(band.p, band.p));
+        band.PL = nonzeroRows(conv_to<cxmat>::from(Tiim1));
+        band.PR = nonzeroCols(conv_to<cxmat>::from(Tip1i));
+        
+        uword n = D.n_rows;
+        band.useL = 2*(3*band.kb + band.PL.n_elem) < n;
+        band.useR = 2*(3*band.kb + band.PR.n_elem) < n;
+    }
+    mBandsFound = true;
+}
+
+
 /*
  * Tl class:
  * Tij = [Hij + USij - ESij]
@@ -0,0 +1,202 @@
+/*
+ * File:   CohSpLoop.cpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 11:40 AM
+ */
+
+#include "negf/CohSpLoop.h"
+
+namespace quest{
+namespace negf{
+
+CohSpLoop::CohSpLoop(const Workers &workers, double kT, dcmplx ieta,
+        bool orthogonal, string newprefix): Printable(newprefix),
+        mWorkers(workers), mnegf(kT, ieta, orthogonal, " " + newprefix),
+        mbar("  NEGF: ")
+{
+}
+
+void CohSpLoop::E(const vec &E){
+    if (E.is_empty()){
+        throw runtime_error("In CohSpLoop::E(), E cannot be empty.");
+    }
+    mE = E;
+    mbar.expectedCount(mE.n_rows);
+}
+
+void CohSpLoop::mu(uint ip, double mu){
+    mnegf.mu(ip, mu);
+}
+
+void CohSpLoop::H(shared_ptr<sp_cx_mat> H){
+    mnegf.H(H);
+}
+
+void CohSpLoop::S(shared_ptr<sp_cx_mat> S){
+    mnegf.S(S);
+}
+
+void CohSpLoop::V(shared_ptr<vec> V){
+    mnegf.V(V);
+}
+
+uint CohSpLoop::addLead(shared_ptr<cxmat> H0, shared_ptr<cxmat> H01,
+        shared_ptr<cxmat> Hc, shared_ptr<uwcol> orbs, double VL,
+        shared_ptr<cxmat> S0, shared_ptr<cxmat> S01, shared_ptr<cxmat> Sc)
+{
+    return mnegf.addLead(H0, H01, Hc, orbs, VL, S0, S01, Sc);
+}
+
+void CohSpLoop::enableTE(uint ip, uint iq){
+    mTE.push_back(RgfResult("TRANSMISSION", 1, ip, iq));
+    mThisTE.push_back(cxmat_vec());
+}
+
+void CohSpLoop::enableI(uint ip){
+    mIop.push_back(RgfResult("CURRENT", 1, ip, ip));
+    mThisIop.push_back(cxmat_vec());
+}
+
+void CohSpLoop::enableDOS(){
+    mDOS.tag = "DOS";
+    mDOS.N = 1;
+}
+
+void CohSpLoop::enablen(){
+    mnOp.tag = "n";
+    mnOp.N = 1;
+}
+
+void CohSpLoop::enablep(){
+    mpOp.tag = "p";
+    mpOp.N = 1;
+}
+
+string CohSpLoop::toString() const {
+    stringstream out;
+    out << mnegf;
+
+    return out.str();
+}
+
+void CohSpLoop::run(){
+    prepare();
+
+    long myStart, myEnd, myN;
+    // Assign energy points to CPUs
+    mWorkers.assignCpus(myStart, myEnd, myN, mE.n_rows);
+    for(long iE = myStart; iE <= myEnd; ++iE){
+        mnegf.E(mE[iE]);
+        compute();
+        ++mbar;
+    }
+
+    collect();
+}
+
+void CohSpLoop::prepare() {
+    mWorkers.Comm().barrier();
+    mbar.start();
+}
+
+void CohSpLoop::compute(){
+    // Transmission
+    for (int it = 0; it < mTE.size(); ++it){
+        mThisTE[it].push_back(mnegf.TEop(mTE[it].ib, mTE[it].jb));
+    }
+    // Current
+    for (int it = 0; it < mIop.size(); ++it){
+        mThisIop[it].push_back(mnegf.Iop(mIop[it].ib));
+    }
+    // Density of States
+    if(mDOS.isEnabled()){
+        mThisDOS.push_back(mnegf.DOSop());
+    }
+    // Electron density
+    if(mnOp.isEnabled()){
+        mThisnOp.push_back(mnegf.nOp());
+    }
+    // Hole density
+    if(mpOp.isEnabled()){
+        mThispOp.push_back(mnegf.pOp());
+    }
+}
+
+void CohSpLoop::collect(){
+    // Update the progress bar.
+    mWorkers.Comm().barrier();
+    mbar.complete();
+
+    for (int it = 0; it < mTE.size(); ++it){
+        gather(mThisTE[it], mTE[it]);
+    }
+    for (int it = 0; it < mIop.size(); ++it){
+        gather(mThisIop[it], mIop[it]);
+    }
+    if(mDOS.isEnabled()){
+        gather(mThisDOS, mDOS);
+    }
+    if(mnOp.isEnabled()){
+        gather(mThisnOp, mnOp);
+    }
+    if(mpOp.isEnabled()){
+        gather(mThispOp, mpOp);
+    }
+}
+
+void CohSpLoop::gather(cxmat_vec &thisR, RgfResult &all){
+    if(!mWorkers.IAmMaster()){
+        // slaves send their local data
+        mpi::gather(mWorkers.Comm(), thisR, mWorkers.MasterId());
+    }else{
+        // The master collects data
+        vector<cxmat_vec>gatheredR(mWorkers.N());
+        mpi::gather(mWorkers.Comm(), thisR, gatheredR, mWorkers.MasterId());
+
+        vector<cxmat_vec>::iterator it;
+        for (it = gatheredR.begin(); it != gatheredR.end(); ++it){
+            all.R.insert(all.R.end(), it->begin(), it->end());
+        }
+    }
+}
+
+void CohSpLoop::save(string fileName, bool isText){
+    if(mWorkers.IAmMaster()){
+        if(isText){ // ASCII format
+            ofstream out;
+            out.open(fileName.c_str());
+            if (!out.is_open()){
+                throw ios_base::failure(" CohSpLoop::save(): Failed to open file "
+                        + fileName + ".");
+            }
+
+            // Energy
+            out << "ENERGY" << endl;
+            out << mE.n_elem << endl;
+            out << mE;
+            // no k-points
+            out << "KPOINTS" << endl;
+            out << 0 << endl;
+            for (int it = 0; it < mTE.size(); ++it){
+                mTE[it].save(out, isText);
+            }
+            for (int it = 0; it < mIop.size(); ++it){
+                mIop[it].save(out, isText);
+            }
+            if (mDOS.isEnabled()){
+                mDOS.save(out, isText);
+            }
+            if (mnOp.isEnabled()){
+                mnOp.save(out, isText);
+            }
+            if (mpOp.isEnabled()){
+                mpOp.save(out, isText);
+            }
+        }
+    }
+}
+
+}
+}
+
@@ -0,0 +1,304 @@
+/*
+ * File:   CohSpNegf.cpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 10:12 AM
+ */
+
+#include "negf/CohSpNegf.h"
+
+namespace quest{
+namespace negf{
+
+CohSpNegf::CohSpNegf(double kT, dcmplx ieta, bool orthogonal, string newprefix):
+        Printable(newprefix), mkT(kT), mieta(ieta), morthogonal(orthogonal),
+        mE(0), msolved(false)
+{
+    mTitle = "Coherent Transport using sparse NEGF";
+}
+
+void CohSpNegf::H(shared_ptr<sp_cx_mat> H){
+    if (H->n_rows != H->n_cols){
+        throw invalid_argument("In CohSpNegf::H(): H must be a square matrix.");
+    }
+    if (mV && mV->n_elem != H->n_rows){
+        throw invalid_argument("In CohSpNegf::H(): size of H does not match with V.");
+    }
+    mH = H;
+    msolved = false;
+}
+
+void CohSpNegf::S(shared_ptr<sp_cx_mat> S){
+    mS = S;
+    msolved = false;
+}
+
+void CohSpNegf::V(shared_ptr<vec> V){
+    if (V && mH && V->n_elem != mH->n_rows){
+        throw invalid_argument("In CohSpNegf::V(): size of V does not match with H.");
+    }
+    mV = V;
+    msolved = false;
+}
+
+/*
+ * Attaches a lead to the orbitals orbs of the device and returns its index.
+ * Hc(i,j) is the hopping from orbital orbs(i) of the device to orbital j
+ * of the surface layer of the lead.
+ */
+uint CohSpNegf::addLead(shared_ptr<cxmat> H0, shared_ptr<cxmat> H01,
+        shared_ptr<cxmat> Hc, shared_ptr<uwcol> orbs, double VL,
+        shared_ptr<cxmat> S0, shared_ptr<cxmat> S01, shared_ptr<cxmat> Sc)
+{
+    if (Hc->n_rows != orbs->n_elem || Hc->n_cols != H0->n_rows){
+        throw invalid_argument("In CohSpNegf::addLead(): size of Hc does not match with the lead and orbs.");
+    }
+    if (!morthogonal && (!S0 || !S01 || !Sc)){
+        throw invalid_argument("In CohSpNegf::addLead(): S0, S01 and Sc are required for non-orthogonal basis.");
+    }
+
+    Lead lead;
+    lead.H0 = H0;
+    lead.H01 = H01;
+    lead.Hc = Hc;
+    lead.orbs = orbs;
+    lead.V = VL;
+    lead.mu = 0;
+    if (morthogonal){
+        lead.S0 = make_shared<cxmat>(H0->n_rows, H0->n_cols, fill::eye);
+    }else{
+        lead.S0 = S0;
+        lead.S01 = S01;
+        lead.Sc = Sc;
+    }
+    mLeads.push_back(lead);
+    msolved = false;
+
+    return mLeads.size() - 1;
+}
+
+void CohSpNegf::mu(uint ip, double mu){
+    if (ip >= mLeads.size()){
+        throw invalid_argument("In CohSpNegf::mu(): lead index out of range.");
+    }
+    mLeads[ip].mu = mu;
+}
+
+void CohSpNegf::E(double E){
+    mE = E;
+    msolved = false;
+}
+
+string CohSpNegf::toString() const {
+    stringstream out;
+    out << Printable::toString() << ":" << endl;
+    out << mPrefix << " IsOrthogonal = " << (morthogonal ? "Yes" : "No")  << endl;
+    out << mPrefix << " no           = " << no() << endl;
+    out << mPrefix << " nLeads       = " << nLeads() << endl;
+    out << mPrefix << " ieta         = " << mieta << endl;
+    out << mPrefix << " kT           = " << mkT << endl;
+#ifdef ARMA_USE_SUPERLU
+    out << mPrefix << " Solver       = SuperLU";
+#else
+    out << mPrefix << " Solver       = LAPACK (dense)";
+#endif
+
+    return out.str();
+}
+
+/*
+ * Self energy of a lead on the device orbitals coupled to it:
+ * Sig = tau*gs*tau' where tau = Hc + Uc - E*Sc.
+ */
+void CohSpNegf::computeSigma(Lead &lead){
+    double E = mE;
+    double VL = lead.V;
+
+    cxmat T = *lead.H01;
+    cxmat tau = *lead.Hc;
+    if (!morthogonal){
+        T -= (E + VL)*(*lead.S01);
+        const uwcol &orbs = *lead.orbs;
+        for (uword m = 0; m < tau.n_rows; ++m){
+            double Vm = mV ? (*mV)(orbs(m)) : 0;
+            tau.row(m) -= (E + (Vm + VL)/2)*lead.Sc->row(m);
+        }
+    }
+
+    cxmat gs;
+    computegs(gs, E + VL, *lead.H0, *lead.S0, T, mieta, CohSpNegf::SurfGTolX);
+
+    lead.Sig = tau*gs*trans(tau);
+    lead.Gam = i*(lead.Sig - trans(lead.Sig));
+}
+
+/*
+ * Factors A = E*S - H - U - Sig once and solves A*Gc = I for the columns
+ * of I on the lead orbitals.
+ */
+void CohSpNegf::solve(){
+    if (msolved){
+        return;
+    }
+    if (!mH || mLeads.empty()){
+        throw runtime_error("In CohSpNegf::solve(): H and at least one lead are required.");
+    }
+    if (!morthogonal && !mS){
+        throw runtime_error("In CohSpNegf::solve(): S is required for non-orthogonal basis.");
+    }
+
+    uword no = mH->n_rows;
+
+    // self energies and the columns each lead owns.
+    uword nc = 0, nsig = 0;
+    for (int ip = 0; ip < mLeads.size(); ++ip){
+        Lead &lead = mLeads[ip];
+        computeSigma(lead);
+        uword n = lead.orbs->n_elem;
+        lead.cols = linspace<uwcol>(nc, nc+n-1, n);
+        nc += n;
+        nsig += n*n;
+    }
+
+    // A = E*S - H - U
+    sp_cx_mat A = -(*mH);
+    if (morthogonal){
+        Mat<uword> loc(2, no);
+        cxvec val(no);
+        for (uword io = 0; io < no; ++io){
+            loc(0, io) = io;
+            loc(1, io) = io;
+            val(io) = mE + (mV ? (*mV)(io) : 0);
+        }
+        A += sp_cx_mat(loc, val, no, no);
+    }else{
+        // U = -(Vi + Vj)/2*S_ij
+        Mat<uword> loc(2, mS->n_nonzero);
+        cxvec val(mS->n_nonzero);
+        uword k = 0;
+        for (sp_cx_mat::const_iterator it = mS->begin(); it != mS->end(); ++it, ++k){
+            double Vij = mV ? ((*mV)(it.row()) + (*mV)(it.col()))/2 : 0;
+            loc(0, k) = it.row();
+            loc(1, k) = it.col();
+            val(k) = (mE + Vij)*(*it);
+        }
+        A += sp_cx_mat(loc, val, no, no);
+    }
+
+    // Sig and the right hand side.
+    Mat<uword> loc(2, nsig);
+    cxvec val(nsig);
+    cxmat B(no, nc, fill::zeros);
+    uword k = 0;
+    for (int ip = 0; ip < mLeads.size(); ++ip){
+        const Lead &lead = mLeads[ip];
+        const uwcol &orbs = *lead.orbs;
+        for (uword n = 0; n < orbs.n_elem; ++n){
+            for (uword m = 0; m < orbs.n_elem; ++m, ++k){
+                loc(0, k) = orbs(m);
+                loc(1, k) = orbs(n);
+                val(k) = lead.Sig(m, n);
+            }
+            B(orbs(n), lead.cols(n)) = 1;
+        }
+    }
+    // leads sharing orbitals add up.
+    A -= sp_cx_mat(true, loc, val, no, no);
+
+#ifdef ARMA_USE_SUPERLU
+    bool ok = spsolve(mGc, A, B, "superlu");
+#else
+    bool ok = spsolve(mGc, A, B, "lapack");
+#endif
+    if (!ok){
+        throw runtime_error("In CohSpNegf::solve(): failed to factor E*S - H - U - Sig.");
+    }
+
+    msolved = true;
+}
+
+/*
+ * Diagonal of G*Gam_p*G' summed over all the device orbitals.
+ */
+cxmat CohSpNegf::trGGamG(uint ip){
+    const Lead &lead = mLeads[ip];
+    cxmat Gp = mGc.cols(lead.cols(0), lead.cols(lead.cols.n_elem-1));
+    cxmat r(1, 1);
+    r(0, 0) = accu((Gp*lead.Gam) % conj(Gp));
+    return r;
+}
+
+/*
+ * T_pq = Tr[Gam_p*G_pq*Gam_q*G_pq'].
+ */
+cxmat CohSpNegf::TEop(uint ip, uint iq){
+    if (ip >= mLeads.size() || iq >= mLeads.size()){
+        throw invalid_argument("In CohSpNegf::TEop(): lead index out of range.");
+    }
+    solve();
+
+    const Lead &P = mLeads[ip];
+    const Lead &Q = mLeads[iq];
+    cxmat Gpq = mGc.submat(*P.orbs, Q.cols);
+
+    cxmat TE(1, 1);
+    TE(0, 0) = arma::trace(P.Gam*Gpq*Q.Gam*trans(Gpq));
+    return TE;
+}
+
+/*
+ * I_p = sum_q T_pq*(f_p - f_q).
+ */
+cxmat CohSpNegf::Iop(uint ip){
+    if (ip >= mLeads.size()){
+        throw invalid_argument("In CohSpNegf::Iop(): lead index out of range.");
+    }
+    double fp = fermi(mE, mLeads[ip].mu, mkT);
+    cxmat I(1, 1, fill::zeros);
+    for (uint iq = 0; iq < mLeads.size(); ++iq){
+        if (iq != ip){
+            double fq = fermi(mE, mLeads[iq].mu, mkT);
+            I += TEop(ip, iq)*(fp - fq);
+        }
+    }
+    return I;
+}
+
+/*
+ * DOS = sum_p Tr[G*Gam_p*G']/2pi.
+ */
+cxmat CohSpNegf::DOSop(){
+    solve();
+    cxmat DOS(1, 1, fill::zeros);
+    for (uint ip = 0; ip < mLeads.size(); ++ip){
+        DOS += trGGamG(ip);
+    }
+    return DOS/(2*pi);
+}
+
+/*
+ * n = sum_p f_p*Tr[G*Gam_p*G']/2pi.
+ */
+cxmat CohSpNegf::nOp(){
+    solve();
+    cxmat n(1, 1, fill::zeros);
+    for (uint ip = 0; ip < mLeads.size(); ++ip){
+        n += trGGamG(ip)*fermi(mE, mLeads[ip].mu, mkT);
+    }
+    return n/(2*pi);
+}
+
+/*
+ * p = sum_p (1 - f_p)*Tr[G*Gam_p*G']/2pi.
+ */
+cxmat CohSpNegf::pOp(){
+    solve();
+    cxmat p(1, 1, fill::zeros);
+    for (uint ip = 0; ip < mLeads.size(); ++ip){
+        p += trGGamG(ip)*(1 - fermi(mE, mLeads[ip].mu, mkT));
+    }
+    return p/(2*pi);
+}
+
+}
+}
@@ -14,7 +14,7 @@ namespace negf{
  * 
  */
 bool computegs(cxmat& gs, double E, const cxmat& Hii, const cxmat& Sii, 
-        const cxmat& Tij, dcmplx ieta, double TolX){
+        const cxmat& Tij, dcmplx ieta, double TolX, int *niter){
  
     // initial guess (see the line just after Eq. 11 of [1])
     cxmat epi_1 = Hii;
@@ -53,6 +53,9 @@ bool computegs(cxmat& gs, double E, const cxmat& Hii, const cxmat& Sii,
     }
     // ---- surface Green functions (Eq. B7 of [1])
     gs = inv(E*Sii-epsi);
+    if (niter){
+        *niter = iter;
+    }
 
     return flag;
 }
@@ -0,0 +1,164 @@
+/* 
+ * File:   sectors.cpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 10:12 AM
+ */
+
+#include "negf/sectors.h"
+
+namespace quest{
+namespace negf{
+
+/*
+ * Disjoint sets of orbitals.
+ */
+static uint findRoot(vector<uint> &parent, uint io){
+    while (parent[io] != io){
+        parent[io] = parent[parent[io]];
+        io = parent[io];
+    }
+    return io;
+}
+
+static void join(vector<uint> &parent, uint io, uint jo){
+    io = findRoot(parent, io);
+    jo = findRoot(parent, jo);
+    if (io < jo){
+        parent[jo] = io;
+    }else if (jo < io){
+        parent[io] = jo;
+    }
+}
+
+/*
+ * Joins the orbitals coupled by block M. Rows of M are the orbitals 
+ * starting at rowOffset and columns are the orbitals starting at colOffset.
+ */
+static void joinCoupled(vector<uint> &parent, const shared_ptr<cxmat> &M, 
+        uint rowOffset, uint nrows, uint colOffset, uint ncols, double tol)
+{
+    if (!M){
+        return;
+    }
+    if (M->n_rows != nrows || M->n_cols != ncols){
+        stringstream err;
+        err << "In findSectors(): size of a block (" << M->n_rows << "x" 
+            << M->n_cols << ") does not match with the size of the diagonal blocks ("
+            << nrows << "x" << ncols << ").";
+        throw invalid_argument(err.str());
+    }
+    for (uint n = 0; n < ncols; ++n){
+        for (uint m = 0; m < nrows; ++m){
+            if (abs((*M)(m, n)) > tol){
+                join(parent, rowOffset + m, colOffset + n);
+            }
+        }
+    }
+}
+
+field<uwcol> findSectors(const field<shared_ptr<cxmat> > &H0, 
+        const field<shared_ptr<cxmat> > &Hl, const field<shared_ptr<cxmat> > &S0, 
+        const field<shared_ptr<cxmat> > &Sl, double tol)
+{
+    uint nb = H0.n_rows;
+    if (Hl.n_rows != nb+1){
+        throw invalid_argument("In findSectors(): size of Hl should be equal to number of blocks + 1.");
+    }
+    
+    // orbital offsets of the blocks
+    vector<uint> no(nb), offset(nb+1, 0);
+    for (uint ib = 0; ib < nb; ++ib){
+        if (!H0(ib, 0)){
+            throw invalid_argument("In findSectors(): H0 is not set.");
+        }
+        no[ib] = H0(ib, 0)->n_rows;
+        offset[ib+1] = offset[ib] + no[ib];
+    }
+    
+    vector<uint> parent(offset[nb]);
+    for (uint io = 0; io < parent.size(); ++io){
+        parent[io] = io;
+    }
+    
+    // diagonal blocks
+    for (uint ib = 0; ib < nb; ++ib){
+        for (uint in = 0; in < H0.n_cols; ++in){
+            joinCoupled(parent, H0(ib, in), offset[ib], no[ib], offset[ib], no[ib], tol);
+        }
+        for (uint in = 0; in < S0.n_cols; ++in){
+            if (ib < S0.n_rows){
+                joinCoupled(parent, S0(ib, in), offset[ib], no[ib], offset[ib], no[ib], tol);
+            }
+        }
+    }
+    // lower diagonal blocks: Hl(0) = H_0,-1 and Hl(nb) = H_nb,nb-1 couple 
+    // the contact blocks to their own copies.
+    for (uint ib = 0; ib <= nb; ++ib){
+        uint rb = (ib == nb) ? nb-1:ib;
+        uint cb = (ib == 0) ? 0:ib-1;
+        for (uint in = 0; in < Hl.n_cols; ++in){
+            joinCoupled(parent, Hl(ib, in), offset[rb], no[rb], offset[cb], no[cb], tol);
+        }
+        for (uint in = 0; in < Sl.n_cols; ++in){
+            if (ib < Sl.n_rows){
+                joinCoupled(parent, Sl(ib, in), offset[rb], no[rb], offset[cb], no[cb], tol);
+            }
+        }
+    }
+    
+    // sector of each orbital
+    map<uint, uint> sectorOf;
+    vector<uint> sector(parent.size());
+    for (uint io = 0; io < parent.size(); ++io){
+        uint root = findRoot(parent, io);
+        if (sectorOf.find(root) == sectorOf.end()){
+            uint is = sectorOf.size();
+            sectorOf[root] = is;
+        }
+        sector[io] = sectorOf[root];
+    }
+    uint ns = sectorOf.size();
+    
+    // Sectors that miss a block can not be solved by RGF on their own.
+    umat count(ns, nb, fill::zeros);
+    for (uint ib = 0; ib < nb; ++ib){
+        for (uint io = offset[ib]; io < offset[ib+1]; ++io){
+            count(sector[io], ib) += 1;
+        }
+    }
+    vector<uint> merged(ns);
+    uint nComplete = 0;
+    for (uint is = 0; is < ns; ++is){
+        if (all(count.row(is) > 0)){
+            merged[is] = nComplete++;
+        }
+    }
+    if (nComplete == 0){
+        nComplete = 1;
+        merged.assign(ns, 0);
+    }else{
+        for (uint is = 0; is < ns; ++is){
+            if (!all(count.row(is) > 0)){
+                merged[is] = 0;
+            }
+        }
+    }
+    
+    // orbital indices of each sector in each block
+    field<uwcol> sectors(nComplete, nb);
+    for (uint ib = 0; ib < nb; ++ib){
+        vector<vector<uword> > indices(nComplete);
+        for (uint io = offset[ib]; io < offset[ib+1]; ++io){
+            indices[merged[sector[io]]].push_back(io - offset[ib]);
+        }
+        for (uint is = 0; is < nComplete; ++is){
+            sectors(is, ib) = conv_to<uwcol>::from(indices[is]);
+        }
+    }
+    
+    return sectors;
+}
+
+}
+}
@@ -18,6 +18,29 @@ LinearRegion4::LinearRegion4(point lb, point rb, point rt, point lt,
     mTitle = "Quadrilateral Linear Voltage Region";
 }
 
+double LinearRegion4::V(double x, double y) const {
+    // get four points: lb, rb, rt, lt
+    const polyring &points = geom.outer();
+    double xlb = points[0].get<0>();
+    double ylb = points[0].get<1>();
+    double xrb = points[1].get<0>();
+    double yrb = points[1].get<1>();
+    double xrt = points[2].get<0>();
+    double yrt = points[2].get<1>();
+    double xlt = points[3].get<0>();
+    double ylt = points[3].get<1>();
+    // perform a linear interpolation 
+    double xl = xlb + (xlt - xlb)/(ylt - ylb)*(y-ylb);
+    double xr = xrb + (xrt - xrb)/(yrt - yrb)*(y-yrb);
+    double Vlr = this->Vl + (this->Vr - this->Vl)/(xr - xl)*(x - xl);
+
+    double yb = ylb + (yrb - ylb)/(xrb - xlb)*(x-xlb);                                                            
+    double yt = ylt + (yrt - ylt)/(xrt - xlt)*(x-xlt);
+    double Vbt = this->Vb + (this->Vt - this->Vb)/(yt - yb)*(y - yb);
+    
+    return Vlr + Vbt;
+}
+
 string LinearRegion4::toString() const { 
     stringstream ss;
     ss << Terminal4::toString() << endl;
@@ -29,7 +52,7 @@ string LinearRegion4::toString() const {
 
 
 LinearPot::LinearPot(AtomicStruct::ptr atoms, const string &prefix): 
-        Potential(atoms, prefix)
+        Potential(atoms, prefix), mnthreads(1)
 {
     mTitle = "Linear Voltage Profile";
 }
@@ -50,62 +73,185 @@ void LinearPot::VLR(int ilr, double Vl, double Vr, double Vt, double Vb){
     mlr[ilr].Vb = Vb;
 }
 
+namespace {
+
+/*
+ * A region of the potential prepared for batched evaluation. A convex
+ * quadrilateral is the intersection of four half-planes, one per edge, and
+ * its potential is
+ *   V = V0 + dVx*(x - xl(y))/(xr(y) - xl(y)) + dVy*(y - yb(x))/(yt(x) - yb(x))
+ * with xl, xr linear in y and yb, yt linear in x, as in LinearRegion4::V().
+ * The edges follow the test getPotAt() uses for the region: the source and
+ * the drain use Terminal::contains(), Franklin's crossing test, which takes
+ * the left and the bottom edges as inside; the gates and the linear regions
+ * use bg::within(), which takes all the edges as outside. Any other region 
+ * is tested with the same function as in getPotAt().
+ */
+struct BatchRegion{
+    bool      convex;
+    bool      franklin;
+    Terminal *t;
+    double    x0[4], y0[4], dx[4], dy[4];
+    bool      closed[4];
+    double    V0, dVx, dVy;
+    double    xl0, xl1, xr0, xr1;
+    double    yb0, yb1, yt0, yt1;
+    const LinearRegion4 *lr;
+
+    // constant potential V
+    BatchRegion(Terminal &t, double V, bool franklin): franklin(franklin), 
+            t(&t), V0(V), dVx(0), dVy(0), xl0(0), xl1(0), xr0(1), xr1(0), 
+            yb0(0), yb1(0), yt0(1), yt1(0), lr(nullptr)
+    {
+        halfPlanes();
+    }
+
+    // linear potential of lr
+    BatchRegion(LinearRegion4 &r): franklin(false), t(&r), V0(r.Vl + r.Vb), 
+            dVx(r.Vr - r.Vl), dVy(r.Vt - r.Vb), lr(&r)
+    {
+        halfPlanes();
+        if (!convex){
+            return;
+        }
+        const polyring &p = r.geom.outer();
+        double xlb = p[0].get<0>(), ylb = p[0].get<1>();
+        double xrb = p[1].get<0>(), yrb = p[1].get<1>();
+        double xrt = p[2].get<0>(), yrt = p[2].get<1>();
+        double xlt = p[3].get<0>(), ylt = p[3].get<1>();
+        xl1 = (xlt - xlb)/(ylt - ylb);
+        xl0 = xlb - xl1*ylb;
+        xr1 = (xrt - xrb)/(yrt - yrb);
+        xr0 = xrb - xr1*yrb;
+        yb1 = (yrb - ylb)/(xrb - xlb);
+        yb0 = ylb - yb1*xlb;
+        yt1 = (yrt - ylt)/(xrt - xlt);
+        yt0 = ylt - yt1*xlt;
+    }
+
+    // The edges of a convex ring oriented so that the inside is on the 
+    // left of each edge.
+    void halfPlanes(){
+        const polyring &p = t->geom.outer();
+        convex = (p.size() == 4);
+        if (!convex){
+            return;
+        }
+        double area = 0;
+        for (uint i = 0; i < 4; ++i){
+            const point &pi = p[i], &pj = p[(i+1)%4];
+            area += pi.get<0>()*pj.get<1>() - pj.get<0>()*pi.get<1>();
+        }
+        double sgn = area > 0 ? 1 : -1;
+        for (uint i = 0; i < 4; ++i){
+            const point &pi = p[i], &pj = p[(i+1)%4], &pk = p[(i+2)%4];
+            double ex = pj.get<0>() - pi.get<0>();
+            double ey = pj.get<1>() - pi.get<1>();
+            double turn = ex*(pk.get<1>() - pj.get<1>()) 
+                        - ey*(pk.get<0>() - pj.get<0>());
+            if (area == 0 || sgn*turn <= 0){
+                convex = false;
+                return;
+            }
+            x0[i] = pi.get<0>();
+            y0[i] = pi.get<1>();
+            dx[i] = sgn*ex;
+            dy[i] = sgn*ey;
+            // Franklin: the inside is to the right of a left edge, or above
+            // a horizontal bottom edge.
+            closed[i] = franklin && (dy[i] < 0 || (dy[i] == 0 && dx[i] > 0));
+        }
+    }
+
+    // (x, y) is on the inner side of edge i, the side of a point is 
+    // calculated as in the boost::geometry side strategy.
+    bool inside(uint i, double x, double y) const {
+        double d = dx[i]*(y - y0[i]) - dy[i]*(x - x0[i]);
+        return closed[i] ? d >= 0 : d > 0;
+    }
+
+    // (x, y) is inside a region that is not a convex quadrilateral.
+    bool contains(double x, double y) const {
+        return franklin ? t->contains(x, y) : bg::within(point(x, y), t->geom);
+    }
+
+    // potential at (x, y) of a convex region, no branches
+    double V(double x, double y) const {
+        double xl = xl0 + xl1*y, xr = xr0 + xr1*y;
+        double yb = yb0 + yb1*x, yt = yt0 + yt1*x;
+        return V0 + dVx*(x - xl)/(xr - xl) + dVy*(y - yb)/(yt - yb);
+    }
+};
+
+}
+
 /*
- * Calculates linear potential.
+ * Calculates linear potential of all the atoms in one pass. The regions 
+ * are prepared once per call, so that changing the voltages between the 
+ * calls is cheap. The atoms are split into chunks that run on mnthreads 
+ * threads. In a chunk, each region is tested against all the atoms with 
+ * branch-free loops that the compiler can vectorize. An atom takes the 
+ * potential of the first region it is in: source, drain, gates and linear
+ * regions in that order, with the same edge rules as getPotAt().
  */
 void LinearPot::compute(){
-    // loop over all the atoms
-    int na = ma->NumOfAtoms();
-    for(int ia = 0; ia < na; ++ia){
-        double x = ma->X(ia);
-        double y = ma->Y(ia);
-        
-/*        // source
-        if(!ms.empty() && ms[0].contains(x, y)){
-            V = ms[0].V;
-        // drain
-        }else if (!md.empty() && md[0].contains(x, y)){
-            V = md[0].V;
-        // gates
-        }else{
-            // search x,y inside the gates
-            vector<gate>::iterator itg = find_if(mg.begin(), mg.end(), 
-                    Contains(x,y));
-            // found inside a gate
-            if (itg != mg.end()){
-                gate g = *itg;
-                V = g.V;
-            // not fount inside any gate, search it on linear regions
-            }else{
-                vector<linear_region>::iterator itl = find_if(mlr.begin(), mlr.end(), 
-                        Contains(x,y));
-                // found inside linear region
-                if(itl  != mlr.end()){
-                    // get four points: lb, rb, rt, lt
-                    polyring points = itl->geom.outer();
-                    double xlb = points[0].get<0>();
-                    double ylb = points[0].get<1>();
-                    double xrb = points[1].get<0>();
-                    double yrb = points[1].get<1>();
-                    double xrt = points[2].get<0>();
-                    double yrt = points[2].get<1>();
-                    double xlt = points[3].get<0>();
-                    double ylt = points[3].get<1>();
-                    
-                    double xl = xlb + (xlt - xlb)/(ylt - ylb)*(y-ylb);
-                    double xr = xrb + (xrt - xrb)/(yrt - yrb)*(y-yrb);
-                    double Vlr = itl->Vl + (itl->Vr - itl->Vl)/(xr - xl)*(x - xl);
-
-                    double yb = ylb + (yrb - ylb)/(xrb - xlb)*(x-xlb);                                                            
-                    double yt = ylt + (yrt - ylt)/(xrt - xlt)*(x-xlt);
-                    double Vbt = itl->Vb + (itl->Vt - itl->Vb)/(yt - yb)*(y - yb);
-                    
-                    V = (Vlr + Vbt);
+    mV.zeros();
+    if (!ma){
+        return;
+    }
+    if (mV.n_elem != (uword)ma->NumOfAtoms()){
+        throw invalid_argument("In LinearPot::compute(): the potential must have one value per atom.");
+    }
+
+    vector<BatchRegion> regions;
+    if (!ms.empty()){
+        regions.push_back(BatchRegion(ms[0], ms[0].V, true));
+    }
+    if (!md.empty()){
+        regions.push_back(BatchRegion(md[0], md[0].V, true));
+    }
+    for (uint it = 0; it < mg.size(); ++it){
+        regions.push_back(BatchRegion(mg[it], mg[it].V, false));
+    }
+    for (uint it = 0; it < mlr.size(); ++it){
+        regions.push_back(BatchRegion(mlr[it]));
+    }
+
+    const uint chunk = 4096;
+    uint na = ma->NumOfAtoms();
+    uint nchunks = (na + chunk - 1)/chunk;
+    vec X = ma->X(), Y = ma->Y();
+    double *V = mV.memptr();
+
+    parallelFor(nchunks, mnthreads, [&](uint ic){
+        uint start = ic*chunk;
+        uint n = std::min(chunk, na - start);
+        const double *x = X.memptr() + start, *y = Y.memptr() + start;
+        double *v = V + start;
+        unsigned char done[chunk] = {0};
+
+        for (uint ir = 0; ir < regions.size(); ++ir){
+            const BatchRegion &r = regions[ir];
+            if (!r.convex){
+                for (uint i = 0; i < n; ++i){
+                    if (!done[i] && r.contains(x[i], y[i])){
+                        v[i] = r.lr ? r.lr->V(x[i], y[i]) : r.V0;
+                        done[i] = 1;
+                    }
                 }
+                continue;
             }
-        }*/
-        mV(ia) = getPotAt(x, y);
-    }
+            for (uint i = 0; i < n; ++i){
+                unsigned char in = r.inside(0, x[i], y[i]) 
+                                 & r.inside(1, x[i], y[i])
+                                 & r.inside(2, x[i], y[i]) 
+                                 & r.inside(3, x[i], y[i]);
+                double Vi = r.V(x[i], y[i]);
+                v[i] = (in & !done[i]) ? Vi : v[i];
+                done[i] |= in;
+            }
+        }
+    });
 }
 
 double LinearPot::getPotAt(const point& p){
@@ -134,8 +280,7 @@ double LinearPot::getPotAt(double x, double y){
     auto itg = find_if(mg.begin(), mg.end(), Contains(x,y));
     // found inside a gate
     if (itg != mg.end()){
-        gate g = *itg;
-        V = g.V;
+        V = itg->V;
         return V;
     }
 
@@ -143,26 +288,7 @@ double LinearPot::getPotAt(double x, double y){
     auto itl = find_if(mlr.begin(), mlr.end(), Contains(x,y));
     // found inside linear region
     if(itl  != mlr.end()){
-        // get four points: lb, rb, rt, lt
-        polyring points = itl->geom.outer();
-        double xlb = points[0].get<0>();
-        double ylb = points[0].get<1>();
-        double xrb = points[1].get<0>();
-        double yrb = points[1].get<1>();
-        double xrt = points[2].get<0>();
-        double yrt = points[2].get<1>();
-        double xlt = points[3].get<0>();
-        double ylt = points[3].get<1>();
-        // perform a linear interpolation 
-        double xl = xlb + (xlt - xlb)/(ylt - ylb)*(y-ylb);
-        double xr = xrb + (xrt - xrb)/(yrt - yrb)*(y-yrb);
-        double Vlr = itl->Vl + (itl->Vr - itl->Vl)/(xr - xl)*(x - xl);
-
-        double yb = ylb + (yrb - ylb)/(xrb - xlb)*(x-xlb);                                                            
-        double yt = ylt + (yrt - ylt)/(xrt - xlt)*(x-xlt);
-        double Vbt = itl->Vb + (itl->Vt - itl->Vb)/(yt - yb)*(y - yb);
-        
-        V = (Vlr + Vbt);
+        V = itl->V(x, y);
         return V;
     }
 
@@ -23,6 +23,24 @@ Potential::Potential(AtomicStruct::ptr atoms, const string &prefix):
 
     mRho.set_size(mgrid.n_rows);
     mRho.zeros();
+
+    // orbital offsets of the atoms, built once for toOrbPot(), which 
+    // checks that the atoms have not changed since.
+    uint na = mgrid.n_rows;
+    morb0.set_size(na + 1);
+    morb0(0) = 0;
+    if (ma){
+        AtomicStructView a(*ma);
+        for (uint ia = 0; ia < na; ++ia){
+            morb0(ia+1) = morb0(ia) + a.NumOfOrbitalsAt(ia);
+        }
+    }
+    morbAtom.set_size(morb0(na));
+    for (uint ia = 0; ia < na; ++ia){
+        for (uint io = morb0(ia); io < morb0(ia+1); ++io){
+            morbAtom(io) = ia;
+        }
+    }
 }
 
 
@@ -44,32 +62,69 @@ string Potential::toString() const{
     return ss.str();
 }
 
-// Convert atomic potential to orbital potential
-shared_ptr<vec> Potential::toOrbPot(span s){
+uint Potential::NumOfOrbitals(span s) const {
+    uint na = mgrid.n_rows;
+    uint ia = s.whole ? 0 : s.a;
+    uint ja = s.whole ? na : s.b + 1;
+    if (ia > ja || ja > na){
+        throw invalid_argument("In Potential::NumOfOrbitals(): atoms out of range.");
+    }
+    return morb0(ja) - morb0(ia);
+}
+
+/*
+ * Convert atomic potential to orbital potential. The orbitals of atoms s
+ * are a contiguous range of the orbital to atom table, so the potential 
+ * is gathered in one loop.
+ */
+void Potential::toOrbPot(vec &V, span s) const {
     if (ma == nullptr) {
         throw runtime_error("Potential::toOrbPot(): I do not have an atomistic object");
     }
+    if (morb0.n_elem != (uword)ma->NumOfAtoms() + 1 
+            || morb0(morb0.n_elem - 1) != (uword)ma->NumOfOrbitals()){
+        throw invalid_argument("In Potential::toOrbPot(): the atoms have changed since the potential was created.");
+    }
 
-    AtomicStruct a = (*ma)(s);
-    int no = a.NumOfOrbitals();
-    int na = a.NumOfAtoms();
-    shared_ptr<vec> pV = make_shared<vec>(no, fill::zeros);
-    vec &V = *pV;
+    uint no = NumOfOrbitals(s);
+    uint io0 = s.whole ? 0 : morb0(s.a);
+    V.set_size(no);
 
-    int io = 0;
-    // loop through the atoms we are interested in
-    for (int ia = 0; ia < na; ++ia){
-        int n = a.AtomAt(ia).no;
-        // fill the orbitals of atom ia with its potential
-        V(span(io,io+n-1)).fill(mV(ia + s.a));
-        io += n;
-    }  
+    const uint *atom = morbAtom.memptr() + io0;
+    const double *Va = mV.memptr();
+    double *Vo = V.memptr();
+    for (uint io = 0; io < no; ++io){
+        Vo[io] = Va[atom[io]];
+    }
+}
+
+void Potential::toOrbPot(field<shared_ptr<vec> > &V, const ucol &nab) const {
+    if (any(nab == 0) || sum(nab) > mgrid.n_rows){
+        throw invalid_argument("In Potential::toOrbPot(): the blocks must have at least one atom and at most all the atoms of the device.");
+    }
 
+    V.set_size(nab.n_elem);
+    uint ia = 0;
+    for (uint ib = 0; ib < nab.n_elem; ++ib){
+        span s(ia, ia + nab(ib) - 1);
+        if (!V(ib) || V(ib)->n_elem != NumOfOrbitals(s)){
+            V(ib) = make_shared<vec>(NumOfOrbitals(s));
+        }
+        toOrbPot(*V(ib), s);
+        ia += nab(ib);
+    }
+}
+
+shared_ptr<vec> Potential::toOrbPot(span s){
+    shared_ptr<vec> pV = make_shared<vec>();
+    toOrbPot(*pV, s);
     return pV;
 }
 
 vec Potential::toOrbPot(uint start, uint end){
-    return *toOrbPot(span(start, end));
+    vec V;
+    toOrbPot(V, span(start, end));
+    return V;
 }
 
 double Potential::Vatom(uint ia){
@@ -0,0 +1,144 @@
+/*
+ * File:   Profiler.cpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 6:30 PM
+ */
+
+#include "utils/Profiler.h"
+
+#include <iomanip>
+
+namespace utils{
+
+namespace mpi = boost::mpi;
+
+Profiler::Profiler(const string &prefix): Printable(prefix), menabled(false),
+        mnranks(0)
+{
+    mTitle = "Profile";
+}
+
+uint Profiler::addPhase(const string &name){
+    mnames.push_back(name);
+    mtimes.push_back(0);
+    mcalls.push_back(0);
+    mcounts.push_back(0);
+    return mnames.size() - 1;
+}
+
+void Profiler::enable(bool enable){
+    menabled = enable;
+}
+
+void Profiler::reset(){
+    mtimes.assign(mnames.size(), 0);
+    mcalls.assign(mnames.size(), 0);
+    mcounts.assign(mnames.size(), 0);
+    mstack.clear();
+    mnranks = 0;
+    mminTimes.clear();
+    mavgTimes.clear();
+    mmaxTimes.clear();
+    mtotCalls.clear();
+    mtotCounts.clear();
+}
+
+void Profiler::start(uint phase){
+    if (!menabled){
+        return;
+    }
+    Frame f = {phase, clock::now(), 0};
+    mstack.push_back(f);
+}
+
+void Profiler::stop(uint phase){
+    if (!menabled || mstack.empty()){
+        return;
+    }
+    if (mstack.back().phase != phase){
+        throw runtime_error("In Profiler::stop(): phase " + mnames[phase]
+                + " is not the last one started.");
+    }
+
+    const Frame &f = mstack.back();
+    double dt = std::chrono::duration<double>(clock::now() - f.t0).count();
+    mtimes[phase] += dt - f.inner;
+    mcalls[phase] += 1;
+    mstack.pop_back();
+    if (!mstack.empty()){
+        mstack.back().inner += dt;
+    }
+}
+
+/*
+ * Collects the minimum, average and maximum time of each phase over all
+ * the ranks on root. The calls and counts are summed up.
+ */
+void Profiler::reduce(const mpi::communicator &comm, int root){
+    uint n = mnames.size();
+    if (n == 0){
+        return;
+    }
+    mnranks = comm.size();
+    mminTimes.resize(n);
+    mavgTimes.resize(n);
+    mmaxTimes.resize(n);
+    mtotCalls.resize(n);
+    mtotCounts.resize(n);
+
+    mpi::reduce(comm, &mtimes[0], n, &mminTimes[0], mpi::minimum<double>(), root);
+    mpi::reduce(comm, &mtimes[0], n, &mmaxTimes[0], mpi::maximum<double>(), root);
+    mpi::reduce(comm, &mtimes[0], n, &mavgTimes[0], std::plus<double>(), root);
+    mpi::reduce(comm, &mcalls[0], n, &mtotCalls[0], std::plus<long>(), root);
+    mpi::reduce(comm, &mcounts[0], n, &mtotCounts[0], std::plus<long>(), root);
+
+    for (uint ip = 0; ip < n; ++ip){
+        mavgTimes[ip] /= mnranks;
+    }
+}
+
+long Profiler::calls(uint phase) const {
+    return mnranks ? mtotCalls[phase] : mcalls[phase];
+}
+
+long Profiler::counts(uint phase) const {
+    return mnranks ? mtotCounts[phase] : mcounts[phase];
+}
+
+double Profiler::minTime(uint phase) const {
+    return mnranks ? mminTimes[phase] : mtimes[phase];
+}
+
+double Profiler::avgTime(uint phase) const {
+    return mnranks ? mavgTimes[phase] : mtimes[phase];
+}
+
+double Profiler::maxTime(uint phase) const {
+    return mnranks ? mmaxTimes[phase] : mtimes[phase];
+}
+
+string Profiler::toString() const {
+    stringstream out;
+    out << Printable::toString() << " (" << (mnranks ? mnranks : 1)
+        << " rank" << (mnranks > 1 ? "s" : "") << ", time in s):" << endl;
+    out << mPrefix << " " << std::left << std::setw(24) << "Phase" << std::right
+        << std::setw(10) << "Calls" << std::setw(12) << "Count"
+        << std::setw(12) << "Min" << std::setw(12) << "Avg"
+        << std::setw(12) << "Max";
+    for (uint ip = 0; ip < mnames.size(); ++ip){
+        if (calls(ip) == 0){
+            continue;
+        }
+        out << endl << mPrefix << " " << std::left << std::setw(24) << mnames[ip]
+            << std::right << std::setw(10) << calls(ip)
+            << std::setw(12) << counts(ip) << std::fixed << std::setprecision(4)
+            << std::setw(12) << minTime(ip) << std::setw(12) << avgTime(ip)
+            << std::setw(12) << maxTime(ip);
+    }
+
+    return out.str();
+}
+
+}
+
@@ -0,0 +1,49 @@
+/*
+ * File:   atomicfile.cpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 9:40 PM
+ */
+
+#include "utils/atomicfile.h"
+
+#include <cstdio>
+
+namespace utils{
+using namespace stds;
+
+void writeAtomically(const string &fileName, 
+        const std::function<void(ofstream&)> &write, const string &where)
+{
+    string tmpFileName = fileName + ".tmp";
+    {
+        ofstream out(tmpFileName.c_str(), ios::binary);
+        if (!out.is_open()){
+            throw ios_base::failure(" " + where + ": Failed to open file " 
+                    + tmpFileName + ".");
+        }
+        
+        try{
+            write(out);
+            out.flush();
+        }catch(...){
+            out.close();
+            std::remove(tmpFileName.c_str());
+            throw;
+        }
+        
+        if (!out.good()){
+            out.close();
+            std::remove(tmpFileName.c_str());
+            throw ios_base::failure(" " + where + ": Failed to write file " 
+                    + tmpFileName + ".");
+        }
+    }
+    if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0){
+        std::remove(tmpFileName.c_str());
+        throw ios_base::failure(" " + where + ": Failed to rename " 
+                + tmpFileName + " to " + fileName + ".");
+    }
+}
+
+}
@@ -0,0 +1,65 @@
+/*
+ * File:   parallel.cpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 20, 2026, 1:05 AM
+ */
+
+#include "utils/parallel.h"
+
+#include <atomic>
+#include <exception>
+#include <thread>
+
+namespace utils{
+using namespace stds;
+
+uint numThreads(uint nthreads){
+    if (nthreads == 0){
+        nthreads = std::thread::hardware_concurrency();
+    }
+    return std::max(nthreads, 1u);
+}
+
+void parallelFor(uint n, uint nthreads, 
+        const std::function<void(uint)> &work)
+{
+    nthreads = std::min(numThreads(nthreads), n);
+    if (nthreads <= 1){
+        for (uint i = 0; i < n; ++i){
+            work(i);
+        }
+        return;
+    }
+    
+    std::atomic<uint> next(0);
+    vector<std::exception_ptr> errors(n);
+    auto worker = [&](){
+        for (uint i = next++; i < n; i = next++){
+            try{
+                work(i);
+            }catch(...){
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+    
+    vector<std::thread> threads;
+    for (uint it = 1; it < nthreads; ++it){
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for (uint it = 0; it < threads.size(); ++it){
+        threads[it].join();
+    }
+    
+    for (uint i = 0; i < n; ++i){
+        if (errors[i]){
+            std::rethrow_exception(errors[i]);
+        }
+    }
+}
+
+
+}
+
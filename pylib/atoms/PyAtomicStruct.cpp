@@ -10,6 +10,8 @@
  */
 
 #include "PyAtomicStruct.h"
+#include "atoms/GeomFile.h"
+#include "atoms/Supercell.h"
 
 /**
  * Python exporters.
@@ -53,6 +55,15 @@ void (AtomicStruct::*AtomicStruct_genSimpleCubicStruct1)(const Atom &, double, u
 void (AtomicStruct::*AtomicStruct_genGNR1)(const Atom &, double, uint, uint, uint) = &AtomicStruct::genGNR;
 //void (AtomicStruct::*AtomicStruct_genGNR2)(const Atom &, double, double, double, double) = &AtomicStruct::genGNR;
 lvec (AtomicStruct::*AtomicStruct_LatticeVector1)() const = &AtomicStruct::LatticeVector;
+AtomicStruct (AtomicStruct::*AtomicStruct_select)(const ucol&) const = &AtomicStruct::operator();
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(AtomicStruct_replicate, replicate, 1, 3)
+AtomicStruct concat_list(const boost::python::list &parts){
+    vector<AtomicStruct> vparts;
+    for (long ip = 0; ip < len(parts); ++ip){
+        vparts.push_back(extract<const AtomicStruct&>(parts[ip]));
+    }
+    return concat(vparts);
+}
 void export_AtomicStruct(){
     class_<AtomicStruct, bases<Printable>, shared_ptr<AtomicStruct> >("AtomicStruct", 
             init<>())
@@ -74,21 +85,51 @@ void export_AtomicStruct(){
         .add_property("NumOfOrbitals", &AtomicStruct::NumOfOrbitals) 
         .add_property("NumOfElectrons", &AtomicStruct::NumOfElectrons) 
         .def("span", &AtomicStruct::span)
+        .def("select", AtomicStruct_select)
         .def("genRectLattAtoms", &AtomicStruct::genRectLattAtoms)
         .def("genSimpleCubicStruct", AtomicStruct_genSimpleCubicStruct1)
         //.def("genSimpleCubicStruct", AtomicStruct_genSimpleCubicStruct2)
         .def("genGNR", AtomicStruct_genGNR1)
+        .def("replicate", &AtomicStruct::replicate, AtomicStruct_replicate())
+        .def("inBox", &AtomicStruct::inBox)
+        .def("inPolygon", &AtomicStruct::inPolygon)
+        .def("inSphere", &AtomicStruct::inSphere)
+        .def("nearest", &AtomicStruct::nearest)
         //.def("genGNR", AtomicStruct_genGNR2)
         .def("exportGjf", &AtomicStruct::exportGjf)
         .def("importGjf", &AtomicStruct::importGjf)
+        .def("exportGeom", &AtomicStruct::exportGeom)
+        .def("importGeom", &AtomicStruct::importGeom)
         .def(self + self)
         .def(self + svec())
         .def(self - svec())
         .def(self + lcoord())
         .def(self - lcoord())
     ;
+    
+    def("concat", concat_list, " Concatenates a list of structures with a single allocation.");
+    def("gjfToGeom", gjfToGeom, " Converts a GJF file to a binary geometry file.");
+    def("geomToGjf", geomToGjf, " Converts a binary geometry file to a GJF file.");
 }
 
-}
+/**
+ * Lazily replicated supercell.
+ */
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Supercell_toStruct, toStruct, 0, 1)
+void export_Supercell(){
+    class_<Supercell, shared_ptr<Supercell> >("Supercell", 
+            init<const AtomicStruct&, uint, optional<uint, uint> >())
+        .add_property("NumOfAtoms", &Supercell::NumOfAtoms)
+        .add_property("NumOfOrbitals", &Supercell::NumOfOrbitals)
+        .add_property("LatticeVector", &Supercell::LatticeVector)
+        .add_property("basis", make_function(&Supercell::basis, return_value_policy<copy_const_reference>()))
+        .def("X", &Supercell::X)
+        .def("Y", &Supercell::Y)
+        .def("Z", &Supercell::Z)
+        .def("AtomicNumber", &Supercell::AtomicNumber)
+        .def("toStruct", &Supercell::toStruct, Supercell_toStruct())
+    ;
 }
 
+}
+}
@@ -0,0 +1,60 @@
+/* 
+ * File:   pykpstencil.cpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 11:40 PM
+ */
+
+#include "boostpython.hpp"
+#include "hamiltonian/kp/dirackp.h"
+#include "hamiltonian/kp/tikp.h"
+#include "hamiltonian/kp/tikp4.h"
+#include "hamiltonian/kp/kpstencil.h"
+
+#include <map>
+
+/**
+ * Python exporters.
+ */
+namespace quest{namespace python{
+using namespace hamiltonian;
+namespace bp = boost::python;
+
+// python list of blocks. A shared block is converted only once.
+static bp::list toList(const field<shared_ptr<cxmat> > &blocks){
+    std::map<const cxmat*, bp::object> converted;
+    bp::list out;
+    for (uint ib = 0; ib < blocks.n_elem; ++ib){
+        const cxmat *blk = blocks(ib).get();
+        if (converted.find(blk) == converted.end()){
+            converted[blk] = bp::object(*blk);
+        }
+        out.append(converted[blk]);
+    }
+    return out;
+}
+
+/**
+ * Returns ([H0], [Hl], [S0]) of a rectangular grid of nx x ny points.
+ */
+template<class P>
+bp::tuple generateKpBlocks(const P &p, uint nx, uint ny, double x0, double y0){
+    field<shared_ptr<cxmat> > H0, Hl, S0;
+    generateKpBlocks(H0, Hl, S0, p, nx, ny, x0, y0);
+    return bp::make_tuple(toList(H0), toList(Hl), toList(S0));
+}
+
+/**
+ * Stencil based block generator of the k.p models.
+ */
+void export_KpStencil(){
+    def("generateKpBlocks", generateKpBlocks<DiracKpParams>, 
+            " Generates the block-tridiagonal H0, Hl and S0 of an nx x ny grid.");
+    def("generateKpBlocks", generateKpBlocks<TISurfKpParams>, 
+            " Generates the block-tridiagonal H0, Hl and S0 of an nx x ny grid.");
+    def("generateKpBlocks", generateKpBlocks<TISurfKpParams4>, 
+            " Generates the block-tridiagonal H0, Hl and S0 of an nx x ny grid.");
+}
+
+}}
+
@@ -10,6 +10,10 @@
 
 #include "boostpython.hpp"
 #include "hamiltonian/hamiltonian.hpp"
+#include "hamiltonian/partition.hpp"
+#include "hamiltonian/bonds.h"
+#include "hamiltonian/pargen.h"
+#include "hamiltonian/hamcache.h"
 
 /**
  * Python exporters.
@@ -21,15 +25,78 @@ using namespace atoms;
 using namespace utils::stds;
 namespace bp = boost::python;
 
+// python list of blocks to vector.
+static vector<AtomicStruct> toBlocks(const bp::list &blocks){
+    vector<AtomicStruct> out;
+    for (long ib = 0; ib < bp::len(blocks); ++ib){
+        out.push_back(bp::extract<const AtomicStruct&>(blocks[ib]));
+    }
+    return out;
+}
+
 bp::tuple generateHamOvl(const HamParams<cxmat> &p, const AtomicStruct &bi, 
         const AtomicStruct &bj)
 {
     cxmat H, S;
-    generateHamOvl(H, S, p, bi, bj);
+    generateHamOvl(H, S, p, AtomicStructView(bi), AtomicStructView(bj));
+    
+    return bp::make_tuple(H, S);
+}
+
+bp::tuple generateHamOvlThreads(const HamParams<cxmat> &p, const AtomicStruct &bi, 
+        const AtomicStruct &bj, uint nthreads)
+{
+    cxmat H, S;
+    generateHamOvl(H, S, p, AtomicStructView(bi), AtomicStructView(bj), nthreads);
+    
+    return bp::make_tuple(H, S);
+}
+
+/**
+ * Bond lists of the pairs of blocks (bi[ib], bj[ib]) generated on nthreads 
+ * threads.
+ */
+bp::list generateBondsThreads(const HamParams<cxmat> &p, const bp::list &bi, 
+        const bp::list &bj, uint nthreads)
+{
+    vector<shared_ptr<BondHam> > bonds = generateBonds(p, toBlocks(bi), 
+            toBlocks(bj), nthreads);
+    bp::list out;
+    for (uint ib = 0; ib < bonds.size(); ++ib){
+        out.append(bonds[ib]);
+    }
+    return out;
+}
+
+bp::tuple generateSpHamOvl(const HamParams<cxmat> &p, const AtomicStruct &bi, 
+        const AtomicStruct &bj)
+{
+    sp_cx_mat H, S;
+    generateSpHamOvl(H, S, p, AtomicStructView(bi), AtomicStructView(bj));
     
     return bp::make_tuple(H, S);
 }
 
+/**
+ * Partitions the device into block-tridiagonal blocks. Returns the device 
+ * with the atoms reordered block by block and the number of atoms in each 
+ * block.
+ */
+bp::tuple partitionBlocks(const HamParams<cxmat> &p, const AtomicStruct &dev, 
+        const AtomicStruct &lc, const AtomicStruct &rc)
+{
+    field<ucol> blocks = partition(p, dev, lc, rc);
+    
+    ucol order;
+    bp::list nbw;
+    for (uint ib = 0; ib < blocks.n_elem; ++ib){
+        order = join_cols(order, blocks(ib));
+        nbw.append(blocks(ib).n_elem);
+    }
+    
+    return bp::make_tuple(dev(order), nbw);
+}
+
 // Helper functions just to make boost::python happy.
 double cxhamparams_getBz2(const cxhamparams &self){
     return self.Bz();
@@ -38,11 +105,54 @@ void cxhamparams_setBz2(cxhamparams &self, double Bz){
     self.Bz(Bz);
 }
 
+// Helper functions for the bond list Hamiltonian.
+shared_ptr<BondHam> BondHam_init(const cxhamparams &p, const AtomicStruct &bi, 
+        const AtomicStruct &bj){
+    return make_shared<BondHam>(p, AtomicStructView(bi), AtomicStructView(bj));
+}
+cxmat BondHam_H(const BondHam &self){
+    return self.H();
+}
+cxmat BondHam_S(const BondHam &self){
+    return self.S();
+}
+
+// Helper functions for the Hamiltonian cache.
+string HamCache_key(const HamCache &self, const cxhamparams &p, 
+        const bp::list &bi, const bp::list &bj){
+    return self.key(p, toBlocks(bi), toBlocks(bj));
+}
+// Returns ([H], [S]) or None if key is not in the cache.
+bp::object HamCache_load(const HamCache &self, const string &key){
+    vector<cxmat> H, S;
+    if (!self.load(key, H, S)){
+        return bp::object();
+    }
+    bp::list Hs, Ss;
+    for (uint ib = 0; ib < H.size(); ++ib){
+        Hs.append(H[ib]);
+        Ss.append(S[ib]);
+    }
+    return bp::make_tuple(Hs, Ss);
+}
+void HamCache_save(const HamCache &self, const string &key, const bp::list &H, 
+        const bp::list &S){
+    vector<cxmat> vH, vS;
+    for (long ib = 0; ib < bp::len(H); ++ib){
+        vH.push_back(bp::extract<cxmat>(H[ib]));
+    }
+    for (long ib = 0; ib < bp::len(S); ++ib){
+        vS.push_back(bp::extract<cxmat>(S[ib]));
+    }
+    self.save(key, vH, vS);
+}
+
 /**
  * Hamiltonian parameters.
  */
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(cxhamparams_setBz, Bz, 1, 2)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(cxhamparams_getBz, Bz, 0, 0)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(BondHam_setBz, Bz, 1, 2)
 double (cxhamparams::*cxhamparams_getdtol)() const = &cxhamparams::dtol;
 void (cxhamparams::*cxhamparams_setdtol)(double) = &cxhamparams::dtol;
 const PeriodicTable& (cxhamparams::*cxhamparams_getptable)() const = &cxhamparams::periodicTable;
@@ -59,7 +169,28 @@ void export_cxhamparams(){
         .def("setBz",  static_cast< void(cxhamparams::*) (double, int)>(&cxhamparams::Bz), cxhamparams_setBz())
     ;
     
+    class_<BondHam, shared_ptr<BondHam> >("BondHam", no_init)
+        .def("__init__", bp::make_constructor(&BondHam_init))
+        .def("H", &BondHam_H)
+        .def("S", &BondHam_S)
+        .def("getBz", static_cast< double(BondHam::*) () const >(&BondHam::Bz))
+        .def("setBz", static_cast< void(BondHam::*) (double, int)>(&BondHam::Bz), BondHam_setBz())
+        .def("nnz", &BondHam::nnz)
+    ;
+    
+    class_<HamCache, shared_ptr<HamCache> >("HamCache", 
+            init<optional<const string&> >())
+        .def("key", &HamCache_key)
+        .def("fileName", &HamCache::fileName)
+        .def("load", &HamCache_load)
+        .def("save", &HamCache_save)
+    ;
+    
     def("generateHamOvl", generateHamOvl, " Generates Hamiltonian and Overlap matrices.");    
+    def("generateHamOvl", generateHamOvlThreads, " Generates Hamiltonian and Overlap matrices on nthreads threads, 0: all.");    
+    def("generateBonds", generateBondsThreads, " Generates the bond lists of many pairs of blocks on nthreads threads, 0: all.");
+    def("generateSpHamOvl", generateSpHamOvl, " Generates Hamiltonian and Overlap matrices as scipy.sparse.csc_matrix.");
+    def("partitionBlocks", partitionBlocks, " Partitions a device into the thinnest block-tridiagonal blocks.");
 }
 
 }
@@ -105,10 +105,19 @@ void PyCohRgfLoop::atomsTracedOver(const ucol& atomsTracedOver){
 
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohRgfLoop_enableTE, enableTE, 0, 1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohRgfLoop_enableI, enableI, 0, 3)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohRgfLoop_enableIMap, enableIMap, 0, 1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohRgfLoop_enableDOS, enableDOS, 0, 1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohRgfLoop_enablen, enablen, 0, 2)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohRgfLoop_enablep, enablep, 0, 2)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohRgfLoop_save, save, 1, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohRgfLoop_decimate, decimate, 0, 1)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohRgfLoop_sectors, sectors, 0, 1)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohRgfLoop_banded, banded, 0, 1)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohRgfLoop_profile, profile, 0, 1)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohRgfLoop_checkpoint, checkpoint, 1, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohRgfLoop_restart, restart, 0, 1)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohRgfLoop_addBias, addBias, 0, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohRgfLoop_saveBias, saveBias, 2, 3)
 //void (PyCohRgfLoop::*PyCohRgfLoop_H0_1)(bp::object, int, int) = &PyCohRgfLoop::H0;
 //void (PyCohRgfLoop::*PyCohRgfLoop_S0_1)(bp::object, int, int) = &PyCohRgfLoop::S0;
 //void (PyCohRgfLoop::*PyCohRgfLoop_Hl_1)(bp::object, int, int) = &PyCohRgfLoop::Hl;
@@ -156,11 +165,24 @@ void export_CohRgfLoop(){
         .def("pv0", PyCohRgfLoop_pv0_1)
         .def("pvl", PyCohRgfLoop_pvl_1)
         .def("atomsTracedOver", PyCohRgfLoop_atomsTracedOver_1)
+        .def("decimate", &PyCohRgfLoop::decimate, PyCohRgfLoop_decimate())
+        .def("sectors", &PyCohRgfLoop::sectors, PyCohRgfLoop_sectors())
+        .def("banded", &PyCohRgfLoop::banded, PyCohRgfLoop_banded())
+        .def("profile", &PyCohRgfLoop::profile, PyCohRgfLoop_profile())
+        .def("profiler", &PyCohRgfLoop::profiler, return_internal_reference<>())
+        .def("checkpoint", &PyCohRgfLoop::checkpoint, PyCohRgfLoop_checkpoint())
+        .def("restart", &PyCohRgfLoop::restart, PyCohRgfLoop_restart())
+        .def("addBias", &PyCohRgfLoop::addBias, PyCohRgfLoop_addBias())
+        .def("clearBias", &PyCohRgfLoop::clearBias)
+        .def("nbias", &PyCohRgfLoop::nbias)
+        .def("saveBias", &PyCohRgfLoop::saveBias, PyCohRgfLoop_saveBias())
         .def("run", &PyCohRgfLoop::run)
         .def("save", &PyCohRgfLoop::save, PyCohRgfLoop_save())
         .def("enableTE", &PyCohRgfLoop::enableTE, PyCohRgfLoop_enableTE())
         .def("enableI", &PyCohRgfLoop::enableI, PyCohRgfLoop_enableI())
+        .def("enableIMap", &PyCohRgfLoop::enableIMap, PyCohRgfLoop_enableIMap())
         .def("enableDOS", &PyCohRgfLoop::enableDOS, PyCohRgfLoop_enableDOS())
+        .def("enableLDOSMap", &PyCohRgfLoop::enableLDOSMap)
         .def("enablen", &PyCohRgfLoop::enablen, PyCohRgfLoop_enablen())
         .def("enablep", &PyCohRgfLoop::enablep, PyCohRgfLoop_enablep())
     ;
@@ -0,0 +1,97 @@
+/* 
+ * File:   PyCohSpLoop.cpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ *
+ * Created on October 19, 2026, 2:05 PM
+ */
+
+#include "PyCohSpLoop.h"
+
+/**
+ * Python exporters.
+ */
+namespace quest{
+namespace python{
+
+PyCohSpLoop::PyCohSpLoop(const Workers &workers, double kT, dcmplx ieta, 
+        bool orthogonal, string newprefix): 
+        CohSpLoop(workers, kT, ieta, orthogonal, newprefix)
+{
+}
+
+void PyCohSpLoop::H(const cxmat& H){
+    CohSpLoop::H(make_shared<sp_cx_mat>(H));
+}
+
+void PyCohSpLoop::S(const cxmat& S){
+    CohSpLoop::S(make_shared<sp_cx_mat>(S));
+}
+
+void PyCohSpLoop::H(const sp_cx_mat& H){
+    CohSpLoop::H(make_shared<sp_cx_mat>(H));
+}
+
+void PyCohSpLoop::S(const sp_cx_mat& S){
+    CohSpLoop::S(make_shared<sp_cx_mat>(S));
+}
+
+void PyCohSpLoop::V(const col& V){
+    CohSpLoop::V(make_shared<col>(V));
+}
+
+uint PyCohSpLoop::addLead(const cxmat& H0, const cxmat& H01, const cxmat& Hc,
+        const ucol& orbs, double VL)
+{
+    return CohSpLoop::addLead(make_shared<cxmat>(H0), make_shared<cxmat>(H01), 
+            make_shared<cxmat>(Hc), make_shared<uwcol>(conv_to<uwcol>::from(orbs)), VL);
+}
+
+uint PyCohSpLoop::addLead(const cxmat& H0, const cxmat& H01, const cxmat& Hc,
+        const ucol& orbs, double VL, const cxmat& S0, const cxmat& S01, 
+        const cxmat& Sc)
+{
+    return CohSpLoop::addLead(make_shared<cxmat>(H0), make_shared<cxmat>(H01), 
+            make_shared<cxmat>(Hc), make_shared<uwcol>(conv_to<uwcol>::from(orbs)), VL,
+            make_shared<cxmat>(S0), make_shared<cxmat>(S01), make_shared<cxmat>(Sc));
+}
+
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohSpLoop_enableTE, enableTE, 0, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohSpLoop_enableI, enableI, 0, 1)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PyCohSpLoop_save, save, 1, 2)
+void (PyCohSpLoop::*PyCohSpLoop_H_1)(const cxmat&) = &PyCohSpLoop::H;
+void (PyCohSpLoop::*PyCohSpLoop_H_2)(const sp_cx_mat&) = &PyCohSpLoop::H;
+void (PyCohSpLoop::*PyCohSpLoop_S_1)(const cxmat&) = &PyCohSpLoop::S;
+void (PyCohSpLoop::*PyCohSpLoop_S_2)(const sp_cx_mat&) = &PyCohSpLoop::S;
+uint (PyCohSpLoop::*PyCohSpLoop_addLead_1)(const cxmat&, const cxmat&, const cxmat&, 
+        const ucol&, double) = &PyCohSpLoop::addLead;
+uint (PyCohSpLoop::*PyCohSpLoop_addLead_2)(const cxmat&, const cxmat&, const cxmat&, 
+        const ucol&, double, const cxmat&, const cxmat&, const cxmat&) = &PyCohSpLoop::addLead;
+
+void export_CohSpLoop(){
+    class_<CohSpLoop, bases<Printable>, shared_ptr<CohSpLoop>, noncopyable >("_CohSpLoop", 
+            no_init)
+    ;
+    
+    class_<PyCohSpLoop, bases<CohSpLoop>, shared_ptr<PyCohSpLoop> >("CohSpLoop", 
+            init<const Workers&, optional<double, dcmplx, bool, string> >())
+        .def("E", &PyCohSpLoop::E)
+        .def("mu", &PyCohSpLoop::mu)
+        .def("H", PyCohSpLoop_H_1)
+        .def("H", PyCohSpLoop_H_2)
+        .def("S", PyCohSpLoop_S_1)
+        .def("S", PyCohSpLoop_S_2)
+        .def("V", &PyCohSpLoop::V)
+        .def("addLead", PyCohSpLoop_addLead_1)
+        .def("addLead", PyCohSpLoop_addLead_2)
+        .def("run", &PyCohSpLoop::run)
+        .def("save", &PyCohSpLoop::save, PyCohSpLoop_save())
+        .def("enableTE", &PyCohSpLoop::enableTE, PyCohSpLoop_enableTE())
+        .def("enableI", &PyCohSpLoop::enableI, PyCohSpLoop_enableI())
+        .def("enableDOS", &PyCohSpLoop::enableDOS)
+        .def("enablen", &PyCohSpLoop::enablen)
+        .def("enablep", &PyCohSpLoop::enablep)
+    ;
+}
+
+}
+}
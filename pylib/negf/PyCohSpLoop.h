@@ -0,0 +1,46 @@
+/* 
+ * File:   PyCohSpLoop.h
+ * Author: K M Masum Habib <masum.habib@virginia.edu>
+ *
+ * Created on October 19, 2026, 2:05 PM
+ */
+
+#ifndef PYCOHSPLOOP_H
+#define	PYCOHSPLOOP_H
+
+#include "boostpython.hpp"
+#include "negf/CohSpLoop.h"
+#include "npyarma/npyarma.h"
+
+namespace quest{
+namespace python{
+
+using namespace negf;
+namespace bp = boost::python;
+
+/*
+ * Dense matrices from python are converted to sparse ones here. 
+ * scipy.sparse matrices are taken as they are.
+ */
+class PyCohSpLoop: public CohSpLoop{
+public:
+    PyCohSpLoop(const Workers &workers, double kT = 0.0259, 
+        dcmplx ieta = dcmplx(0,1E-3), bool orthogonal = true, 
+        string newprefix = ""); 
+    
+    void            H(const cxmat& H);
+    void            S(const cxmat& S);
+    void            H(const sp_cx_mat& H);
+    void            S(const sp_cx_mat& S);
+    void            V(const col& V);
+    uint            addLead(const cxmat& H0, const cxmat& H01, const cxmat& Hc,
+                        const ucol& orbs, double VL);
+    uint            addLead(const cxmat& H0, const cxmat& H01, const cxmat& Hc,
+                        const ucol& orbs, double VL, const cxmat& S0, 
+                        const cxmat& S01, const cxmat& Sc);
+};
+
+}}
+
+#endif	/* PYCOHSPLOOP_H */
+
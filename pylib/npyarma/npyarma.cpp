@@ -131,6 +131,26 @@ void test_npy2mat(bp::object obj){
     }
 }
 
+template <typename T>
+ar::SpMat<T> test_spmat_roundtrip(const ar::SpMat<T> &value){
+    return value;
+}
+
+/**
+ * Dense copy of a sparse matrix made through the element access, which 
+ * searches the sorted row indices of each column.
+ */
+template <typename T>
+ar::Mat<T> test_spmat_to_mat(const ar::SpMat<T> &value){
+    ar::Mat<T> m(value.n_rows, value.n_cols);
+    for (ar::uword j = 0; j < value.n_cols; ++j){
+        for (ar::uword i = 0; i < value.n_rows; ++i){
+            m(i, j) = value(i, j);
+        }
+    }
+    return m;
+}
+
 /**Properly initialize the numpy array. For details see:
  * https://docs.scipy.org/doc/numpy/user/c-info.how-to-extend.html
  */
@@ -274,6 +294,15 @@ void export_npyarma(){
    register_mat_to_npy<std::complex<float> >();
    register_mat_to_npy<std::complex<double> >();
    //register_mat_to_npy<std::complex<long double> >();
+
+  /**
+   * scipy.sparse matrices to arma::SpMat<T> and arma::SpMat<T> to
+   * scipy.sparse.csc_matrix.
+   */
+   spmat_from_npy<double>();
+   spmat_from_npy<std::complex<double> >();
+   register_spmat_to_npy<double>();
+   register_spmat_to_npy<std::complex<double> >();
    
    def("test_mat_to_npy", test_mat_to_npy<double>, " Tests arma::mat to numpy.array conversion.");
 //   def("test_mat_to_npy", test_mat_to_npy<complex<double> >, " Tests arma::mat to numpy.array conversion.");
@@ -281,6 +310,8 @@ void export_npyarma(){
 //   def("test_npy_to_mat", test_npy_to_mat<complex<double> >, " Tests numpy.array to arma::mat conversion.");
    def("test_npy2mat", test_npy2mat<double>, " Tests numpy.array to arma::mat conversion.");
 //   def("test_npy2mat", test_npy2mat<complex<double> >, " Tests numpy.array to arma::mat conversion.");
+   def("test_spmat_roundtrip", test_spmat_roundtrip<double>, " Tests scipy.sparse to arma::sp_mat and back.");
+   def("test_spmat_to_mat", test_spmat_to_mat<double>, " Tests scipy.sparse to arma::sp_mat conversion.");
 
    //   def("construct", construct, " Converts numpy.array to mat");
 
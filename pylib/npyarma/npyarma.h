@@ -479,6 +479,134 @@ void register_mat_to_npy() {
 }
 
 
+/**
+ * Objects of this type create a binding between arma::SpMat<T> and
+ * scipy.sparse matrices. Any scipy.sparse matrix can be passed to a bound
+ * method that receives a const arma::SpMat<T>&. The matrix is converted
+ * to canonical CSC format, sorted and without duplicates, and copied.
+ */
+template <typename T> struct spmat_from_npy {
+   
+    typedef typename ar::SpMat<T> spmat_type;
+
+    /**
+     * Registers converter from scipy.sparse matrix into a arma::SpMat<T>
+     */
+    spmat_from_npy() {
+      bp::converter::registry::push_back(&convertible, &construct, 
+          bp::type_id<spmat_type>());
+    }
+
+    /**
+     * Anything that is not a numpy array and can be converted to CSC format.
+     */
+    static void* convertible(PyObject* obj_ptr) {
+        if(!PyArray_Check(obj_ptr) && PyObject_HasAttrString(obj_ptr, "tocsc")){
+            return obj_ptr;
+        }
+        return 0;
+    }
+
+    /**
+     * Copies a numpy array into a arma::Col<U> converting its elements to 
+     * numpy type type.
+     */
+    template <typename U, typename N>
+    static ar::Col<U> copy_col(bp::object obj, int type) {
+        PyArrayObject *arr = reinterpret_cast<PyArrayObject*>(
+                PyArray_FROM_OTF(obj.ptr(), type, NPY_IN_ARRAY));
+        if (arr == 0){
+            bp::throw_error_already_set();
+        }
+        npy_intp n = PyArray_SIZE(arr);
+        ar::Col<U> out(n);
+        for (npy_intp i = 0; i < n; ++i){
+            out(i) = static_cast<N*>(PyArray_DATA(arr))[i];
+        }
+        Py_DECREF(arr);
+        return out;
+    }
+    
+static void construct(PyObject* obj_ptr,
+        bp::converter::rvalue_from_python_stage1_data* data) {
+
+    if (obj_ptr == 0){
+        throw runtime_error("Cannot convert scipy.sparse to arma::SpMat<T>. NULL object received.");
+    }
+      
+    void* storage = ((bp::converter::rvalue_from_python_storage<spmat_type>*)data)->storage.bytes;
+    
+    bp::object csc = bp::object(bp::handle<>(bp::borrowed(obj_ptr))).attr("tocsc")();
+    // tocsc() neither sorts the row indices nor sums the duplicates, but 
+    // the batch constructor of SpMat needs both. It may also return the 
+    // object itself, so a copy is put in canonical format.
+    if (!bp::extract<bool>(csc.attr("has_canonical_format"))()){
+        csc = csc.attr("copy")();
+        csc.attr("sum_duplicates")();
+        csc.attr("sort_indices")();
+    }
+    bp::object shape = csc.attr("shape");
+    ar::uword nrows = bp::extract<ar::uword>(shape[0]);
+    ar::uword ncols = bp::extract<ar::uword>(shape[1]);
+    
+    ar::Col<ar::uword> rowind = copy_col<ar::uword, npy_int64>(csc.attr("indices"), NPY_INT64);
+    ar::Col<ar::uword> colptr = copy_col<ar::uword, npy_int64>(csc.attr("indptr"), NPY_INT64);
+    ar::Col<T> values = copy_col<T, T>(csc.attr("data"), ctype_to_npytype<T>());
+
+    new (storage) spmat_type(rowind, colptr, values, nrows, ncols); //place operator
+    data->convertible = storage;
+}
+
+};
+
+/**
+ * Objects of this type bind arma::SpMat<T> to scipy.sparse.csc_matrix. Your 
+ * method generates as output an object of this type and the object will be
+ * automatically converted into a CSC matrix.
+ */
+template <typename T> struct spmat_to_npy {
+    
+  typedef typename ar::SpMat<T> spmat_type;
+  
+  static PyObject* convert(const spmat_type& tv) {
+    npy_intp nnz = tv.n_nonzero;
+    npy_intp ncols = tv.n_cols + 1;
+
+    PyArrayObject* data = make_pyarray(1, &nnz, ctype_to_npytype<T>());
+    PyArrayObject* indices = make_pyarray(1, &nnz, NPY_INT64);
+    PyArrayObject* indptr = make_pyarray(1, &ncols, NPY_INT64);
+    
+    // the iterator visits the elements column by column.
+    T *pdata = static_cast<T*>(PyArray_DATA(data));
+    npy_int64 *pindices = static_cast<npy_int64*>(PyArray_DATA(indices));
+    npy_int64 *pindptr = static_cast<npy_int64*>(PyArray_DATA(indptr));
+    std::fill(pindptr, pindptr + ncols, 0);
+    npy_intp k = 0;
+    for (typename spmat_type::const_iterator it = tv.begin(); it != tv.end(); ++it, ++k){
+        pdata[k] = *it;
+        pindices[k] = it.row();
+        pindptr[it.col() + 1] += 1;
+    }
+    for (npy_intp j = 1; j < ncols; ++j){
+        pindptr[j] += pindptr[j-1];
+    }
+
+    bp::object csc = bp::import("scipy.sparse").attr("csc_matrix")(
+        bp::make_tuple(bp::object(bp::handle<>((PyObject*)data)), 
+                       bp::object(bp::handle<>((PyObject*)indices)), 
+                       bp::object(bp::handle<>((PyObject*)indptr))), 
+        bp::make_tuple(tv.n_rows, tv.n_cols));
+
+    return bp::incref(csc.ptr());
+  }
+
+};
+
+template <typename T>
+void register_spmat_to_npy() {
+  bp::to_python_converter<typename ar::SpMat<T>, spmat_to_npy<T> >();
+}
+
 }}
 
 #endif /* NPYARMA_H */
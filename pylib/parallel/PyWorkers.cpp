@@ -26,6 +26,7 @@ void export_Workers(){
         .def("N", &Workers::N)
         .def("AmIMaster", &Workers::AmIMaster)
         .def("IAmMaster", &Workers::IAmMaster)
+        .def("barrier", &Workers::barrier)
     ;     
 }
 
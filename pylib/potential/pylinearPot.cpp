@@ -19,6 +19,8 @@ using namespace potential;
  * Linear potential
  */  
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(LinearPot_VLR, VLR, 3, 5)
+uint (LinearPot::*LinearPot_getNThreads)() const = &LinearPot::nthreads;
+void (LinearPot::*LinearPot_setNThreads)(uint) = &LinearPot::nthreads;
 void export_LinearPot(){
     class_<LinearPot, bases<Potential>, shared_ptr<LinearPot> >("LinearPot", 
             init<optional<AtomicStruct::ptr, const string&> >())
@@ -26,6 +28,8 @@ void export_LinearPot(){
         .def("addLinearRegion", &LinearPot::addLinearRegion)
         .add_property("NLR", &LinearPot::NLR) 
         .def("VLR", &LinearPot::VLR, LinearPot_VLR()) 
+        .add_property("nthreads", LinearPot_getNThreads, LinearPot_setNThreads, 
+                " Threads used by compute(), 0: all.")
     ;
 }
 
@@ -15,11 +15,29 @@
 namespace quest{
 namespace python{
 using namespace potential;
+namespace bp = boost::python;
 
 /**
  * Linear potential
  */  
 vec (Potential::*Potential_toOrbPot)(uint, uint) = &Potential::toOrbPot;
+/**
+ * Orbital potentials of consecutive blocks of nab[ib] atoms each.
+ */
+bp::list Potential_toOrbPots(const Potential &V, const bp::list &nab){
+    ucol n(bp::len(nab));
+    for (long ib = 0; ib < bp::len(nab); ++ib){
+        n(ib) = bp::extract<uint>(nab[ib]);
+    }
+    field<shared_ptr<vec> > Vo;
+    V.toOrbPot(Vo, n);
+
+    bp::list out;
+    for (uint ib = 0; ib < Vo.n_elem; ++ib){
+        out.append(*Vo(ib));
+    }
+    return out;
+}
 double (Potential::*Potential_Vatom1)(uint) = &Potential::Vatom;
 void (Potential::*Potential_Vatom2)(uint, double) = &Potential::Vatom;
 void export_Potential(){    
@@ -35,6 +53,7 @@ void export_Potential(){
         .def("VS", &Potential::VS)
         .def("VG", &Potential::VG)
         .def("toOrbPot", Potential_toOrbPot) 
+        .def("toOrbPot", Potential_toOrbPots, " Orbital potentials of consecutive blocks of nab[ib] atoms each.") 
         .def("Vatom", Potential_Vatom1) 
         .def("Vatom", Potential_Vatom2) 
         .add_property("NG", &Potential::NG)
@@ -35,6 +35,7 @@ void export_utils(){
     export_Option();
     
     export_Timer();
+    export_Profiler();
     export_cxmat();
     export_mat();
     export_vec();  
@@ -61,6 +62,7 @@ void export_atoms()
     export_Atom();
     export_PeriodicTable();
     export_AtomicStruct();     
+    export_Supercell();
 }
 
 void export_kpoints()
@@ -94,6 +96,7 @@ void export_hamiltonian()
     export_TISurfKpParams();
     export_TISurfKpParams4();
     export_TI3DKpParams();
+    export_KpStencil();
 
 }
 
@@ -113,6 +116,7 @@ void export_negf()
     scope negf_scope = negfModule;
 
     export_CohRgfLoop();    
+    export_CohSpLoop();
 }
 
 void export_tmfsc()
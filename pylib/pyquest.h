@@ -31,6 +31,7 @@ void export_lcoord();
 void export_Atom();
 void export_PeriodicTable();
 void export_AtomicStruct();
+void export_Supercell();
 
 void export_Workers();
 
@@ -38,6 +39,7 @@ void export_point();
 void export_quadrilateral();
 
 void export_Timer();
+void export_Profiler();
 
 void export_cxhamparams();
 void export_GrapheneTbParams();
@@ -45,11 +47,13 @@ void export_GrapheneKpParams();
 void export_TISurfKpParams();
 void export_TISurfKpParams4();
 void export_TI3DKpParams();
+void export_KpStencil();
 
 void export_Potential();
 void export_LinearPot();
 
 void export_CohRgfLoop();
+void export_CohSpLoop();
 
 void export_KPoints();
 
@@ -11,6 +11,7 @@ class TransportResult (object):
         self.DOS_op = {}
         self.n_op = {}
         self.neq_op = {}
+        self.LDOS_map = {}
 
         self.operators = {
                 'TE_op': self.TE_op,
@@ -18,6 +19,7 @@ class TransportResult (object):
                 'DOS_op': self.DOS_op,
                 'n_op': self.n_op,
                 'neq_op': self.neq_op,
+                'LDOS_map': self.LDOS_map,
         }
 
     def get_num_energy (self):
@@ -111,12 +113,14 @@ class TransportResult (object):
                     cls._scan_matrix (out, fid, 'n_op')
                 elif line == 'neq':
                     cls._scan_matrix (out, fid, 'neq_op')
+                elif line == 'LDOS_MAP':
+                    cls._scan_matrix (out, fid, 'LDOS_map', 2)
     
         return out
 
 
     @classmethod
-    def _scan_matrix (cls, out, fid, type):
+    def _scan_matrix (cls, out, fid, type, num_cols = None):
         line = fid.readline ()
         NE = int (line)
     
@@ -128,18 +132,20 @@ class TransportResult (object):
         line = fid.readline ().strip()
     
         matrix_size = int (line)
+        if num_cols is None:
+            num_cols = matrix_size
         for iE in range (NE):
-            matrix = np.zeros ((matrix_size, matrix_size), dtype=complex)
+            matrix = np.zeros ((matrix_size, num_cols), dtype=complex)
             row = 0
             while (row < matrix_size):
                 line = fid.readline ().strip ()
                 if len (line) == 0:
                     continue
                 col_data = line.split ()
-                if len (col_data) != matrix_size:
-                    raise RuntimeError ("WW> Parse error at the line containing: '" + line + "': matrix does not have " + str (matrix_size) + " of columns")
+                if len (col_data) != num_cols:
+                    raise RuntimeError ("WW> Parse error at the line containing: '" + line + "': matrix does not have " + str (num_cols) + " of columns")
     
-                for col in range (matrix_size):
+                for col in range (num_cols):
                     data = col_data [col].strip ("()").split(",")
     
                     if len (data) != 2:
@@ -0,0 +1,41 @@
+/* 
+ * File:   PyProfiler.cpp
+ * Copyright (C) 2014  K M Masum Habib <masum.habib@gmail.com>
+ * 
+ * Created on October 19, 2026, 6:30 PM
+ */
+
+#include "boostpython.hpp"
+#include "utils/Profiler.h"
+
+
+namespace quest{
+namespace python{
+
+using utils::Profiler;
+
+/**
+ * Profiler python exporter.
+ */
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Profiler_enable, enable, 0, 1)
+void export_Profiler(){
+    
+    class_<Profiler, bases<Printable>, shared_ptr<Profiler> >("Profiler", 
+            init<optional<const string&> >())
+        .def("enable", &Profiler::enable, Profiler_enable())
+        .def("reset", &Profiler::reset)
+        .add_property("enabled", &Profiler::enabled)
+        .add_property("nphases", &Profiler::nphases)
+        .def("name", &Profiler::name)
+        .def("time", &Profiler::time)
+        .def("calls", &Profiler::calls)
+        .def("counts", &Profiler::counts)
+        .def("minTime", &Profiler::minTime)
+        .def("avgTime", &Profiler::avgTime)
+        .def("maxTime", &Profiler::maxTime)
+    ;
+
+}
+
+}
+}
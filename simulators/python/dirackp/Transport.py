@@ -13,8 +13,8 @@ import random as rn
 from quest import setVerbosity, greet, vprint
 from quest.vprint import nprint, dprint, eprint
 from quest.linspace import linspace
-from quest.atoms import AtomicStruct, SVec, LCoord
-from quest.hamiltonian import TISurfKpParams4, TISurfKpParams, TI3DKpParams, GrapheneKpParams, GrapheneOneValleyKpParams, GrapheneTwoValleyKpParams, GrapheneTbParams, generateHamOvl
+from quest.atoms import AtomicStruct, SVec, LCoord, concat
+from quest.hamiltonian import TISurfKpParams4, TISurfKpParams, TI3DKpParams, GrapheneKpParams, GrapheneOneValleyKpParams, GrapheneTwoValleyKpParams, GrapheneTbParams, generateHamOvl, partitionBlocks, BondHam, generateBonds, HamCache
 from quest.negf import CohRgfLoop
 from quest.kpoints import KPoints
 from quest.potential import LinearPot
@@ -86,7 +86,7 @@ class Transport(object):
         self.nb         = 11           # Length of the device+contacts
         self.nw         = 9            # Width of the device
         self.nh         = 1
-        self.nbw        = []           # Width of all layers
+        self.nbw        = []           # Number of atoms in each block
 
         # for k-loop
         self.nk2         = 0            # number of k points along a2        
@@ -118,6 +118,16 @@ class Transport(object):
         self.ieta           = 1E-3j         # Contact imaginary potential
         self.mu             = 0.0           # Device Fermi level
         self.OrthoBasis     = True          # Orthogonal basis?
+        self.Decimation     = False         # Collapse uniform segments?
+        self.Sectors        = False         # Solve decoupled sectors separately?
+        self.Banded         = False         # Banded inverse of the blocks?
+        self.Profile        = False         # Print time spent in each phase?
+        self.Checkpoint     = False         # Save finished points periodically?
+        self.CheckpointInterval = 300       # Seconds between checkpoints
+        self.Restart        = False         # Skip points found in checkpoints?
+        self.BiasSweep      = False         # Run all bias points in one sweep?
+        self.HamThreads     = 1             # Hamiltonian generator threads per rank, 0: all
+        self.HamCacheDir    = ""            # Hamiltonian cache directory, "": no cache
         self.Emin           =-1.0           # Minimum energy 
         self.Emax           = 1.0           # Maximum energy
         self.dE             = 0.005         # Energy step
@@ -192,6 +202,9 @@ class Transport(object):
         """ Creates atomistic geometry. """
 
         nprint("\n Creating atomistic geometry ...")
+        
+        # the bond lists belong to the old geometry
+        self.clearBonds()
 
         if not hasattr(self, "hp"): # if hp does not exist, create it.
             if self.HamType == self.HAM_TI_SURF_KP:
@@ -236,34 +249,69 @@ class Transport(object):
         self.lyr_0m1 = cont_left
         self.lyr_nb = cont_right
 
-        self.nbw = [self.nw]*self.nb
-        self.nbw[0] = self.nlc
-        self.nbw[self.nb-1] = self.nrc
+        self.nbw = [self.nw*self.nh]*self.nb
+        self.nbw[0] = cont_left.NumOfAtoms
+        self.nbw[self.nb-1] = cont_right.NumOfAtoms
         self.updateBoundingBox()
 
         nprint(" done.")
 
+    def partitionBlocks(self):
+        """ 
+        Repartitions the device into the thinnest block-tridiagonal blocks
+        found from the Hamiltonian connectivity. Call it after the geometry 
+        is created and before the potential and Hamiltonian are set up. 
+        The contacts are kept as they are.
+        """
+
+        nprint("\n Partitioning device into blocks ...")
+
+        # the bond lists belong to the old blocks
+        self.clearBonds()
+
+        nlc = self.lyr_0.NumOfAtoms
+        nrc = self.lyr_nbm1.NumOfAtoms
+        dev = self.geom.span(nlc, self.geom.NumOfAtoms - nrc - 1)
+        dev, nbw = partitionBlocks(self.hp, dev, self.lyr_0, self.lyr_nbm1)
+
+        self.geom = self.lyr_0 + dev + self.lyr_nbm1
+        self.nbw = [nlc] + list(nbw) + [nrc]
+        self.nb = len(self.nbw)
+        self.DevType = self.COH_RGF_NON_UNI
+        self.updateBoundingBox()
+
+        nprint(" done. Number of blocks: " + str(self.nb) + ".")
+
     def createRoughEdges(self, sigma):
         """ 
         Creates rough edges. Works only for sorted lattice points.
-        For rectangular lattice 
+        For rectangular lattice. The atoms of each layer are the ones in
+        the slab of width a around the layer's x, so the contacts may have 
+        a different width from the device.
         """
 
         nprint("\n Creating rough edges ...")
 
+        # the bond lists belong to the old geometry
+        self.clearBonds()
+
         if (self.HamType == self.HAM_TI_SURF_KP 
                     or self.HamType == self.HAM_TI_SURF_KP4
                     or self.HamType == self.HAM_GRAPHENE_KP
                     or self.HamType == self.HAM_GRAPHENE_TWO_VALLEY_KP):
             nw = []
-            geom = AtomicStruct()
-            beg = 0
+            layers = []
+            a = self.hp.a
+            x0 = self.geom.xmin
+            ylo, yhi = self.geom.ymin - a, self.geom.ymax + a
+            zlo, zhi = self.geom.zmin - a, self.geom.zmax + a
             # loop through the layers and 
             # remove some atoms randomly from the edges.
             for ib in range(0, self.nb):
-                end = beg + self.nw - 1
-                lyr = self.geom.span(beg, end)
-                beg = end + 1
+                xc = x0 + ib*a
+                lyr = self.geom.select(self.geom.inBox(
+                        np.array([xc - a/2, ylo, zlo]), 
+                        np.array([xc + a/2, yhi, zhi])))
                 
                 if ( ib > 1 and ib < self.nb - 2):
                     # Remove or add some atoms from the bottom edge.
@@ -291,11 +339,11 @@ class Transport(object):
                         lyr = lyr + xtra
                         
                 # save this layer
-                geom = geom + lyr
+                layers.append(lyr)
                 nw.append(lyr.NumOfAtoms)
                 
             # save geometry
-            self.geom = geom
+            self.geom = concat(layers)
             self.nbw = nw
             self.DevType = self.COH_RGF_NON_UNI
             
@@ -311,6 +359,44 @@ class Transport(object):
         """ Generates hamiltonian and overlap matrices. """
 
         nprint("\n Generating Hamiltonian matrix ...")
+        
+        bi, bj = self.blockPairs()
+        
+        # Same geometry and parameters: the blocks are loaded from the cache.
+        key = self.bondsKey(bi, bj)
+        cache = None
+        blocks = None
+        if hasattr(self, "HamCacheDir") and self.HamCacheDir:
+            cache = HamCache(self.HamCacheDir)
+            blocks = cache.load(key)
+        
+        if blocks is None:
+            # bond lists are generated once on HamThreads threads and reused
+            # for a new Bz. They are rebuilt if the geometry or any other
+            # parameter changed since.
+            if not self.hasBonds() or self.bondsKeyOf != key:
+                # every rank generates the Hamiltonian, so more than one 
+                # thread per rank oversubscribes a node running many ranks.
+                nthreads = self.HamThreads if hasattr(self, "HamThreads") else 1
+                self.bonds = generateBonds(self.hp, bi, bj, nthreads)
+                self.bondsKeyOf = key
+            blocks = ([bonds.H() for bonds in self.bonds], 
+                      [bonds.S() for bonds in self.bonds])
+            # only blocks built for this key may be stored under it.
+            if (cache is not None and self.bondsKeyOf == key 
+                    and self.workers.IAmMaster()):
+                cache.save(key, blocks[0], blocks[1])
+        
+        self.blocks = blocks
+        self.ibond = 0
+        self.generateBlocks()
+        self.blocks = None
+
+        nprint(" done.")
+        
+    def generateBlocks(self):
+        """ Sets up the block Hamiltonian and overlap matrices of the 
+        device from the bond lists. """
 
         # For uniform RGF blocks
         if (self.DevType == self.COH_RGF_UNI): 
@@ -320,9 +406,9 @@ class Transport(object):
                 lyr0 = self.geom.span(0, self.nw*self.nh-1)               # extract block # 0
                 lyr1 = self.geom.span(self.nw*self.nh, 2*self.nw*self.nh-1)    # extract block # 1
                 
-                self.H0, self.S0 = generateHamOvl(self.hp, lyr0, lyr0)
+                self.H0, self.S0 = self.hamOvl(lyr0, lyr0)
 
-                self.Hl, S = generateHamOvl(self.hp, lyr1, lyr0)
+                self.Hl, S = self.hamOvl(lyr1, lyr0)
 
 #                np.set_printoptions(linewidth=200)
 #                print "\nS0\n"
@@ -351,27 +437,27 @@ class Transport(object):
                 lyr0 = self.geom.span(0, self.nw*self.nh-1)               # extract block # 0
                 lyr1 = self.geom.span(self.nw*self.nh, 2*self.nw*self.nh-1)    # extract block # 1
                 
-                H, S = generateHamOvl(self.hp, lyr0, lyr0)
+                H, S = self.hamOvl(lyr0, lyr0)
                 self.H0.append(H); self.S0.append(S)
-                H, S = generateHamOvl(self.hp, lyr1, lyr0)
+                H, S = self.hamOvl(lyr1, lyr0)
                 self.Hl.append(H)
                 
                 self.pv.append(lv*LCoord(0,1,0))
                 lyr0top = lyr0 + self.pv[1]                # top neighbor of layer 0
-                H, S = generateHamOvl(self.hp, lyr0, lyr0top)
+                H, S = self.hamOvl(lyr0, lyr0top)
                 self.H0.append(H)
                 
                 self.pv.append(lv*LCoord(0, -1, 0))
                 lyr0bot = lyr0 + self.pv[2]                # bottom neighbor of layer 0
-                H, S = generateHamOvl(self.hp, lyr0, lyr0bot)
+                H, S = self.hamOvl(lyr0, lyr0bot)
                 self.H0.append(H)
                
                 self.pvl.append(lv*LCoord(-1,1,0))
-                H, S = generateHamOvl(self.hp, lyr1, lyr0top)
+                H, S = self.hamOvl(lyr1, lyr0top)
                 self.Hl.append(H)
                 
                 self.pvl.append(lv*LCoord(-1,-1,0))
-                H, S = generateHamOvl(self.hp, lyr1, lyr0bot)        
+                H, S = self.hamOvl(lyr1, lyr0bot)        
                 self.Hl.append(H)
         # Non-uniform RGF blocks        
         elif (self.DevType == self.COH_RGF_NON_UNI):
@@ -384,25 +470,75 @@ class Transport(object):
                 
                 # generate H_i,i and S_i,i
                 lyri = self.geom.span(beg, end)            # extract block # i
-                H0,S0 = generateHamOvl(self.hp, lyri, lyri)
+                H0,S0 = self.hamOvl(lyri, lyri)
                 self.H0.append(H0)
                 self.S0.append(S0)
 
                 # generate H_i,i-1
                 if ib > 0:
-                    Hl,Sl = generateHamOvl(self.hp, lyri, lyrim1)
+                    Hl,Sl = self.hamOvl(lyri, lyrim1)
                     self.Hl.append(Hl)
                 
                 lyrim1 = lyri
                 beg = end + 1
             # Coupling matrix between two blocks of left contact
-            Hl,Sl = generateHamOvl(self.hp, self.lyr_0, self.lyr_0m1)
+            Hl,Sl = self.hamOvl(self.lyr_0, self.lyr_0m1)
             self.Hl.insert(0, Hl)
             # Coupling matrix between two blocks of right contact
-            Hl,Sl = generateHamOvl(self.hp, self.lyr_nb, self.lyr_nbm1)
+            Hl,Sl = self.hamOvl(self.lyr_nb, self.lyr_nbm1)
             self.Hl.append(Hl)
-
-        nprint(" done.")
+        
+    def blockPairs(self):
+        """ Pairs of blocks (bi, bj) of the device Hamiltonian, in the order
+        hamOvl() is called for them. """
+        self.pairs = []
+        self.generateBlocks()
+        bi = [pair[0] for pair in self.pairs]
+        bj = [pair[1] for pair in self.pairs]
+        self.pairs = None
+        return bi, bj
+
+    def bondsKey(self, bi, bj):
+        """ Key of the geometry and Hamiltonian parameters the bond lists 
+        of the pairs (bi, bj) are built for. """
+        return HamCache().key(self.hp, bi, bj)
+
+    def hasBonds(self):
+        return hasattr(self, "bonds") and len(self.bonds) > 0
+
+    def clearBonds(self):
+        """ Forgets the bond lists, e.g., when the geometry changes. """
+        self.bonds = []
+        self.bondsKeyOf = None
+
+    def hamOvl(self, bi, bj):
+        """ Hamiltonian and overlap matrices between blocks bi and bj, in 
+        the order the pairs of blocks were collected. While the pairs are 
+        being collected, it returns None. """
+        if hasattr(self, "pairs") and self.pairs is not None:
+            self.pairs.append((bi, bj))
+            return None, None
+        H = self.blocks[0][self.ibond]
+        S = self.blocks[1][self.ibond]
+        self.ibond += 1
+        return H, S
+    
+    def setBz(self, Bz, gauge = 0):
+        """ Sets the magnetic field and regenerates the Hamiltonian blocks 
+        from the stored bond lists without any neighbor search. Gauge 0: 
+        A = (-Bz*y, 0, 0), 1: A = (0, Bz*x, 0). """
+        # The bond lists are kept only if they belong to the current 
+        # geometry and parameters.
+        bi, bj = self.blockPairs()
+        valid = self.hasBonds() and self.bondsKeyOf == self.bondsKey(bi, bj)
+        self.hp.setBz(Bz, gauge)
+        if valid:
+            for bonds in self.bonds:
+                bonds.setBz(Bz, gauge)
+            self.bondsKeyOf = self.bondsKey(bi, bj)
+        else:
+            self.clearBonds()
+        self.generateHamiltonian()
         
     def setupPotential(self):
         """ Sets up the potential profile """
@@ -422,24 +558,14 @@ class Transport(object):
             
         return ret
 
-    def runBiasStep(self, VGG, Vo, VDD):            
-        """Runs the sumulation."""
-
-        # Set drain and Fermi levels
-        self.rgf.mu(self.muD(VDD), self.muS(VDD))
-            
-        nprint("\n Bias loop:")                                
-        nprint("\n  VGG = " + str(VGG) + ", Vo = " + str(Vo) 
-                    + ", VDD = " + str(VDD) + ".")
+    def biasFileName(self, VGG, Vo, VDD):
+        """Output file name of a bias point without extension."""
+        return self.OutFileName + "_VGG{0:2.3f}_Vo{1:2.3f}_VDD{2:2.3f}".format(VGG, Vo, VDD)
+    
+    def setBias(self, VGG, Vo, VDD):
+        """Computes the electrostatic potential of a bias point and 
+        exports it to NEGF."""
         
-        fileName = self.OutFileName + "_VGG{0:2.3f}_Vo{1:2.3f}_VDD{2:2.3f}".format(VGG, Vo, VDD)
-
-        # skip calculation if result file exists.
-        if self.SkipExistingSimulation == True:
-            if os.path.isfile(self.OutPath + fileName + ".dat"):
-                nprint("\n  Result exists, skipping.")
-                return
-            
         # Set gate voltages
         for ig in range(self.V.NG):
             VG = self.VG(VGG, Vo, ig)
@@ -477,20 +603,18 @@ class Transport(object):
                     os.makedirs(self.OutPath) 
                 self.V.exportPotential(self.OutPath + self.DebugPotFile)
         
-        # Export potential to NEGF
-        beg = 0
-        self.Vo = []
+        # Export potential to NEGF. The orbital potentials are kept in 
+        # Vorb, Vo is the built in potential.
+        nab = list(self.nbw)
+        self.Vorb = self.V.toOrbPot(nab)
         for ib in range(self.nb):                  # setup the block hamiltonian
-            end = beg + self.nbw[ib]*self.nh - 1
-            self.Vo.append(self.V.toOrbPot(beg, end)) 
-            self.rgf.V(self.Vo[ib], ib)
-            beg = end + 1
-            
-            
-        # Create energy grid
+            self.rgf.V(self.Vorb[ib], ib)
+    
+    def energyGrid(self, VDDs):
+        """Energy grid covering the Fermi windows of all the drain biases."""
         if (self.AutoGenE):
-            Emin = self.muD(VDD) - 10*self.kT
-            Emax = self.muS(VDD) + 10*self.kT
+            Emin = min([self.muD(VDD) for VDD in VDDs]) - 10*self.kT
+            Emax = max([self.muS(VDD) for VDD in VDDs]) + 10*self.kT
         else:
             Emin = self.Emin
             Emax = self.Emax
@@ -504,9 +628,40 @@ class Transport(object):
         nprint("\n Total " + str(len(EE)) + " energy point(s) " 
                     + "running on " + str(self.workers.N()) + " CPU(s): " 
                     + str(int(round(len(EE)/self.workers.N()))) + " pts/CPU ... \n")
-                                
+        return EE
+    
+    def runBiasStep(self, VGG, Vo, VDD):            
+        """Runs the sumulation."""
+
+        # Set drain and Fermi levels
+        self.rgf.mu(self.muD(VDD), self.muS(VDD))
+            
+        nprint("\n Bias loop:")                                
+        nprint("\n  VGG = " + str(VGG) + ", Vo = " + str(Vo) 
+                    + ", VDD = " + str(VDD) + ".")
+        
+        fileName = self.biasFileName(VGG, Vo, VDD)
+
+        # skip calculation if result file exists.
+        if self.SkipExistingSimulation == True:
+            if os.path.isfile(self.OutPath + fileName + ".dat"):
+                nprint("\n  Result exists, skipping.")
+                return
+            
+        self.setBias(VGG, Vo, VDD)
+            
         # Set energy
-        self.rgf.E(EE)
+        self.rgf.E(self.energyGrid([VDD]))
+
+        # Checkpoint of this bias step
+        if hasattr(self, "Checkpoint") and self.Checkpoint:
+            if (self.workers.IAmMaster()):
+                if not os.path.exists(self.OutPath):
+                    os.makedirs(self.OutPath)
+            # all the ranks save into the directory created by the master.
+            self.workers.barrier()
+            self.rgf.checkpoint(self.OutPath + fileName + ".chk", 
+                                self.CheckpointInterval)
 
         # Run the simulation
         if (self.DryRun == False):
@@ -528,6 +683,55 @@ class Transport(object):
         nprint(" done.\n")
         nprint(" ------------------------------------------------------------------")
     
+    def runBiasSweep(self):
+        """Runs all the bias points in one sweep. At each energy, only the 
+        blocks whose potential changes from one bias point to the next are
+        recomputed and the contact surface Green functions are reused."""
+        
+        biases = []
+        for VDD in self.VDD:
+            for VGG in self.VGG:
+                fileName = self.biasFileName(VGG, self.Vo, VDD)
+                # skip calculation if result file exists.
+                if self.SkipExistingSimulation == True:
+                    if os.path.isfile(self.OutPath + fileName + ".dat"):
+                        nprint("\n VGG = " + str(VGG) + ", VDD = " + str(VDD) 
+                                    + ": result exists, skipping.")
+                        continue
+                biases.append((VGG, VDD, fileName))
+        if not biases:
+            return
+        
+        self.rgf.clearBias()
+        for VGG, VDD, fileName in biases:
+            nprint("\n Bias point:")                                
+            nprint("\n  VGG = " + str(VGG) + ", Vo = " + str(self.Vo) 
+                        + ", VDD = " + str(VDD) + ".")
+            self.setBias(VGG, self.Vo, VDD)
+            self.rgf.addBias(self.muD(VDD), self.muS(VDD))
+        
+        # one energy grid for all the bias points
+        self.rgf.E(self.energyGrid([VDD for VGG, VDD, fileName in biases]))
+
+        # Run the simulation
+        if (self.DryRun == False):
+            self.rgf.run()
+        nprint("\n  done.")
+        
+        nprint("\n Saving results to disk ...")
+        if (self.workers.IAmMaster()):
+            # Create directory if not exist.
+            if not os.path.exists(self.OutPath):
+                os.makedirs(self.OutPath)            
+            # save results to file.
+            if (self.DryRun == False):
+                for ib in range(len(biases)):
+                    fileName = biases[ib][2]
+                    self.rgf.saveBias(ib, self.OutPath + fileName + ".dat")            
+
+        nprint(" done.\n")
+        nprint(" ------------------------------------------------------------------")
+        
     def run(self):
         """Runs the sumulation."""
 
@@ -626,12 +830,14 @@ class Transport(object):
                 else:
                     for I in self.Calculations["I"]:
                         if ("Block" in I and I["Block"] == "All"):
-                            for ib in range(0, self.nb-1):
-                                self.rgf.enableI(I["N"], ib, ib+1)
+                            # all the bond currents in one sweep
+                            self.rgf.enableIMap(I["N"])
                         else:
                             self.rgf.enableI(I["N"], I["From"], I["To"])
             if (type == "DOS"):
                 self.rgf.enableDOS(value)
+            if (type == "LDOS"):
+                self.rgf.enableLDOSMap()
             if (type == "n"):
                 if (isinstance( value, int)):
                     self.rgf.enablen(value)
@@ -644,12 +850,25 @@ class Transport(object):
                             self.rgf.enablen(n["N"], n["Block"])
         if hasattr(self, "atomsTracedOver"):
             self.rgf.atomsTracedOver(self.atomsTracedOver);
+        if hasattr(self, "Decimation") and self.Decimation:
+            self.rgf.decimate(True)
+        if hasattr(self, "Sectors") and self.Sectors:
+            self.rgf.sectors(True)
+        if hasattr(self, "Banded") and self.Banded:
+            self.rgf.banded(True)
+        if hasattr(self, "Profile") and self.Profile:
+            self.rgf.profile(True)
+        if hasattr(self, "Restart") and self.Restart:
+            self.rgf.restart(True)
     
         # Loop over drain and gate bias
-        for VDD in self.VDD:
-            for VGG in self.VGG:
-                self.runBiasStep(VGG, self.Vo, VDD)
-                pass
+        if hasattr(self, "BiasSweep") and self.BiasSweep:
+            self.runBiasSweep()
+        else:
+            for VDD in self.VDD:
+                for VGG in self.VGG:
+                    self.runBiasStep(VGG, self.Vo, VDD)
+                    pass
         self.clock.toc()           
         nprint("\n" + str(self.clock) + "\n")
  
@@ -718,6 +937,8 @@ class Transport(object):
                             msg += "  Current from block # " + str(I["From"])
                             msg += " to block # " + str(I["To"]) 
                             msg += " (" + str(I["N"]) + ").\n"
+            if (type == "LDOS"):
+                msg += "  LDOS and electron density of all orbitals.\n"
             if (type == "n"):
                 if (isinstance( value, int)):
                     msg += "  Electron density of the device"
@@ -760,6 +981,10 @@ class Transport(object):
         del dct['workers']
         del dct['clock']
         del dct['kp']
+        if 'bonds' in dct:
+            del dct['bonds']
+        if 'bondsKeyOf' in dct:
+            del dct['bondsKeyOf']
         #del dct['H0']
         #del dct['Hl']
         #del dct['S0']
@@ -0,0 +1,41 @@
+#!/usr/bin/python
+
+"""
+scipy.sparse to arma::sp_mat conversion of matrices that are not in
+canonical CSC format: unsorted row indices and duplicate entries.
+"""
+
+import quest as qm
+import numpy as np
+import scipy.sparse as sp
+
+# 4 x 3 CSC with unsorted row indices in columns 0 and 2 and duplicates in
+# columns 1 and 2.
+data    = np.array([1., 2., 3., 4., 5., 6., 7.])
+indices = np.array([2, 0, 1, 1, 3, 0, 3])
+indptr  = np.array([0, 2, 4, 7])
+A = sp.csc_matrix((data, indices, indptr), shape=(4, 3))
+Aind = A.indices.copy()
+dense = A.toarray()
+
+B = qm.test_spmat_to_mat(A)
+assert np.array_equal(B, dense), "element access:\n" + str(B)
+
+C = qm.test_spmat_roundtrip(A)
+assert C.has_canonical_format
+assert np.array_equal(C.toarray(), dense), "round trip:\n" + str(C.toarray())
+
+# the matrix passed in is not changed.
+assert np.array_equal(A.indices, Aind)
+
+# the same matrix in CSR and COO formats, with duplicates.
+Acsr = sp.csr_matrix((data, indices, indptr), shape=(3, 4)).T
+assert np.array_equal(qm.test_spmat_to_mat(Acsr), dense)
+Acoo = sp.coo_matrix((data, (indices, [0, 0, 1, 1, 2, 2, 2])), shape=(4, 3))
+assert np.array_equal(qm.test_spmat_to_mat(Acoo), dense)
+
+# canonical input is passed through as it is.
+D = sp.random(20, 15, density=0.2, format='csc', random_state=1)
+assert np.array_equal(qm.test_spmat_roundtrip(D).toarray(), D.toarray())
+
+print("test_npyarma_spmat: passed.")
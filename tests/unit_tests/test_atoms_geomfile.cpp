@@ -0,0 +1,104 @@
+/**
+ * Test cases for the binary geometry file.
+ *
+ */
+
+#include "atoms/GeomFile.h"
+
+#ifndef LINK_STATIC
+#define BOOST_TEST_DYN_LINK
+#endif
+#define BOOST_TEST_MODULE GeomFileTest
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+using namespace quest::atoms;
+using namespace std;
+
+/*
+ * A GNR with a second species, so that the species table and the padding
+ * of the atomic numbers (odd number of atoms) are both exercised.
+ */
+AtomicStruct create_struct(){
+    ptable pt;
+    AtomicStruct gnr;
+    gnr.genGNR(pt[6], 1.42, 3, 2);
+
+    icol ids;
+    ids << 1;
+    mat xyz;
+    xyz << -1.1 << 0.25 << 0.5 << endr;
+    AtomicStruct h(ids, xyz, lvec(), pt);
+    gnr += h;
+
+    BOOST_REQUIRE(gnr.NumOfAtoms() % 2 == 1);
+    return gnr;
+}
+
+BOOST_AUTO_TEST_CASE(export_map_to_struct)
+{
+    string fileName = "test_atoms_geomfile.geom";
+    AtomicStruct s = create_struct();
+    s.exportGeom(fileName);
+
+    GeomFile file(fileName);
+    BOOST_REQUIRE_EQUAL(file.NumOfAtoms(), s.NumOfAtoms());
+
+    AtomicStruct t = file.toStruct();
+    BOOST_REQUIRE_EQUAL(t.NumOfAtoms(), s.NumOfAtoms());
+    BOOST_CHECK_EQUAL(t.NumOfOrbitals(), s.NumOfOrbitals());
+    BOOST_CHECK_EQUAL(t.NumOfElectrons(), s.NumOfElectrons());
+    for (int ia = 0; ia < s.NumOfAtoms(); ++ia){
+        BOOST_CHECK_EQUAL(t.AtomicNumber(ia), s.AtomicNumber(ia));
+        BOOST_CHECK_EQUAL(t.Symbol(ia), s.Symbol(ia));
+        // the coordinates are stored as they are, bit for bit.
+        BOOST_CHECK_EQUAL(t.X(ia), s.X(ia));
+        BOOST_CHECK_EQUAL(t.Y(ia), s.Y(ia));
+        BOOST_CHECK_EQUAL(t.Z(ia), s.Z(ia));
+    }
+    lvec lv = s.LatticeVector(), lt = t.LatticeVector();
+    for (uint ic = 0; ic < 3; ++ic){
+        BOOST_CHECK_EQUAL(lt.a1(ic), lv.a1(ic));
+        BOOST_CHECK_EQUAL(lt.a2(ic), lv.a2(ic));
+        BOOST_CHECK_EQUAL(lt.a3(ic), lv.a3(ic));
+    }
+
+    AtomicStruct u;
+    u.importGeom(fileName);
+    BOOST_CHECK_EQUAL(u.NumOfAtoms(), s.NumOfAtoms());
+
+    std::remove(fileName.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(corrupt_header_is_rejected)
+{
+    string fileName = "test_atoms_geomfile_corrupt.geom";
+    AtomicStruct s = create_struct();
+    s.exportGeom(fileName);
+
+    // na + 2^62 gives the same file size modulo 2^64 as na does.
+    uint64_t na = s.NumOfAtoms() + (uint64_t(1) << 62);
+    {
+        fstream f(fileName.c_str(), ios::in | ios::out | ios::binary);
+        f.seekp(8);
+        f.write(reinterpret_cast<const char*>(&na), sizeof(na));
+    }
+    BOOST_CHECK_THROW(GeomFile file(fileName), ios_base::failure);
+
+    // number of species
+    s.exportGeom(fileName);
+    uint64_t nspecies = uint64_t(1) << 60;
+    {
+        fstream f(fileName.c_str(), ios::in | ios::out | ios::binary);
+        f.seekp(16);
+        f.write(reinterpret_cast<const char*>(&nspecies), sizeof(nspecies));
+    }
+    BOOST_CHECK_THROW(GeomFile file(fileName), ios_base::failure);
+
+    std::remove(fileName.c_str());
+}
+
@@ -0,0 +1,179 @@
+/**
+ * Test cases for the spatial queries of AtomicStruct. The R-tree has to find
+ * exactly the atoms a scan over all of them finds.
+ *
+ */
+
+#include "atoms/AtomicStruct.h"
+#include "atoms/AtomIndex.h"
+
+#ifndef LINK_STATIC
+#define BOOST_TEST_DYN_LINK
+#endif
+#define BOOST_TEST_MODULE AtomIndexTest
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+using namespace quest::atoms;
+using namespace std;
+
+namespace bg = boost::geometry;
+
+/*
+ * na carbon atoms at random positions in [0, 10] x [0, 8] x [0, 2].
+ */
+AtomicStruct create_random_struct(uint na){
+    arma::arma_rng::set_seed(42);
+    mat xyz = arma::randu<mat>(na, 3);
+    xyz.col(coord::X) *= 10;
+    xyz.col(coord::Y) *= 8;
+    xyz.col(coord::Z) *= 2;
+    icol ids(na);
+    ids.fill(6);
+    return AtomicStruct(ids, xyz, lvec(), ptable());
+}
+
+void check_same(const ucol &got, const vector<uint> &expected){
+    BOOST_REQUIRE_EQUAL(got.n_elem, expected.size());
+    for (uint i = 0; i < expected.size(); ++i){
+        BOOST_CHECK_EQUAL(got(i), expected[i]);
+    }
+}
+
+vector<uint> scan_box(const AtomicStruct &s, const svec &lo, const svec &hi){
+    vector<uint> found;
+    for (int ia = 0; ia < s.NumOfAtoms(); ++ia){
+        if (s.X(ia) >= lo(coord::X) && s.X(ia) <= hi(coord::X) &&
+            s.Y(ia) >= lo(coord::Y) && s.Y(ia) <= hi(coord::Y) &&
+            s.Z(ia) >= lo(coord::Z) && s.Z(ia) <= hi(coord::Z)){
+            found.push_back(ia);
+        }
+    }
+    return found;
+}
+
+vector<uint> scan_polygon(const AtomicStruct &s, const mat &xy){
+    quest::maths::geometry::polygon p;
+    for (uint iv = 0; iv < xy.n_rows; ++iv){
+        p.outer().push_back(quest::maths::geometry::point(xy(iv, 0), xy(iv, 1)));
+    }
+    vector<uint> found;
+    for (int ia = 0; ia < s.NumOfAtoms(); ++ia){
+        if (bg::within(quest::maths::geometry::point(s.X(ia), s.Y(ia)), p,
+                quest::maths::geometry::stwithin())){
+            found.push_back(ia);
+        }
+    }
+    return found;
+}
+
+double dist2(const AtomicStruct &s, uint ia, const svec &c){
+    double dx = s.X(ia) - c(coord::X);
+    double dy = s.Y(ia) - c(coord::Y);
+    double dz = s.Z(ia) - c(coord::Z);
+    return dx*dx + dy*dy + dz*dz;
+}
+
+vector<uint> scan_sphere(const AtomicStruct &s, const svec &c, double r){
+    vector<uint> found;
+    for (int ia = 0; ia < s.NumOfAtoms(); ++ia){
+        if (dist2(s, ia, c) <= r*r){
+            found.push_back(ia);
+        }
+    }
+    return found;
+}
+
+vector<uint> scan_nearest(const AtomicStruct &s, const svec &c, uint k){
+    vector<uint> all(s.NumOfAtoms());
+    for (uint ia = 0; ia < all.size(); ++ia){
+        all[ia] = ia;
+    }
+    std::sort(all.begin(), all.end(), [&s, &c](uint i, uint j){
+        return dist2(s, i, c) < dist2(s, j, c);
+    });
+    vector<uint> found(all.begin(), all.begin() + std::min<size_t>(k, all.size()));
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+svec point3(double x, double y, double z){
+    svec r(3);
+    r(coord::X) = x;
+    r(coord::Y) = y;
+    r(coord::Z) = z;
+    return r;
+}
+
+BOOST_AUTO_TEST_CASE(box_matches_scan)
+{
+    AtomicStruct s = create_random_struct(2000);
+    svec lo = point3(2.5, 1.0, 0.5), hi = point3(6.0, 5.5, 1.5);
+    check_same(s.inBox(lo, hi), scan_box(s, lo, hi));
+    // the whole structure and an empty box.
+    check_same(s.inBox(point3(-1, -1, -1), point3(11, 9, 3)),
+            scan_box(s, point3(-1, -1, -1), point3(11, 9, 3)));
+    BOOST_CHECK_EQUAL(s.inBox(point3(20, 20, 20), point3(21, 21, 21)).n_elem, 0);
+}
+
+BOOST_AUTO_TEST_CASE(polygon_matches_scan)
+{
+    AtomicStruct s = create_random_struct(2000);
+    // a concave L shaped region, counter clockwise.
+    mat xy;
+    xy << 1.0 << 1.0 << endr
+       << 8.0 << 1.0 << endr
+       << 8.0 << 3.0 << endr
+       << 3.0 << 3.0 << endr
+       << 3.0 << 7.0 << endr
+       << 1.0 << 7.0 << endr;
+    check_same(s.inPolygon(xy), scan_polygon(s, xy));
+
+    mat tri;
+    tri << 0.0 << 0.0 << endr
+        << 10.0 << 2.0 << endr
+        << 4.0 << 8.0 << endr;
+    check_same(s.inPolygon(tri), scan_polygon(s, tri));
+}
+
+BOOST_AUTO_TEST_CASE(sphere_matches_scan)
+{
+    AtomicStruct s = create_random_struct(2000);
+    svec c = point3(5.0, 4.0, 1.0);
+    double radii[] = {0.3, 1.7, 4.0, 20.0};
+    for (double r: radii){
+        check_same(s.inSphere(c, r), scan_sphere(s, c, r));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(nearest_matches_scan)
+{
+    AtomicStruct s = create_random_struct(2000);
+    svec c = point3(3.3, 6.1, 0.2);
+    uint ks[] = {1, 7, 50};
+    for (uint k: ks){
+        check_same(s.nearest(c, k), scan_nearest(s, c, k));
+    }
+    // outside the structure.
+    c = point3(-4.0, 12.0, 5.0);
+    check_same(s.nearest(c, 10), scan_nearest(s, c, 10));
+}
+
+BOOST_AUTO_TEST_CASE(index_follows_the_atoms)
+{
+    AtomicStruct s = create_random_struct(500);
+    svec lo = point3(2.0, 2.0, 0.0), hi = point3(5.0, 5.0, 2.0);
+    check_same(s.inBox(lo, hi), scan_box(s, lo, hi));
+
+    // a shift drops the index, the next query sees the new positions.
+    s += point3(1.5, -0.5, 0.0);
+    check_same(s.inBox(lo, hi), scan_box(s, lo, hi));
+
+    // a concatenation too.
+    AtomicStruct t = create_random_struct(100);
+    s += t;
+    check_same(s.inBox(lo, hi), scan_box(s, lo, hi));
+}
+
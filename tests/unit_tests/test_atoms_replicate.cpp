@@ -0,0 +1,162 @@
+/**
+ * Test cases for AtomicStruct::replicate(), Supercell and concat(). They 
+ * have to give the atoms in the same order as the old concatenation of 
+ * shifted copies one at a time.
+ *
+ */
+
+#include "atoms/AtomicStruct.h"
+#include "atoms/Supercell.h"
+
+#ifndef LINK_STATIC
+#define BOOST_TEST_DYN_LINK
+#endif
+#define BOOST_TEST_MODULE ReplicateTest
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+
+using namespace quest::atoms;
+using namespace std;
+
+void check_same_atoms(const AtomicStruct &got, const AtomicStruct &expected){
+    BOOST_REQUIRE_EQUAL(got.NumOfAtoms(), expected.NumOfAtoms());
+    BOOST_CHECK_EQUAL(got.NumOfOrbitals(), expected.NumOfOrbitals());
+    BOOST_CHECK_EQUAL(got.NumOfElectrons(), expected.NumOfElectrons());
+    for (int ia = 0; ia < expected.NumOfAtoms(); ++ia){
+        BOOST_CHECK_EQUAL(got.AtomicNumber(ia), expected.AtomicNumber(ia));
+        BOOST_CHECK_SMALL(got.X(ia) - expected.X(ia), 1E-12);
+        BOOST_CHECK_SMALL(got.Y(ia) - expected.Y(ia), 1E-12);
+        BOOST_CHECK_SMALL(got.Z(ia) - expected.Z(ia), 1E-12);
+    }
+}
+
+/*
+ * The loop genGNR() used before replicate(): one shifted copy of the
+ * primitive cell at a time, along a1 first and then a2.
+ */
+AtomicStruct replicate_one_by_one(const AtomicStruct &cell, uint nl, uint nw){
+    AtomicStruct whole;
+    for (long ix = 0; ix < nl; ++ix){
+        for (long iy = 0; iy < nw; ++iy){
+            AtomicStruct tmp = cell;
+            tmp += ix * cell.LatticeVector().a1;
+            tmp += iy * cell.LatticeVector().a2;
+            whole += tmp;
+        }
+    }
+    return whole;
+}
+
+BOOST_AUTO_TEST_CASE(gnr_order_matches_old_loop)
+{
+    ptable pt;
+    Atom C = pt[6];
+    double acc = 1.42;
+    uint nl = 5, nw = 3;
+
+    // a single primitive cell of 4 atoms with the primitive lattice vectors.
+    AtomicStruct cell;
+    cell.genGNR(C, acc, 1u, 1u);
+    BOOST_REQUIRE_EQUAL(cell.NumOfAtoms(), 4);
+
+    AtomicStruct gnr;
+    gnr.genGNR(C, acc, nl, nw);
+    check_same_atoms(gnr, replicate_one_by_one(cell, nl, nw));
+}
+
+/*
+ * Cell of three atoms of different species with oblique lattice vectors.
+ */
+AtomicStruct create_mixed_cell(){
+    ptable pt;
+    icol ids;
+    ids << 6 << 1 << 7;
+    mat xyz;
+    xyz << 0.0 << 0.0 << 0.0 << endr
+        << 0.5 << 0.1 << 0.0 << endr
+        << 0.2 << 0.7 << 0.3 << endr;
+    lvec lv;
+    lv.a1(coord::X) = 1.0;
+    lv.a2(coord::X) = 0.3;
+    lv.a2(coord::Y) = 1.5;
+    lv.a3(coord::Z) = 2.0;
+    return AtomicStruct(ids, xyz, lv, pt);
+}
+
+BOOST_AUTO_TEST_CASE(replicate_mixed_species)
+{
+    AtomicStruct cell = create_mixed_cell();
+    lvec lv = cell.LatticeVector();
+
+    uint n1 = 4, n2 = 2;
+    AtomicStruct rep = cell.replicate(n1, n2);
+    check_same_atoms(rep, replicate_one_by_one(cell, n1, n2));
+    BOOST_CHECK_SMALL(norm(rep.LatticeVector().a1 - n1*lv.a1), 1E-12);
+    BOOST_CHECK_SMALL(norm(rep.LatticeVector().a2 - n2*lv.a2), 1E-12);
+
+    // the third direction comes after a1 and a2.
+    AtomicStruct rep3 = cell.replicate(1, 1, 3);
+    BOOST_REQUIRE_EQUAL(rep3.NumOfAtoms(), 9);
+    for (int ia = 0; ia < 9; ++ia){
+        BOOST_CHECK_SMALL(rep3.Z(ia) - (cell.Z(ia%3) + (ia/3)*2.0), 1E-12);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(concat_matches_repeated_add)
+{
+    ptable pt;
+    AtomicStruct cell;
+    cell.genGNR(pt[6], 1.42, 1u, 1u);
+
+    vector<AtomicStruct> parts;
+    AtomicStruct added;
+    for (uint ip = 0; ip < 4; ++ip){
+        AtomicStruct part = cell.replicate(ip+1);
+        part += ip * cell.LatticeVector().a2;
+        parts.push_back(part);
+        added += part;
+    }
+    // an empty part changes nothing.
+    parts.push_back(AtomicStruct());
+    added += AtomicStruct();
+
+    AtomicStruct joined = concat(parts);
+    check_same_atoms(joined, added);
+    BOOST_CHECK_SMALL(norm(joined.LatticeVector().a1 - added.LatticeVector().a1), 1E-12);
+    BOOST_CHECK_SMALL(norm(joined.LatticeVector().a2 - added.LatticeVector().a2), 1E-12);
+}
+
+BOOST_AUTO_TEST_CASE(supercell_matches_replicate)
+{
+    AtomicStruct cell = create_mixed_cell();
+    lvec lv = cell.LatticeVector();
+
+    uint n1 = 50, n2 = 20, n3 = 3;
+    Supercell sc(cell, n1, n2, n3);
+    BOOST_REQUIRE_EQUAL(sc.NumOfAtoms(), (long)cell.NumOfAtoms()*n1*n2*n3);
+    BOOST_CHECK_EQUAL(sc.NumOfOrbitals(), (long)cell.NumOfOrbitals()*n1*n2*n3);
+
+    // the lazy accessors give the atoms of the whole structure.
+    AtomicStruct whole = sc.toStruct();
+    check_same_atoms(whole, replicate_one_by_one(cell.replicate(1, 1, n3), n1, n2));
+    for (long ia = 0; ia < sc.NumOfAtoms(); ++ia){
+        BOOST_CHECK_EQUAL(sc.X(ia), whole.X(ia));
+        BOOST_CHECK_EQUAL(sc.Y(ia), whole.Y(ia));
+        BOOST_CHECK_EQUAL(sc.Z(ia), whole.Z(ia));
+        BOOST_CHECK_EQUAL(sc.AtomicNumber(ia), whole.AtomicNumber(ia));
+        BOOST_CHECK_EQUAL(sc.NumOfOrbitalsAt(ia), whole.NumOfOrbitalsAt(ia));
+    }
+    BOOST_CHECK_SMALL(norm(sc.LatticeVector().a3 - n3*lv.a3), 1E-12);
+
+    // several chunks of atoms on 4 threads give the same structure.
+    BOOST_REQUIRE(sc.NumOfAtoms() > 2*4096);
+    AtomicStruct threaded = sc.toStruct(4);
+    BOOST_REQUIRE_EQUAL(threaded.NumOfAtoms(), whole.NumOfAtoms());
+    for (int ia = 0; ia < whole.NumOfAtoms(); ++ia){
+        BOOST_CHECK_EQUAL(threaded.X(ia), whole.X(ia));
+        BOOST_CHECK_EQUAL(threaded.Y(ia), whole.Y(ia));
+        BOOST_CHECK_EQUAL(threaded.Z(ia), whole.Z(ia));
+        BOOST_CHECK_EQUAL(threaded.AtomicNumber(ia), whole.AtomicNumber(ia));
+    }
+}
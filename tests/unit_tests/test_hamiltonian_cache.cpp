@@ -0,0 +1,149 @@
+/**
+ * Test cases for the on-disk Hamiltonian cache.
+ *
+ */
+
+#include "hamiltonian/hamcache.h"
+#include "hamiltonian/pargen.h"
+#include "hamiltonian/tb/graphenetb.h"
+
+#ifndef LINK_STATIC
+#define BOOST_TEST_DYN_LINK
+#endif
+#define BOOST_TEST_MODULE HamCacheTest
+#include <boost/test/unit_test.hpp>
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+using namespace quest::hamiltonian;
+using namespace quest::atoms;
+using namespace std;
+
+const string CacheDir = "test_hamiltonian_cache.d";
+const string Key = "0123456789abcdef0123456789abcdef";
+
+void create_blocks(vector<cxmat> &H, vector<cxmat> &S){
+    arma::arma_rng::set_seed(7);
+    H.clear();
+    S.clear();
+    H.push_back(arma::randu<cxmat>(4, 4));
+    S.push_back(arma::randu<cxmat>(4, 4));
+    H.push_back(arma::randu<cxmat>(4, 6));
+    S.push_back(arma::randu<cxmat>(4, 6));
+}
+
+// overwrites the 8 bytes at pos of the cache file of Key.
+void patch(const HamCache &cache, size_t pos, uint64_t value){
+    fstream f(cache.fileName(Key).c_str(), ios::in | ios::out | ios::binary);
+    f.seekp(pos);
+    f.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void remove_cache(const HamCache &cache){
+    std::remove(cache.fileName(Key).c_str());
+    rmdir(CacheDir.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(save_and_load)
+{
+    HamCache cache(CacheDir);
+    vector<cxmat> H, S, H2, S2;
+    create_blocks(H, S);
+    cache.save(Key, H, S);
+
+    BOOST_REQUIRE(cache.load(Key, H2, S2));
+    BOOST_REQUIRE_EQUAL(H2.size(), H.size());
+    for (uint ib = 0; ib < H.size(); ++ib){
+        BOOST_CHECK(arma::all(arma::vectorise(H2[ib] == H[ib])));
+        BOOST_CHECK(arma::all(arma::vectorise(S2[ib] == S[ib])));
+    }
+
+    // keys that are not in the cache or not keys at all.
+    BOOST_CHECK(!cache.load("ffffffffffffffffffffffffffffffff", H2, S2));
+    BOOST_CHECK(!cache.load("0123", H2, S2));
+    remove_cache(cache);
+}
+
+BOOST_AUTO_TEST_CASE(corrupt_sizes_are_rejected)
+{
+    HamCache cache(CacheDir);
+    vector<cxmat> H, S, H2, S2;
+    create_blocks(H, S);
+    size_t npairsPos = 8, dimsPos = 8 + 8 + 32;
+
+    // npairs + 2^59 pairs of sizes take the same number of bytes modulo
+    // 2^64 as npairs does.
+    cache.save(Key, H, S);
+    patch(cache, npairsPos, H.size() + (uint64_t(1) << 59));
+    BOOST_CHECK(!cache.load(Key, H2, S2));
+
+    // rows*cols of the first H wraps around to the right number of elements.
+    cache.save(Key, H, S);
+    patch(cache, dimsPos, (uint64_t(1) << 62) + 1);
+    patch(cache, dimsPos + 8, 16);
+    BOOST_CHECK(!cache.load(Key, H2, S2));
+
+    // one pair less than in the file.
+    cache.save(Key, H, S);
+    patch(cache, npairsPos, H.size() - 1);
+    BOOST_CHECK(!cache.load(Key, H2, S2));
+
+    remove_cache(cache);
+}
+
+BOOST_AUTO_TEST_CASE(key_follows_geometry_and_parameters)
+{
+    HamCache cache(CacheDir);
+    GrapheneTbParams p;
+    ptable pt = p.periodicTable();
+    AtomicStruct gnr;
+    gnr.genGNR(pt[CarbonID], p.acc(), 4u, 2u);
+    vector<AtomicStruct> bi(1, gnr), bj(1, gnr);
+
+    string key = cache.key(p, bi, bj);
+    BOOST_CHECK_EQUAL(key.size(), Key.size());
+    BOOST_CHECK_EQUAL(cache.key(p, bi, bj), key);
+
+    // the field and its gauge.
+    p.Bz(10);
+    string keyBz = cache.key(p, bi, bj);
+    BOOST_CHECK(keyBz != key);
+    p.Bz(10, coord::Y);
+    BOOST_CHECK(cache.key(p, bi, bj) != keyBz);
+    p.Bz(0);
+    BOOST_CHECK_EQUAL(cache.key(p, bi, bj), key);
+
+    // a parameter of the model.
+    double ti0 = p.ti0();
+    p.ti0(3.0);
+    BOOST_CHECK(cache.key(p, bi, bj) != key);
+    p.ti0(ti0);
+    BOOST_CHECK_EQUAL(cache.key(p, bi, bj), key);
+
+    // the geometry: a shifted block and one atom less.
+    vector<AtomicStruct> shifted = bj;
+    shifted[0] += gnr.LatticeVector().a1;
+    BOOST_CHECK(cache.key(p, bi, shifted) != key);
+    vector<AtomicStruct> fewer = bj;
+    fewer[0] = gnr(span(0, gnr.NumOfAtoms() - 2));
+    BOOST_CHECK(cache.key(p, bi, fewer) != key);
+
+    // generated blocks come back only under their own key.
+    vector<cxmat> H, S, H2, S2;
+    generateHamOvl(H, S, p, bi, bj, 1);
+    cache.save(key, H, S);
+    BOOST_REQUIRE(cache.load(key, H2, S2));
+    BOOST_REQUIRE_EQUAL(H2.size(), 1);
+    BOOST_CHECK(arma::all(arma::vectorise(H2[0] == H[0])));
+    BOOST_CHECK(arma::all(arma::vectorise(S2[0] == S[0])));
+    BOOST_CHECK(!cache.load(keyBz, H2, S2));
+
+    std::remove(cache.fileName(key).c_str());
+    rmdir(CacheDir.c_str());
+}
+
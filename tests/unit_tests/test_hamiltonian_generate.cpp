@@ -0,0 +1,317 @@
+/**
+ * Test cases for the generation of the Hamiltonian and overlap matrices:
+ * the cell list neighbor search, the pair kernels, the threaded and the
+ * sparse generators, the bond lists and the k.p stencil. All of them have
+ * to give the same matrices as the O(N^2) generation over all the pairs of
+ * atoms, on a graphene ribbon and on a grid of the Dirac k.p model.
+ *
+ */
+
+#include "hamiltonian/pargen.h"
+#include "hamiltonian/tb/graphenetb.h"
+#include "hamiltonian/kp/graphenekp.h"
+
+#ifndef LINK_STATIC
+#define BOOST_TEST_DYN_LINK
+#endif
+#define BOOST_TEST_MODULE GenerateTest
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+
+using namespace quest::hamiltonian;
+using namespace quest::atoms;
+using namespace std;
+
+const uint NThreads = 4;
+
+// Graphene ribbon of nl x nw primitive cells.
+AtomicStruct create_gnr(const GrapheneTbParams &p, uint nl, uint nw){
+    ptable pt = p.periodicTable();
+    AtomicStruct gnr;
+    gnr.genGNR(pt[CarbonID], p.acc(), nl, nw);
+    return gnr;
+}
+
+// nx x ny grid of the Dirac k.p model, x major.
+AtomicStruct create_grid(const DiracKpParams &p, uint nx, uint ny){
+    ptable pt = p.periodicTable();
+    AtomicStruct grid;
+    grid.genSimpleCubicStruct(pt[DiscreteID], p.a(), nx, ny);
+    return grid;
+}
+
+/*
+ * The generation generateHamOvl() used to do: every pair of atoms, one
+ * two-atom structure at a time.
+ */
+void generate_all_pairs(cxmat &H, cxmat &S, const cxhamparams &p,
+        const AtomicStruct &bi, const AtomicStruct &bj)
+{
+    H = zeros<cxmat>(bi.NumOfOrbitals(), bj.NumOfOrbitals());
+    S = zeros<cxmat>(bi.NumOfOrbitals(), bj.NumOfOrbitals());
+    vector<AtomicStruct> atomsj;
+    for (int ja = 0; ja < bj.NumOfAtoms(); ++ja){
+        atomsj.push_back(bj(uint(ja)));
+    }
+
+    uint io = 0;
+    for (int ia = 0; ia < bi.NumOfAtoms(); ++ia){
+        AtomicStruct atomi = bi(uint(ia));
+        uint ni = bi.NumOfOrbitalsAt(ia);
+        uint jo = 0;
+        for (int ja = 0; ja < bj.NumOfAtoms(); ++ja){
+            uint nj = bj.NumOfOrbitalsAt(ja);
+            H.submat(io, jo, io + ni - 1, jo + nj - 1) = p.twoAtomHam(atomi, atomsj[ja]);
+            S.submat(io, jo, io + ni - 1, jo + nj - 1) = p.twoAtomOvl(atomi, atomsj[ja]);
+            jo += nj;
+        }
+        io += ni;
+    }
+}
+
+bool same(const cxmat &A, const cxmat &B){
+    return A.n_rows == B.n_rows && A.n_cols == B.n_cols
+        && arma::all(arma::vectorise(A == B));
+}
+
+void check_close(const cxmat &got, const cxmat &expected){
+    BOOST_REQUIRE_EQUAL(got.n_rows, expected.n_rows);
+    BOOST_REQUIRE_EQUAL(got.n_cols, expected.n_cols);
+    BOOST_CHECK_SMALL(arma::norm(got - expected, "fro"),
+            1E-12*(1 + arma::norm(expected, "fro")));
+}
+
+/*
+ * H and S of s with itself and of its first half with its second half.
+ */
+void check_generated(const cxhamparams &p, const AtomicStruct &s){
+    uint na = s.NumOfAtoms();
+    AtomicStruct first = s(span(0, na/2 - 1)), second = s(span(na/2, na - 1));
+
+    cxmat H, S, Hall, Sall;
+    generateHamOvl(H, S, p, AtomicStructView(s), AtomicStructView(s));
+    generate_all_pairs(Hall, Sall, p, s, s);
+    BOOST_CHECK(accu(abs(Hall)) > 0);
+    BOOST_CHECK(same(H, Hall));
+    BOOST_CHECK(same(S, Sall));
+
+    generateHamOvl(H, S, p, AtomicStructView(first), AtomicStructView(second));
+    generate_all_pairs(Hall, Sall, p, first, second);
+    BOOST_CHECK(accu(abs(Hall)) > 0);
+    BOOST_CHECK(same(H, Hall));
+    BOOST_CHECK(same(S, Sall));
+}
+
+BOOST_AUTO_TEST_CASE(neighbor_pairs_match_all_pairs)
+{
+    GrapheneTbParams tb;
+    GrapheneOneValleyKpParams kp;
+    AtomicStruct gnr = create_gnr(tb, 6, 3);
+    AtomicStruct grid = create_grid(kp, 7, 5);
+    AtomicStruct structs[] = {gnr, grid};
+    double cutoffs[] = {tb.cutoff(), kp.cutoff()};
+
+    for (uint is = 0; is < 2; ++is){
+        const AtomicStruct &s = structs[is];
+        AtomicStructView v(s);
+        uint na = s.NumOfAtoms();
+        double cutoff = cutoffs[is];
+
+        vector<vector<uint> > neigh = neighborPairs(v, v, cutoff);
+        vector<vector<uint> > all = neighborPairs(v, v, 0);
+        BOOST_REQUIRE_EQUAL(neigh.size(), na);
+        BOOST_REQUIRE_EQUAL(all.size(), na);
+        for (uint ia = 0; ia < na; ++ia){
+            BOOST_REQUIRE_EQUAL(all[ia].size(), na);
+            vector<uint> expected;
+            for (uint ja = 0; ja < na; ++ja){
+                double dx = s.X(ja) - s.X(ia);
+                double dy = s.Y(ja) - s.Y(ia);
+                double dz = s.Z(ja) - s.Z(ia);
+                if (dx*dx + dy*dy + dz*dz <= cutoff*cutoff){
+                    expected.push_back(ja);
+                }
+            }
+            BOOST_CHECK(neigh[ia] == expected);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(graphene_matches_all_pairs)
+{
+    GrapheneTbParams p;
+    AtomicStruct gnr = create_gnr(p, 6, 3);
+    check_generated(p, gnr);
+
+    // the pair kernel of atoms beyond the cutoff.
+    cxmat h(1, 1, fill::zeros);
+    double ri[3] = {0, 0, 0}, rj[3] = {2*p.cutoff(), 0, 0};
+    BOOST_CHECK(!p.pairHam(ri, CarbonID, rj, CarbonID, h.memptr(), 1));
+    BOOST_CHECK(h(0, 0) == dcmplx(0, 0));
+}
+
+BOOST_AUTO_TEST_CASE(dirac_matches_all_pairs)
+{
+    GrapheneOneValleyKpParams p;
+    AtomicStruct grid = create_grid(p, 7, 5);
+    check_generated(p, grid);
+
+    p.Bz(20);
+    check_generated(p, grid);
+    p.Bz(20, coord::Y);
+    check_generated(p, grid);
+}
+
+BOOST_AUTO_TEST_CASE(sparse_matches_dense)
+{
+    GrapheneTbParams tb;
+    GrapheneOneValleyKpParams kp;
+    kp.Bz(20);
+    AtomicStruct gnr = create_gnr(tb, 6, 3);
+    AtomicStruct grid = create_grid(kp, 7, 5);
+
+    cxmat H, S;
+    sp_cx_mat Hsp, Ssp;
+    generateHamOvl(H, S, tb, AtomicStructView(gnr), AtomicStructView(gnr));
+    generateSpHamOvl(Hsp, Ssp, tb, AtomicStructView(gnr), AtomicStructView(gnr));
+    BOOST_CHECK(same(cxmat(Hsp), H));
+    BOOST_CHECK(same(cxmat(Ssp), S));
+
+    generateHamOvl(H, S, kp, AtomicStructView(grid), AtomicStructView(grid));
+    generateSpHamOvl(Hsp, Ssp, kp, AtomicStructView(grid), AtomicStructView(grid));
+    BOOST_CHECK(same(cxmat(Hsp), H));
+    BOOST_CHECK(same(cxmat(Ssp), S));
+}
+
+BOOST_AUTO_TEST_CASE(threads_are_bit_identical)
+{
+    GrapheneTbParams p;
+    // more atoms than a thread generates at a time.
+    AtomicStruct gnr = create_gnr(p, 12, 4);
+    AtomicStructView v(gnr);
+
+    cxmat H, S, H1, S1, HN, SN;
+    generateHamOvl(H, S, p, v, v);
+    generateHamOvl(H1, S1, p, v, v, 1);
+    generateHamOvl(HN, SN, p, v, v, NThreads);
+    BOOST_CHECK(same(H1, H));
+    BOOST_CHECK(same(S1, S));
+    BOOST_CHECK(same(HN, H1));
+    BOOST_CHECK(same(SN, S1));
+
+    // many pairs of blocks: the cells along the ribbon and their neighbors.
+    GrapheneOneValleyKpParams kp;
+    kp.Bz(20, coord::Y);
+    uint nx = 8, ny = 5;
+    AtomicStruct grid = create_grid(kp, nx, ny);
+    vector<AtomicStruct> bi, bj;
+    for (uint ix = 1; ix < nx; ++ix){
+        bi.push_back(grid(span(ix*ny, (ix + 1)*ny - 1)));
+        bj.push_back(grid(span((ix - 1)*ny, ix*ny - 1)));
+    }
+    vector<cxmat> Hs1, Ss1, HsN, SsN;
+    generateHamOvl(Hs1, Ss1, kp, bi, bj, 1);
+    generateHamOvl(HsN, SsN, kp, bi, bj, NThreads);
+    BOOST_REQUIRE_EQUAL(Hs1.size(), bi.size());
+    BOOST_REQUIRE_EQUAL(HsN.size(), bi.size());
+    for (uint ib = 0; ib < bi.size(); ++ib){
+        generateHamOvl(H, S, kp, AtomicStructView(bi[ib]), AtomicStructView(bj[ib]));
+        BOOST_CHECK(same(Hs1[ib], H));
+        BOOST_CHECK(same(HsN[ib], Hs1[ib]));
+        BOOST_CHECK(same(SsN[ib], Ss1[ib]));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(bonds_follow_Bz)
+{
+    GrapheneOneValleyKpParams p;
+    AtomicStruct grid = create_grid(p, 7, 5);
+    AtomicStructView v(grid);
+
+    cxmat H, S;
+    generateHamOvl(H, S, p, v, v);
+    BondHam bonds(p, v, v);
+    BOOST_CHECK(same(bonds.H(), H));
+    BOOST_CHECK(same(bonds.S(), S));
+    BOOST_CHECK_EQUAL(bonds.nnz(), uword(accu(H != dcmplx(0, 0))));
+
+    // a new field only changes the phases of the bonds.
+    double Bzs[] = {20, -15, 0};
+    int gauges[] = {coord::X, coord::Y, coord::X};
+    for (uint ib = 0; ib < 3; ++ib){
+        p.Bz(Bzs[ib], gauges[ib]);
+        generateHamOvl(H, S, p, v, v);
+        bonds.Bz(Bzs[ib], gauges[ib]);
+        BOOST_CHECK_EQUAL(bonds.Bz(), Bzs[ib]);
+        check_close(bonds.H(), H);
+        BOOST_CHECK(same(bonds.S(), S));
+    }
+
+    // bonds generated in a field, taken back to zero field.
+    p.Bz(20, coord::Y);
+    BondHam inField(p, v, v);
+    p.Bz(0);
+    generateHamOvl(H, S, p, v, v);
+    inField.Bz(0);
+    check_close(inField.H(), H);
+
+    // graphene tight binding has no Peierls phase.
+    GrapheneTbParams tb;
+    AtomicStruct gnr = create_gnr(tb, 6, 3);
+    AtomicStructView g(gnr);
+    BondHam gbonds(tb, g, g);
+    tb.Bz(20);
+    generateHamOvl(H, S, tb, g, g);
+    gbonds.Bz(20);
+    BOOST_CHECK(same(gbonds.H(), H));
+
+    // many pairs of blocks.
+    vector<AtomicStruct> bi(2, gnr), bj(2, gnr);
+    bj[1] = gnr(span(0, gnr.NumOfAtoms()/2 - 1));
+    vector<shared_ptr<BondHam> > b1 = generateBonds(tb, bi, bj, 1);
+    vector<shared_ptr<BondHam> > bN = generateBonds(tb, bi, bj, NThreads);
+    BOOST_REQUIRE_EQUAL(b1.size(), 2);
+    BOOST_REQUIRE_EQUAL(bN.size(), 2);
+    for (uint ib = 0; ib < 2; ++ib){
+        generateHamOvl(H, S, tb, AtomicStructView(bi[ib]), AtomicStructView(bj[ib]));
+        BOOST_CHECK(same(b1[ib]->H(), H));
+        BOOST_CHECK(same(bN[ib]->H(), b1[ib]->H()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(kp_stencil_matches_generated_blocks)
+{
+    GrapheneOneValleyKpParams p;
+    uint nx = 6, ny = 4;
+    AtomicStruct grid = create_grid(p, nx, ny);
+    double x0 = grid.xmin(), y0 = grid.ymin();
+
+    double Bzs[] = {0, 20, 20};
+    int gauges[] = {coord::X, coord::X, coord::Y};
+    for (uint ib = 0; ib < 3; ++ib){
+        p.Bz(Bzs[ib], gauges[ib]);
+        KpStencil st = p.stencil();
+        field<shared_ptr<cxmat> > H0, Hl, S0;
+        generateKpBlocks(H0, Hl, S0, p, nx, ny, x0, y0);
+        BOOST_REQUIRE_EQUAL(H0.n_elem, nx);
+        BOOST_REQUIRE_EQUAL(Hl.n_elem, nx + 1);
+
+        cxmat H, S;
+        for (uint ix = 0; ix < nx; ++ix){
+            AtomicStructView col(grid, span(ix*ny, (ix + 1)*ny - 1));
+            generateHamOvl(H, S, p, col, col);
+            check_close(*H0(ix), H);
+            check_close(kpBlockH0(st, ny, x0, y0, ix), H);
+            BOOST_CHECK(same(*S0(ix), S));
+            BOOST_CHECK(same(kpBlockS0(st, ny), S));
+            if (ix > 0){
+                AtomicStructView prev(grid, span((ix - 1)*ny, ix*ny - 1));
+                generateHamOvl(H, S, p, col, prev);
+                check_close(*Hl(ix), H);
+                check_close(kpBlockHl(st, ny, x0, y0, ix), H);
+            }
+        }
+    }
+}
+
@@ -0,0 +1,114 @@
+/**
+ * Test cases for the block-tridiagonal partitioning of a device. Every atom
+ * has to be in exactly one block and only neighboring blocks are coupled.
+ *
+ */
+
+#include "hamiltonian/partition.hpp"
+#include "hamiltonian/tb/graphenetb.h"
+
+#ifndef LINK_STATIC
+#define BOOST_TEST_DYN_LINK
+#endif
+#define BOOST_TEST_MODULE PartitionTest
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+
+using namespace quest::hamiltonian;
+using namespace quest::atoms;
+using namespace std;
+
+/*
+ * Graphene nanoribbon of nl cells cut into the left contact (2 cells), the
+ * device and the right contact (2 cells).
+ */
+struct Ribbon{
+    GrapheneTbParams p;
+    AtomicStruct dev, lc, rc;
+
+    Ribbon(uint nl, uint nw){
+        ptable pt = p.periodicTable();
+        Atom C = pt[CarbonID];
+        AtomicStruct cell, gnr;
+        cell.genGNR(C, p.acc(), 1u, 1u);
+        gnr.genGNR(C, p.acc(), nl, nw);
+
+        double a = cell.LatticeVector().a1(coord::X);
+        double x0 = gnr.xmin() - 1E-3;
+        double ylo = gnr.ymin() - 1, yhi = gnr.ymax() + 1;
+        double zlo = gnr.zmin() - 1, zhi = gnr.zmax() + 1;
+        lc = gnr(gnr.inBox(point3(x0, ylo, zlo), point3(x0 + 2*a, yhi, zhi)));
+        dev = gnr(gnr.inBox(point3(x0 + 2*a, ylo, zlo), point3(x0 + (nl-2)*a, yhi, zhi)));
+        rc = gnr(gnr.inBox(point3(x0 + (nl-2)*a, ylo, zlo), point3(x0 + nl*a, yhi, zhi)));
+    }
+
+    static svec point3(double x, double y, double z){
+        svec r(3);
+        r(coord::X) = x;
+        r(coord::Y) = y;
+        r(coord::Z) = z;
+        return r;
+    }
+};
+
+// Are any of the atoms of a and b coupled through H?
+bool coupled(const GrapheneTbParams &p, const AtomicStructView &a,
+        const AtomicStructView &b)
+{
+    cxmat H, S;
+    generateHamOvl(H, S, p, a, b);
+    return arma::accu(arma::abs(H)) > 0;
+}
+
+BOOST_AUTO_TEST_CASE(blocks_cover_the_device_once)
+{
+    Ribbon r(12, 3);
+    BOOST_REQUIRE(r.dev.NumOfAtoms() > 0);
+    field<ucol> blocks = partition(r.p, r.dev, r.lc, r.rc);
+    uint nb = blocks.n_elem;
+    BOOST_REQUIRE(nb > 2);
+
+    uvec count(r.dev.NumOfAtoms(), fill::zeros);
+    for (uint ib = 0; ib < nb; ++ib){
+        BOOST_CHECK(blocks(ib).n_elem > 0);
+        for (uint ia = 0; ia < blocks(ib).n_elem; ++ia){
+            BOOST_REQUIRE(blocks(ib)(ia) < count.n_elem);
+            count(blocks(ib)(ia)) += 1;
+        }
+    }
+    BOOST_CHECK(arma::all(count == 1));
+    BOOST_CHECK_NO_THROW(checkPartition(blocks, r.p, r.dev, r.lc, r.rc));
+}
+
+BOOST_AUTO_TEST_CASE(only_neighboring_blocks_are_coupled)
+{
+    Ribbon r(12, 3);
+    field<ucol> blocks = partition(r.p, r.dev, r.lc, r.rc);
+    uint nb = blocks.n_elem;
+
+    AtomicStructView lcv(r.lc), rcv(r.rc);
+    for (uint ib = 0; ib < nb; ++ib){
+        AtomicStructView bi(r.dev, blocks(ib));
+        for (uint jb = 0; jb < nb; ++jb){
+            if (jb != ib){
+                AtomicStructView bj(r.dev, blocks(jb));
+                BOOST_CHECK_EQUAL(coupled(r.p, bi, bj), std::abs(int(ib) - int(jb)) == 1);
+            }
+        }
+        BOOST_CHECK_EQUAL(coupled(r.p, bi, lcv), ib == 0);
+        BOOST_CHECK_EQUAL(coupled(r.p, bi, rcv), ib == nb-1);
+    }
+
+    // the first two blocks swapped.
+    field<ucol> swapped = blocks;
+    swapped(0) = blocks(1);
+    swapped(1) = blocks(0);
+    BOOST_CHECK_THROW(checkPartition(swapped, r.p, r.dev, r.lc, r.rc), invalid_argument);
+
+    // an atom left out.
+    field<ucol> missing = blocks;
+    missing(1) = blocks(1).rows(1, blocks(1).n_elem-1);
+    BOOST_CHECK_THROW(checkPartition(missing, r.p, r.dev, r.lc, r.rc), invalid_argument);
+}
+
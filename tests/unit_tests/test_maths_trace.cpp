@@ -0,0 +1,72 @@
+/**
+ * Test cases for the block traces of products, traceProd(). They have to
+ * match the trace of the full product.
+ *
+ */
+
+#include "maths/trace.hpp"
+
+#ifndef LINK_STATIC
+#define BOOST_TEST_DYN_LINK
+#endif
+#define BOOST_TEST_MODULE TraceTest
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+
+using namespace maths;
+using namespace std;
+
+void check_close(const cxmat &got, const cxmat &expected){
+    BOOST_REQUIRE_EQUAL(got.n_rows, expected.n_rows);
+    BOOST_REQUIRE_EQUAL(got.n_cols, expected.n_cols);
+    BOOST_CHECK_SMALL(norm(got - expected, "fro"), 1E-12*(1 + norm(expected, "fro")));
+}
+
+BOOST_AUTO_TEST_CASE(trace_of_two_matrices)
+{
+    arma::arma_rng::set_seed(3);
+    // A*B is square, A and B are not.
+    cxmat A = arma::randu<cxmat>(12, 5);
+    cxmat B = arma::randu<cxmat>(5, 12);
+    ucol vertices;
+    vertices << 0 << 2 << 3;
+
+    for (uint N = 1; N <= 4; ++N){
+        check_close(traceProd(A, B, N), trace<cxmat>(A*B, N));
+    }
+    check_close(traceProd(A, B, 3, &vertices), trace<cxmat>(A*B, 3, &vertices));
+}
+
+BOOST_AUTO_TEST_CASE(trace_of_three_matrices)
+{
+    arma::arma_rng::set_seed(5);
+    cxmat A = arma::randu<cxmat>(12, 7);
+    cxmat B = arma::randu<cxmat>(7, 4);
+    cxmat C = arma::randu<cxmat>(4, 12);
+    ucol vertices;
+    vertices << 1 << 5;
+
+    for (uint N = 1; N <= 4; ++N){
+        check_close(traceProd(A, B, C, N), trace<cxmat>(A*B*C, N));
+    }
+    check_close(traceProd(A, B, C, 2, &vertices), trace<cxmat>(A*B*C, 2, &vertices));
+}
+
+BOOST_AUTO_TEST_CASE(wrong_sizes_are_rejected)
+{
+    cxmat A(6, 4, fill::zeros), B(4, 6, fill::zeros), C(4, 5, fill::zeros);
+    ucol outside;
+    outside << 3;
+
+    // cannot be multiplied.
+    BOOST_CHECK_THROW(traceProd(A, A, 1), invalid_argument);
+    BOOST_CHECK_THROW(traceProd(A, B, A, 1), invalid_argument);
+    // A*B is not square.
+    BOOST_CHECK_THROW(traceProd(A, C, 1), invalid_argument);
+    // 6 rows are not blocks of 4.
+    BOOST_CHECK_THROW(traceProd(A, B, 4), invalid_argument);
+    // block 3 of size 2 is beyond 6 rows.
+    BOOST_CHECK_THROW(traceProd(A, B, 2, &outside), invalid_argument);
+}
+
@@ -0,0 +1,142 @@
+/**
+ * Test cases for the banded inverse of the diagonal blocks of CohRgfa. It
+ * has to give the same T(E) as the dense inverse.
+ *
+ */
+
+#include "negf/CohRgfa.h"
+#include "maths/banded.h"
+
+#ifndef LINK_STATIC
+#define BOOST_TEST_DYN_LINK
+#endif
+#define BOOST_TEST_MODULE BandedTest
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+
+using namespace quest::negf;
+using namespace std;
+
+const uint no = 30;         // orbitals per block.
+const uint N = 4;           // blocks in the device.
+const uint nb = N + 2;      // blocks including the contacts.
+const double kT = 0.0259;
+const dcmplx ieta(0, 1E-3);
+
+/*
+ * Each block is a chain of no orbitals numbered in a random order, so that
+ * it has to be reordered to become banded. Neighboring blocks are coupled
+ * through three orbitals only.
+ */
+struct ShuffledChains{
+    field<shared_ptr<cxmat> > H0, Hl, S0, Sl;
+    field<shared_ptr<vec> > V;
+
+    ShuffledChains(): H0(nb), Hl(nb+1), S0(nb), Sl(nb+1), V(nb){
+        arma::arma_rng::set_seed(23);
+        uwcol p = arma::shuffle(linspace<uwcol>(0, no-1, no));
+        uwcol coupled;
+        coupled << p(0) << p(no/2) << p(no-1);
+
+        for (uint ib = 0; ib < nb; ++ib){
+            vec onsite = 0.4*(arma::randu<vec>(no) - 0.5);
+            if (ib == 0 || ib == nb-1){
+                onsite.zeros();
+            }
+            cxmat H(no, no, fill::zeros);
+            for (uint io = 0; io < no; ++io){
+                H(p(io), p(io)) = onsite(io);
+                if (io+1 < no){
+                    H(p(io), p(io+1)) = H(p(io+1), p(io)) = -1.0;
+                }
+            }
+            H0(ib) = make_shared<cxmat>(H);
+        }
+        for (uint ib = 0; ib <= nb; ++ib){
+            vec t = -0.8 - 0.4*arma::randu<vec>(coupled.n_elem);
+            if (ib == 0 || ib == nb){
+                t.fill(-1.0);
+            }
+            cxmat T(no, no, fill::zeros);
+            for (uint ic = 0; ic < coupled.n_elem; ++ic){
+                T(coupled(ic), coupled(ic)) = t(ic);
+            }
+            Hl(ib) = make_shared<cxmat>(T);
+            Sl(ib) = make_shared<cxmat>(no, no, fill::zeros);
+        }
+        for (uint ib = 0; ib < nb; ++ib){
+            S0(ib) = make_shared<cxmat>(no, no, fill::eye);
+            V(ib) = make_shared<vec>(no, fill::zeros);
+        }
+    }
+
+    void setup(CohRgfa &rgf, double E) const {
+        rgf.H(H0, Hl);
+        rgf.S(S0, Sl);
+        rgf.V(V);
+        rgf.E(E);
+    }
+};
+
+void check_close(const cxmat &got, const cxmat &expected, double tol){
+    BOOST_CHECK_SMALL(norm(got - expected, "fro"), tol*(1 + norm(expected, "fro")));
+}
+
+BOOST_AUTO_TEST_CASE(banded_inverse_and_update)
+{
+    arma::arma_rng::set_seed(29);
+    uword n = 40, kb = 2;
+    cxmat A = arma::randu<cxmat>(n, n);
+    for (uword m = 0; m < n; ++m){
+        for (uword k = 0; k < n; ++k){
+            if (m > k + kb || k > m + kb){
+                A(m, k) = 0;
+            }
+        }
+    }
+    A.diag() += 4.0;
+    BOOST_CHECK_EQUAL(maths::bandwidth(A), kb);
+
+    cxmat Ainv;
+    BOOST_REQUIRE(maths::invBanded(Ainv, A, kb));
+    check_close(Ainv, inv(A), 1E-10);
+
+    // self energy on a few rows and columns.
+    uwcol P;
+    P << 3 << 17 << 39;
+    cxmat SigPP = arma::randu<cxmat>(P.n_elem, P.n_elem);
+    cxmat Sig(n, n, fill::zeros);
+    Sig.submat(P, P) = SigPP;
+    check_close(maths::invUpdate(Ainv, SigPP, P), inv(A - Sig), 1E-10);
+
+    // a shuffled band is reordered back into a band.
+    uwcol p = arma::shuffle(linspace<uwcol>(0, n-1, n));
+    cxmat B = A.submat(p, p);
+    uwcol q = maths::rcm(B);
+    BOOST_REQUIRE(arma::all(arma::sort(q) == linspace<uwcol>(0, n-1, n)));
+    uword kbq = maths::bandwidth(B.submat(q, q));
+    BOOST_CHECK(kbq < maths::bandwidth(B));
+    cxmat Binv(n, n);
+    BOOST_REQUIRE(maths::invBanded(Ainv, B.submat(q, q), kbq));
+    Binv.submat(q, q) = Ainv;
+    check_close(Binv, inv(B), 1E-10);
+}
+
+BOOST_AUTO_TEST_CASE(transmission_matches_dense_inverse)
+{
+    ShuffledChains s;
+    vec Es = linspace<vec>(-1.5, 1.5, 7);
+    for (uint ie = 0; ie < Es.n_elem; ++ie){
+        CohRgfa dense(nb, kT, ieta);
+        s.setup(dense, Es(ie));
+        CohRgfa banded(nb, kT, ieta);
+        banded.banded(true);
+        s.setup(banded, Es(ie));
+
+        dcmplx T = dense.TEop()(0, 0);
+        BOOST_CHECK_SMALL(abs(banded.TEop()(0, 0) - T), 1E-8*(1 + abs(T)));
+        check_close(banded.DOSop(), dense.DOSop(), 1E-8);
+    }
+}
+
@@ -0,0 +1,102 @@
+/**
+ * Test cases for the checkpoints of CohRgfLoop. A checkpoint can only be
+ * restarted by the calculation that wrote it.
+ *
+ */
+
+#include "negf/CohRgfLoop.h"
+
+#ifndef LINK_STATIC
+#define BOOST_TEST_DYN_LINK
+#endif
+#define BOOST_TEST_MODULE CheckpointTest
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <iostream>
+
+using namespace quest::negf;
+using namespace std;
+
+const string Checkpoint = "test_negf_checkpoint.chk";
+const uint no = 2, nb = 6;
+
+// MPI is initialized once per process.
+const Workers& workers(){
+    static Workers w;
+    return w;
+}
+
+/*
+ * Chain of nb blocks of no orbitals, all the orbitals of block ib at
+ * potential V(ib).
+ */
+void create_chain(CohRgfLoop &loop, const vec &Vb){
+    shared_ptr<cxmat> H0 = make_shared<cxmat>(no, no, fill::zeros);
+    (*H0)(0, 1) = (*H0)(1, 0) = -1.0;
+    shared_ptr<cxmat> Hl = make_shared<cxmat>(no, no, fill::zeros);
+    Hl->diag().fill(-1.0);
+    shared_ptr<cxmat> S0 = make_shared<cxmat>(no, no, fill::eye);
+    shared_ptr<cxmat> Sl = make_shared<cxmat>(no, no, fill::zeros);
+
+    field<shared_ptr<cxmat> > H0s(nb, 1), S0s(nb, 1), Hls(nb+1, 1), Sls(nb+1, 1);
+    field<shared_ptr<vec> > V(nb);
+    for (uint ib = 0; ib < nb; ++ib){
+        H0s(ib) = H0;
+        S0s(ib) = S0;
+        V(ib) = make_shared<vec>(no);
+        V(ib)->fill(Vb(ib));
+    }
+    for (uint ib = 0; ib <= nb; ++ib){
+        Hls(ib) = Hl;
+        Sls(ib) = Sl;
+    }
+    loop.H(H0s, Hls);
+    loop.S(S0s, Sls);
+    loop.V(V);
+}
+
+void setup(CohRgfLoop &loop, const vec &Vb, double muD, bool restart){
+    create_chain(loop, Vb);
+    loop.E(linspace<vec>(-1.0, 1.0, 5));
+    loop.mu(muD, 0.0);
+    loop.enableTE();
+    loop.checkpoint(Checkpoint, 1E6);
+    loop.restart(restart);
+}
+
+void remove_checkpoint(){
+    stringstream fileName;
+    fileName << Checkpoint << "." << workers().MyId();
+    std::remove(fileName.str().c_str());
+}
+
+BOOST_AUTO_TEST_CASE(changed_device_invalidates_checkpoint)
+{
+    vec Vb(nb, fill::zeros);
+    Vb(2) = 0.1;
+
+    CohRgfLoop first(workers(), nb);
+    setup(first, Vb, 0.0, false);
+    first.run();
+
+    // the same calculation restarts from the checkpoint.
+    CohRgfLoop same(workers(), nb);
+    setup(same, Vb, 0.0, true);
+    BOOST_CHECK_NO_THROW(same.run());
+
+    // a different potential in one block.
+    vec Vb2 = Vb;
+    Vb2(3) = 0.05;
+    CohRgfLoop changedV(workers(), nb);
+    setup(changedV, Vb2, 0.0, true);
+    BOOST_CHECK_THROW(changedV.run(), runtime_error);
+
+    // a different drain Fermi level.
+    CohRgfLoop changedMu(workers(), nb);
+    setup(changedMu, Vb, -0.2, true);
+    BOOST_CHECK_THROW(changedMu.run(), runtime_error);
+
+    remove_checkpoint();
+}
+
@@ -0,0 +1,104 @@
+/**
+ * Test cases for the renormalization-decimation of uniform segments in
+ * CohRgfa. The decimated right connected Green function must give the same
+ * observables as the block by block recursion.
+ *
+ */
+
+#include "negf/CohRgfa.h"
+
+#ifndef LINK_STATIC
+#define BOOST_TEST_DYN_LINK
+#endif
+#define BOOST_TEST_MODULE DecimationTest
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <iostream>
+
+using namespace quest::negf;
+using namespace std;
+
+/*
+ * Uniform chain of nb blocks of no orbitals each, including the contacts.
+ * Inside a block the orbitals form a chain with hopping -t, neighboring
+ * blocks are coupled orbital by orbital.
+ */
+void create_uniform_chain(CohRgfa &rgf, uint no, uint nb, bool orthogonal){
+    double t = 1.0;
+    shared_ptr<cxmat> H0 = make_shared<cxmat>(no, no, fill::zeros);
+    for (uint io = 0; io+1 < no; ++io){
+        (*H0)(io, io+1) = -t;
+        (*H0)(io+1, io) = -t;
+    }
+    shared_ptr<cxmat> Hl = make_shared<cxmat>(no, no, fill::zeros);
+    Hl->diag().fill(-t);
+
+    shared_ptr<cxmat> S0 = make_shared<cxmat>(no, no, fill::eye);
+    shared_ptr<cxmat> Sl = make_shared<cxmat>(no, no, fill::zeros);
+    if (!orthogonal){
+        Sl->diag().fill(0.05);
+    }
+    shared_ptr<vec> V0 = make_shared<vec>(no, fill::zeros);
+
+    field<shared_ptr<cxmat> > H0s(nb), S0s(nb), Hls(nb+1), Sls(nb+1);
+    field<shared_ptr<vec> > V(nb);
+    for (uint ib = 0; ib < nb; ++ib){
+        H0s(ib) = H0;
+        S0s(ib) = S0;
+        V(ib) = V0;
+    }
+    for (uint ib = 0; ib <= nb; ++ib){
+        Hls(ib) = Hl;
+        Sls(ib) = Sl;
+    }
+
+    rgf.H(H0s, Hls);
+    rgf.S(S0s, Sls);
+    rgf.V(V);
+}
+
+void check_decimation(bool orthogonal){
+    uint no = 3, N = 13;
+    CohRgfa plain(N+2, 0.0259, dcmplx(0, 1E-3), orthogonal);
+    CohRgfa decimated(N+2, 0.0259, dcmplx(0, 1E-3), orthogonal);
+    create_uniform_chain(plain, no, N+2, orthogonal);
+    create_uniform_chain(decimated, no, N+2, orthogonal);
+    decimated.decimate();
+
+    // E = 0 and -sqrt(2) are eigenvalues of an isolated block, the 
+    // decimation has to fall back to the block by block recursion at and 
+    // next to them.
+    double energies[] = {-1.3, -0.4, 0.0, 0.7, 1.9, 1E-12, -sqrt(2.0) + 1E-12};
+    for (double E: energies){
+        plain.E(E);
+        decimated.E(E);
+
+        // T(E) only needs grc of block 2, which comes from the decimated
+        // segment of blocks 2 to N.
+        double TEp = std::real(plain.TEop()(0,0));
+        double TEd = std::real(decimated.TEop()(0,0));
+        BOOST_CHECK_CLOSE(TEd, TEp, 1E-6);
+        // TE of a uniform chain does not decay along the device.
+        BOOST_CHECK(TEp > 0.5);
+
+        // A_i,i needs grc of block i+1, including the ones filled in
+        // inside the decimated segment.
+        for (uint ib = 1; ib <= N; ++ib){
+            double Ap = std::real(plain.Aop(1, ib)(0,0));
+            double Ad = std::real(decimated.Aop(1, ib)(0,0));
+            BOOST_CHECK_CLOSE(Ad, Ap, 1E-6);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(decimation_matches_rgf_orthogonal)
+{
+    check_decimation(true);
+}
+
+BOOST_AUTO_TEST_CASE(decimation_matches_rgf_nonorthogonal)
+{
+    check_decimation(false);
+}
+
@@ -0,0 +1,197 @@
+/**
+ * Test cases for the observables of CohRgfa that are calculated from a few
+ * blocks of G: T(E), the bond current map and the LDOS map. They have to
+ * match the same quantities calculated from the full G of the device.
+ *
+ */
+
+#include "negf/CohRgfa.h"
+#include "negf/computegs.h"
+
+#ifndef LINK_STATIC
+#define BOOST_TEST_DYN_LINK
+#endif
+#define BOOST_TEST_MODULE ObservablesTest
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+
+using namespace quest::negf;
+using namespace std;
+
+const uint no = 3;          // orbitals per block.
+const uint N = 4;           // blocks in the device.
+const uint nb = N + 2;      // blocks including the contacts.
+const double E = 0.3, muS = 0.5, muD = 0.1, kT = 0.0259;
+const dcmplx ieta(0, 1E-3);
+
+/*
+ * Random Hermitian device blocks between two uniform contacts. The
+ * contacts are chains of no orbitals coupled by -I.
+ */
+struct RandomSystem{
+    field<shared_ptr<cxmat> > H0, Hl, S0, Sl;
+    field<shared_ptr<vec> > V;
+
+    RandomSystem(): H0(nb), Hl(nb+1), S0(nb), Sl(nb+1), V(nb){
+        arma::arma_rng::set_seed(11);
+        shared_ptr<cxmat> H0c = make_shared<cxmat>(no, no, fill::zeros);
+        for (uint io = 0; io+1 < no; ++io){
+            (*H0c)(io, io+1) = (*H0c)(io+1, io) = -0.5;
+        }
+        shared_ptr<cxmat> Hlc = make_shared<cxmat>(no, no, fill::zeros);
+        Hlc->diag().fill(-1.0);
+        H0(0) = H0(nb-1) = H0c;
+        Hl(0) = Hl(nb) = Hlc;
+
+        for (uint ib = 1; ib < nb-1; ++ib){
+            cxmat R = arma::randu<cxmat>(no, no) - dcmplx(0.5, 0.5);
+            H0(ib) = make_shared<cxmat>(0.5*(R + trans(R)));
+        }
+        for (uint ib = 1; ib < nb; ++ib){
+            cxmat R = arma::randu<cxmat>(no, no) - dcmplx(0.5, 0.5);
+            Hl(ib) = make_shared<cxmat>(*Hlc + 0.3*R);
+        }
+        for (uint ib = 0; ib < nb; ++ib){
+            S0(ib) = make_shared<cxmat>(no, no, fill::eye);
+            V(ib) = make_shared<vec>(no, fill::zeros);
+        }
+        for (uint ib = 0; ib <= nb; ++ib){
+            Sl(ib) = make_shared<cxmat>(no, no, fill::zeros);
+        }
+    }
+
+    void setup(CohRgfa &rgf) const {
+        rgf.H(H0, Hl);
+        rgf.S(S0, Sl);
+        rgf.V(V);
+        rgf.mu(muD, muS);
+        rgf.E(E);
+    }
+};
+
+/*
+ * Everything of the device from the full G = [E - H - SigL - SigR]^-1.
+ */
+struct DenseNegf{
+    cxmat G, A, Gn, GamL, GamR;
+    double f0, fNp1;
+
+    span block(uint ib) const { return span((ib-1)*no, ib*no-1); }
+
+    DenseNegf(const RandomSystem &s){
+        uint n = N*no;
+        cxmat M(n, n, fill::zeros);
+        for (uint ib = 1; ib <= N; ++ib){
+            M(block(ib), block(ib)) = E*eye<cxmat>(no, no) - *s.H0(ib);
+        }
+        for (uint ib = 1; ib < N; ++ib){
+            M(block(ib+1), block(ib)) = -*s.Hl(ib+1);
+            M(block(ib), block(ib+1)) = -trans(*s.Hl(ib+1));
+        }
+
+        cxmat gL, gR;
+        computegs(gL, E, *s.H0(0), *s.S0(0), *s.Hl(0), ieta, 1E-8);
+        computegs(gR, E, *s.H0(nb-1), *s.S0(nb-1), trans(*s.Hl(nb)), ieta, 1E-8);
+        cxmat SigL = (*s.Hl(1))*gL*trans(*s.Hl(1));
+        cxmat SigR = trans(*s.Hl(N+1))*gR*(*s.Hl(N+1));
+        M(block(1), block(1)) -= SigL;
+        M(block(N), block(N)) -= SigR;
+        G = inv(M);
+
+        GamL = zeros<cxmat>(n, n);
+        GamR = zeros<cxmat>(n, n);
+        GamL(block(1), block(1)) = i*(SigL - trans(SigL));
+        GamR(block(N), block(N)) = i*(SigR - trans(SigR));
+
+        f0 = fermi(E, muS, kT);
+        fNp1 = fermi(E, muD, kT);
+        A = i*(G - trans(G));
+        Gn = G*(GamL*f0 + GamR*fNp1)*trans(G);
+    }
+};
+
+void check_close(dcmplx got, dcmplx expected){
+    BOOST_CHECK_SMALL(abs(got - expected), 1E-8*(1 + abs(expected)));
+}
+
+BOOST_AUTO_TEST_CASE(transmission_matches_dense)
+{
+    RandomSystem s;
+    DenseNegf d(s);
+    CohRgfa rgf(nb, kT, ieta);
+    s.setup(rgf);
+
+    dcmplx T = arma::trace(d.GamL*d.G*d.GamR*trans(d.G));
+    BOOST_CHECK(real(T) > 1E-3);
+    check_close(rgf.TEop()(0, 0), T);
+
+    // traced orbital by orbital.
+    cxmat TN = rgf.TEop(no);
+    cxmat TNd = trace<cxmat>(d.GamL*d.G*d.GamR*trans(d.G), no);
+    for (uint io = 0; io < no; ++io){
+        for (uint jo = 0; jo < no; ++jo){
+            check_close(TN(io, jo), TNd(io, jo));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ldos_map_matches_dense)
+{
+    RandomSystem s;
+    DenseNegf d(s);
+    CohRgfa rgf(nb, kT, ieta);
+    s.setup(rgf);
+
+    cxmat LDOS = rgf.LDOSMapop();
+    BOOST_REQUIRE_EQUAL(LDOS.n_rows, N*no);
+    BOOST_REQUIRE_EQUAL(LDOS.n_cols, 2);
+    for (uint io = 0; io < N*no; ++io){
+        check_close(LDOS(io, 0), d.A(io, io)/(2*pi));
+        check_close(LDOS(io, 1), d.Gn(io, io)/(2*pi));
+    }
+
+    // the same as the blocks of the per block operators.
+    for (uint ib = 1; ib <= N; ++ib){
+        check_close(accu(LDOS(d.block(ib), 0)), rgf.Aop(1, ib)(0, 0)/(2*pi));
+        check_close(accu(LDOS(d.block(ib), 1)), rgf.nOp(1, ib)(0, 0));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(bond_current_map_matches_dense)
+{
+    RandomSystem s;
+    DenseNegf d(s);
+    CohRgfa rgf(nb, kT, ieta);
+    s.setup(rgf);
+
+    cxmat IMap = rgf.IMapop();
+    BOOST_REQUIRE_EQUAL(IMap.n_cols, N + 1);
+
+    // bonds inside the device: I_i,i+1 = i*(tr{Gn_i,i+1*H_i+1,i}' - tr{...})
+    for (uint ib = 1; ib < N; ++ib){
+        cxmat Gnij = d.Gn(d.block(ib), d.block(ib+1));
+        dcmplx t = arma::trace(Gnij*(*s.Hl(ib+1)));
+        check_close(IMap(0, ib), i*(conj(t) - t));
+    }
+
+    // every bond is the same as Iop() and no current is lost in the device.
+    for (uint ib = 0; ib <= N; ++ib){
+        check_close(IMap(0, ib), rgf.Iop(1, ib, ib+1)(0, 0));
+    }
+    for (uint ib = 2; ib < N; ++ib){
+        check_close(IMap(0, ib), IMap(0, 1));
+    }
+
+    // traced orbital by orbital.
+    cxmat IMapN = rgf.IMapop(no);
+    for (uint ib = 0; ib <= N; ++ib){
+        cxmat Iij = rgf.Iop(no, ib, ib+1);
+        for (uint io = 0; io < no; ++io){
+            for (uint jo = 0; jo < no; ++jo){
+                check_close(IMapN(io, ib*no + jo), Iij(io, jo));
+            }
+        }
+    }
+}
+
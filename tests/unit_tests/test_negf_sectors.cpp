@@ -0,0 +1,114 @@
+/**
+ * Test cases for findSectors().
+ *
+ */
+
+#include "negf/sectors.h"
+
+#ifndef LINK_STATIC
+#define BOOST_TEST_DYN_LINK
+#endif
+#define BOOST_TEST_MODULE SectorsTest
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+
+using namespace quest::negf;
+using namespace std;
+
+/*
+ * nb blocks of 4 orbitals. Orbitals 0 and 2 make one ladder and orbitals
+ * 1 and 3 another one, the two ladders are not coupled.
+ */
+void create_two_ladders(field<shared_ptr<cxmat> > &H0,
+        field<shared_ptr<cxmat> > &Hl, uint nb)
+{
+    shared_ptr<cxmat> H0b = make_shared<cxmat>(4, 4, fill::zeros);
+    (*H0b)(0, 2) = (*H0b)(2, 0) = -1.0;
+    (*H0b)(1, 3) = (*H0b)(3, 1) = -2.0;
+    (*H0b)(1, 1) = 0.5;
+    shared_ptr<cxmat> Hlb = make_shared<cxmat>(4, 4, fill::zeros);
+    Hlb->diag().fill(-1.0);
+
+    H0.set_size(nb, 1);
+    Hl.set_size(nb+1, 1);
+    for (uint ib = 0; ib < nb; ++ib){
+        H0(ib, 0) = H0b;
+    }
+    for (uint ib = 0; ib <= nb; ++ib){
+        Hl(ib, 0) = Hlb;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(decoupled_ladders_are_two_sectors)
+{
+    uint nb = 5;
+    field<shared_ptr<cxmat> > H0, Hl, S0, Sl;
+    create_two_ladders(H0, Hl, nb);
+
+    field<uwcol> sectors = findSectors(H0, Hl, S0, Sl);
+    BOOST_REQUIRE_EQUAL(sectors.n_rows, 2);
+    BOOST_REQUIRE_EQUAL(sectors.n_cols, nb);
+    for (uint ib = 0; ib < nb; ++ib){
+        BOOST_REQUIRE_EQUAL(sectors(0, ib).n_elem, 2);
+        BOOST_REQUIRE_EQUAL(sectors(1, ib).n_elem, 2);
+        BOOST_CHECK_EQUAL(sectors(0, ib)(0), 0);
+        BOOST_CHECK_EQUAL(sectors(0, ib)(1), 2);
+        BOOST_CHECK_EQUAL(sectors(1, ib)(0), 1);
+        BOOST_CHECK_EQUAL(sectors(1, ib)(1), 3);
+    }
+
+    // The Hamiltonian cut out for a sector keeps all of its couplings.
+    cxmat H00 = H0(0, 0)->submat(sectors(0, 0), sectors(0, 0));
+    cxmat H01 = H0(0, 0)->submat(sectors(1, 0), sectors(1, 0));
+    BOOST_CHECK_EQUAL(std::real(H00(0, 1)), -1.0);
+    BOOST_CHECK_EQUAL(std::real(H01(0, 1)), -2.0);
+    BOOST_CHECK_EQUAL(std::real(H01(0, 0)), 0.5);
+}
+
+BOOST_AUTO_TEST_CASE(overlap_couples_sectors)
+{
+    uint nb = 5;
+    field<shared_ptr<cxmat> > H0, Hl, S0(nb, 1), Sl;
+    create_two_ladders(H0, Hl, nb);
+
+    // an overlap between the ladders in one block joins them.
+    for (uint ib = 0; ib < nb; ++ib){
+        S0(ib, 0) = make_shared<cxmat>(4, 4, fill::eye);
+    }
+    S0(2, 0) = make_shared<cxmat>(4, 4, fill::eye);
+    (*S0(2, 0))(0, 1) = (*S0(2, 0))(1, 0) = 0.1;
+
+    field<uwcol> sectors = findSectors(H0, Hl, S0, Sl);
+    BOOST_REQUIRE_EQUAL(sectors.n_rows, 1);
+    for (uint ib = 0; ib < nb; ++ib){
+        BOOST_CHECK_EQUAL(sectors(0, ib).n_elem, 4);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(incomplete_sector_is_merged)
+{
+    uint nb = 4;
+    field<shared_ptr<cxmat> > H0, Hl, S0, Sl;
+    create_two_ladders(H0, Hl, nb);
+
+    // orbital 3 of the last block is cut off from the rest of its ladder
+    // and forms a sector of its own that is merged to the first one.
+    shared_ptr<cxmat> H0last = make_shared<cxmat>(*H0(nb-1, 0));
+    (*H0last)(1, 3) = (*H0last)(3, 1) = 0.0;
+    H0(nb-1, 0) = H0last;
+    shared_ptr<cxmat> Hllast = make_shared<cxmat>(*Hl(nb-1, 0));
+    (*Hllast)(3, 3) = 0.0;
+    Hl(nb-1, 0) = Hllast;
+    shared_ptr<cxmat> Hlend = make_shared<cxmat>(*Hl(nb, 0));
+    (*Hlend)(3, 3) = 0.0;
+    Hl(nb, 0) = Hlend;
+
+    field<uwcol> sectors = findSectors(H0, Hl, S0, Sl);
+    BOOST_REQUIRE_EQUAL(sectors.n_rows, 2);
+    BOOST_REQUIRE_EQUAL(sectors(0, nb-1).n_elem, 3);
+    BOOST_CHECK_EQUAL(sectors(0, nb-1)(2), 3);
+    BOOST_REQUIRE_EQUAL(sectors(1, nb-1).n_elem, 1);
+    BOOST_CHECK_EQUAL(sectors(1, nb-1)(0), 1);
+}
+
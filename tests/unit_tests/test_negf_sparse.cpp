@@ -0,0 +1,125 @@
+/**
+ * Test cases for the sparse NEGF solver, CohSpNegf. A block-tridiagonal
+ * device with a lead on each end has to give the same T(E) as CohRgfa.
+ *
+ */
+
+#include "negf/CohSpNegf.h"
+#include "negf/CohRgfa.h"
+
+#ifndef LINK_STATIC
+#define BOOST_TEST_DYN_LINK
+#endif
+#define BOOST_TEST_MODULE SparseNegfTest
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+
+using namespace quest::negf;
+using namespace std;
+
+const uint no = 3;          // orbitals per block.
+const uint N = 5;           // blocks in the device.
+const uint nb = N + 2;      // blocks including the contacts.
+const double kT = 0.0259;
+const dcmplx ieta(0, 1E-3);
+
+/*
+ * Random Hermitian device blocks with a random potential between two
+ * uniform contacts.
+ */
+struct RandomSystem{
+    field<shared_ptr<cxmat> > H0, Hl, S0, Sl;
+    field<shared_ptr<vec> > V;
+
+    RandomSystem(): H0(nb), Hl(nb+1), S0(nb), Sl(nb+1), V(nb){
+        arma::arma_rng::set_seed(17);
+        shared_ptr<cxmat> H0c = make_shared<cxmat>(no, no, fill::zeros);
+        for (uint io = 0; io+1 < no; ++io){
+            (*H0c)(io, io+1) = (*H0c)(io+1, io) = -0.5;
+        }
+        shared_ptr<cxmat> Hlc = make_shared<cxmat>(no, no, fill::zeros);
+        Hlc->diag().fill(-1.0);
+        H0(0) = H0(nb-1) = H0c;
+        Hl(0) = Hl(nb) = Hlc;
+
+        for (uint ib = 1; ib < nb-1; ++ib){
+            cxmat R = arma::randu<cxmat>(no, no) - dcmplx(0.5, 0.5);
+            H0(ib) = make_shared<cxmat>(0.5*(R + trans(R)));
+        }
+        for (uint ib = 1; ib < nb; ++ib){
+            cxmat R = arma::randu<cxmat>(no, no) - dcmplx(0.5, 0.5);
+            Hl(ib) = make_shared<cxmat>(*Hlc + 0.3*R);
+        }
+        for (uint ib = 0; ib < nb; ++ib){
+            S0(ib) = make_shared<cxmat>(no, no, fill::eye);
+            V(ib) = make_shared<vec>(no, fill::zeros);
+            if (ib > 0 && ib < nb-1){
+                *V(ib) = 0.2*(arma::randu<vec>(no) - 0.5);
+            }
+        }
+        for (uint ib = 0; ib <= nb; ++ib){
+            Sl(ib) = make_shared<cxmat>(no, no, fill::zeros);
+        }
+    }
+
+    void setup(CohRgfa &rgf, double E) const {
+        rgf.H(H0, Hl);
+        rgf.S(S0, Sl);
+        rgf.V(V);
+        rgf.E(E);
+    }
+
+    // The device only, with the contacts as two leads.
+    void setup(CohSpNegf &sp, double E) const {
+        cxmat H(N*no, N*no, fill::zeros);
+        vec Vd(N*no);
+        for (uint ib = 1; ib <= N; ++ib){
+            span bi((ib-1)*no, ib*no-1);
+            H(bi, bi) = *H0(ib);
+            Vd(bi) = *V(ib);
+            if (ib < N){
+                span bj(ib*no, (ib+1)*no-1);
+                H(bj, bi) = *Hl(ib+1);
+                H(bi, bj) = trans(*Hl(ib+1));
+            }
+        }
+        sp.H(make_shared<sp_cx_mat>(H));
+        sp.V(make_shared<vec>(Vd));
+
+        shared_ptr<uwcol> first = make_shared<uwcol>(linspace<uwcol>(0, no-1, no));
+        shared_ptr<uwcol> last = make_shared<uwcol>(linspace<uwcol>((N-1)*no, N*no-1, no));
+        sp.addLead(H0(0), Hl(0), Hl(1), first);
+        sp.addLead(H0(nb-1), make_shared<cxmat>(trans(*Hl(nb))),
+                make_shared<cxmat>(trans(*Hl(nb-1))), last);
+        sp.E(E);
+    }
+};
+
+BOOST_AUTO_TEST_CASE(transmission_matches_rgf)
+{
+    RandomSystem s;
+    vec Es = linspace<vec>(-1.5, 1.5, 7);
+    for (uint ie = 0; ie < Es.n_elem; ++ie){
+        CohRgfa rgf(nb, kT, ieta);
+        s.setup(rgf, Es(ie));
+        CohSpNegf sp(kT, ieta);
+        s.setup(sp, Es(ie));
+
+        dcmplx T = rgf.TEop()(0, 0);
+        BOOST_CHECK_SMALL(abs(sp.TEop(0, 1)(0, 0) - T), 1E-8*(1 + abs(T)));
+        BOOST_CHECK_SMALL(abs(sp.TEop(1, 0)(0, 0) - T), 1E-8*(1 + abs(T)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(wrong_potential_size_is_rejected)
+{
+    CohSpNegf sp(kT, ieta);
+    sp.H(make_shared<sp_cx_mat>(4, 4));
+    BOOST_CHECK_THROW(sp.V(make_shared<vec>(3, fill::zeros)), invalid_argument);
+    BOOST_CHECK_NO_THROW(sp.V(make_shared<vec>(4, fill::zeros)));
+
+    // H set after V.
+    BOOST_CHECK_THROW(sp.H(make_shared<sp_cx_mat>(5, 5)), invalid_argument);
+}
+
@@ -0,0 +1,125 @@
+/**
+ * Test cases for LinearPot::compute(). The batched evaluation has to give
+ * every atom the same potential as getPotAt(), including the atoms on the
+ * edges of the regions.
+ *
+ */
+
+#include "potential/linearPot.h"
+
+#ifndef LINK_STATIC
+#define BOOST_TEST_DYN_LINK
+#endif
+#define BOOST_TEST_MODULE LinearPotTest
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+
+using namespace quest::potential;
+using namespace std;
+
+const double s = 10;    // lattice points per unit length of the regions.
+
+squadrilateral rect(double xl, double xr, double yb, double yt){
+    return squadrilateral(point(s*xl, s*yb), point(s*xr, s*yb),
+            point(s*xr, s*yt), point(s*xl, s*yt));
+}
+
+/*
+ * Square lattice with unit spacing, x in [-6s, 6s] and y in [-4s, 4s],
+ * 9801 atoms or three chunks of compute(). All the regions have their
+ * edges on lattice lines:
+ *   source [-6, -3], linear region [-3, 1], gate [1, 3] x [-4, 0],
+ *   linear region [1, 3] x [0, 4] and drain [3, 6].
+ */
+AtomicStruct::ptr create_lattice(){
+    ptable pt;
+    AtomicStruct::ptr atoms = make_shared<AtomicStruct>(pt);
+    uint nl = 12*s + 1, nw = 8*s + 1, nh = 1;
+    atoms->genSimpleCubicStruct(pt[0], 1.0, nl, nw, nh);
+    return atoms;
+}
+
+void create_regions(LinearPot &pot){
+    pot.addSource(rect(-6, -3, -4, 4));
+    pot.addDrain(rect(3, 6, -4, 4));
+    int ig = pot.addGate(rect(1, 3, -4, 0));
+    int il0 = pot.addLinearRegion(rect(-3, 1, -4, 4));
+    int il1 = pot.addLinearRegion(rect(1, 3, 0, 4));
+
+    pot.VS(0.1);
+    pot.VD(-0.3);
+    pot.VG(ig, 0.25);
+    pot.VLR(il0, 0.1, 0.25, 0.05, -0.05);
+    pot.VLR(il1, 0.25, -0.3, 0.02, 0.0);
+}
+
+vec compute(AtomicStruct::ptr atoms, uint nthreads){
+    LinearPot pot(atoms);
+    create_regions(pot);
+    pot.nthreads(nthreads);
+    pot.compute();
+
+    vec V(atoms->NumOfAtoms());
+    for (int ia = 0; ia < atoms->NumOfAtoms(); ++ia){
+        V(ia) = pot.Vatom(ia);
+    }
+    return V;
+}
+
+BOOST_AUTO_TEST_CASE(compute_matches_getPotAt)
+{
+    AtomicStruct::ptr atoms = create_lattice();
+    BOOST_REQUIRE(atoms->NumOfAtoms() > 2*4096);
+    LinearPot pot(atoms);
+    create_regions(pot);
+    vec V = compute(atoms, 1);
+
+    uint nedge = 0;
+    for (int ia = 0; ia < atoms->NumOfAtoms(); ++ia){
+        double x = atoms->X(ia), y = atoms->Y(ia);
+        BOOST_CHECK_CLOSE(V(ia) + 1, pot.getPotAt(x, y) + 1, 1E-10);
+        if (x == -3*s || x == 1*s || x == 3*s || y == 0){
+            ++nedge;
+        }
+    }
+    BOOST_CHECK(nedge > 0);
+
+    // the source and the drain include their left and bottom edges.
+    BOOST_CHECK_CLOSE(pot.getPotAt(-6*s, 0), 0.1, 1E-10);
+    BOOST_CHECK_CLOSE(pot.getPotAt(3*s, 2*s), -0.3, 1E-10);
+    BOOST_CHECK_EQUAL(pot.getPotAt(6*s, 0), 0.0);
+    BOOST_CHECK_EQUAL(pot.getPotAt(-5*s, 4*s), 0.0);
+    // the gates and the linear regions do not include any edge.
+    BOOST_CHECK_EQUAL(pot.getPotAt(-3*s, 0), 0.0);
+    BOOST_CHECK_EQUAL(pot.getPotAt(-3*s, -4*s), 0.0);
+    BOOST_CHECK_EQUAL(pot.getPotAt(2*s, 0), 0.0);
+    BOOST_CHECK_CLOSE(pot.getPotAt(2*s, -1*s), 0.25, 1E-10);
+    BOOST_CHECK_CLOSE(pot.getPotAt(-1*s, 0), 0.175, 1E-10);
+}
+
+BOOST_AUTO_TEST_CASE(compute_threaded_matches_serial)
+{
+    // three chunks of atoms, each one on its own thread.
+    AtomicStruct::ptr atoms = create_lattice();
+    vec V1 = compute(atoms, 1);
+    vec V3 = compute(atoms, 3);
+    BOOST_REQUIRE_EQUAL(V3.n_elem, V1.n_elem);
+    for (uint ia = 0; ia < V1.n_elem; ++ia){
+        BOOST_CHECK_EQUAL(V3(ia), V1(ia));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(compute_rejects_changed_atoms)
+{
+    AtomicStruct::ptr atoms = create_lattice();
+    LinearPot pot(atoms);
+    create_regions(pot);
+
+    // the structure is shared, the potential still has one value per old atom.
+    ptable pt;
+    uint nl = 15, nw = 9, nh = 1;
+    atoms->genSimpleCubicStruct(pt[0], 1.0, nl, nw, nh);
+    BOOST_CHECK_THROW(pot.compute(), invalid_argument);
+}
+
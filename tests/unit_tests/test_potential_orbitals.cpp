@@ -0,0 +1,111 @@
+/**
+ * Test cases for Potential::toOrbPot(). The orbital potential gathered from
+ * the precomputed tables has to match expanding the atoms one by one.
+ *
+ */
+
+#include "potential/potential.h"
+
+#ifndef LINK_STATIC
+#define BOOST_TEST_DYN_LINK
+#endif
+#define BOOST_TEST_MODULE OrbitalPotentialTest
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+
+using namespace quest::potential;
+using namespace std;
+
+/*
+ * A chain of na atoms of three species with 1, 2 and 3 orbitals.
+ */
+AtomicStruct::ptr create_chain(uint na){
+    ptable pt;
+    pt.add(100, "A", 1, 1);
+    pt.add(101, "B", 2, 2);
+    pt.add(102, "C", 3, 3);
+    icol ids(na);
+    mat xyz(na, 3, fill::zeros);
+    for (uint ia = 0; ia < na; ++ia){
+        ids(ia) = 100 + (ia*7)%3;
+        xyz(ia, coord::X) = ia;
+    }
+    return make_shared<AtomicStruct>(ids, xyz, lvec(), pt);
+}
+
+/*
+ * The expansion toOrbPot() used before the tables: each atom repeated once
+ * per orbital.
+ */
+vec expand_per_atom(Potential &pot, const AtomicStruct &atoms, uint ia, uint ja){
+    AtomicStructView a(atoms);
+    vector<double> V;
+    for (uint i = ia; i <= ja; ++i){
+        for (int io = 0; io < a.NumOfOrbitalsAt(i); ++io){
+            V.push_back(pot.Vatom(i));
+        }
+    }
+    return vec(V);
+}
+
+void check_same(const vec &got, const vec &expected){
+    BOOST_REQUIRE_EQUAL(got.n_elem, expected.n_elem);
+    for (uint i = 0; i < expected.n_elem; ++i){
+        BOOST_CHECK_EQUAL(got(i), expected(i));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(tables_match_per_atom_expansion)
+{
+    uint na = 23;
+    AtomicStruct::ptr atoms = create_chain(na);
+    Potential pot(atoms);
+    for (uint ia = 0; ia < na; ++ia){
+        pot.Vatom(ia, 0.01*ia - 0.1);
+    }
+
+    BOOST_CHECK_EQUAL(pot.NumOfOrbitals(), atoms->NumOfOrbitals());
+    check_same(*pot.toOrbPot(), expand_per_atom(pot, *atoms, 0, na-1));
+    check_same(pot.toOrbPot(5, 11), expand_per_atom(pot, *atoms, 5, 11));
+    check_same(pot.toOrbPot(na-1, na-1), expand_per_atom(pot, *atoms, na-1, na-1));
+
+    // blocks of 4, 1, 10 and 8 atoms.
+    ucol nab;
+    nab << 4 << 1 << 10 << 8;
+    field<shared_ptr<vec> > V;
+    pot.toOrbPot(V, nab);
+    BOOST_REQUIRE_EQUAL(V.n_elem, nab.n_elem);
+    uint ia = 0;
+    for (uint ib = 0; ib < nab.n_elem; ++ib){
+        check_same(*V(ib), expand_per_atom(pot, *atoms, ia, ia + nab(ib) - 1));
+        ia += nab(ib);
+    }
+
+    // the blocks are reused and refilled on the next call.
+    shared_ptr<vec> V0 = V(0);
+    pot.Vatom(0, 1.5);
+    pot.toOrbPot(V, nab);
+    BOOST_CHECK(V(0) == V0);
+    check_same(*V(0), expand_per_atom(pot, *atoms, 0, nab(0) - 1));
+}
+
+BOOST_AUTO_TEST_CASE(changed_atoms_are_rejected)
+{
+    AtomicStruct::ptr atoms = create_chain(10);
+    Potential pot(atoms);
+
+    // the structure is shared, a new one of a different size makes the
+    // tables stale.
+    *atoms = *create_chain(12);
+    vec V;
+    BOOST_CHECK_THROW(pot.toOrbPot(V), invalid_argument);
+
+    // same number of atoms but different orbitals.
+    atoms = create_chain(10);
+    Potential pot2(atoms);
+    AtomicStruct::ptr other = create_chain(11);
+    *atoms = (*other)(span(1, 10));
+    BOOST_CHECK_THROW(pot2.toOrbPot(V), invalid_argument);
+}
+